@@ -0,0 +1,89 @@
+// Cracking: WPA PMK derivation dominates dictionary attacks; candidate
+// generation and checkpointing must stay negligible next to it.
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "bench_support.hpp"
+#include "etheros/crack/checkpoint.hpp"
+#include "etheros/crack/keyspace.hpp"
+#include "etheros/crack/pbkdf2.hpp"
+#include "etheros/crack/sha1.hpp"
+
+namespace etheros::bench {
+namespace {
+
+void BM_Sha1Compress(benchmark::State& state) {
+  crack::Sha1State s = crack::kSha1Init;
+  std::uint8_t block[64] = {1, 2, 3};
+
+  PerfScope perf(state);
+  for (auto _ : state) {
+    crack::sha1_compress(s, block);
+    benchmark::DoNotOptimize(s);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * 64);
+}
+ETHEROS_BENCHMARK(BM_Sha1Compress);
+
+void BM_WpaPmk(benchmark::State& state) {
+  char pass[] = "password00";
+
+  PerfScope perf(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(crack::wpa_pmk(pass, "etheros-lab"));
+    ++pass[9];
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+ETHEROS_BENCHMARK(BM_WpaPmk)->Unit(benchmark::kMillisecond);
+
+void BM_MaskEnumerate(benchmark::State& state) {
+  const auto keyspace = crack::open_keyspace("mask:?u?l?l?l?l?d?d?d", 4096);
+  std::uint64_t first = 0, sum = 0;
+
+  PerfScope perf(state);
+  for (auto _ : state) {
+    keyspace->enumerate(first, 4096, [&](std::uint64_t, std::string_view c) {
+      sum += static_cast<unsigned char>(c.back());
+      return true;
+    });
+    first = (first + 4096 * 7919) % keyspace->size();
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations() * 4096);
+}
+ETHEROS_BENCHMARK(BM_MaskEnumerate);
+
+// Cost of recording one finished chunk, with a group commit every 64 chunks
+// and a compaction every 16384 as JobManager does by default. Reports bytes
+// written to the state directory per chunk.
+void BM_CheckpointChunkDone(benchmark::State& state) {
+  const std::string dir = temp_path("etheros-bench-ckpt");
+  ::mkdir(dir.c_str(), 0755);
+  constexpr std::uint64_t kChunks = 1 << 20;
+  std::uint64_t chunk = 0;
+  std::uint64_t bytes = 0;
+  {
+    crack::Checkpoint ckpt(dir, 1, kChunks);
+
+    PerfScope perf(state);
+    for (auto _ : state) {
+      ckpt.mark_done(chunk++ % kChunks);
+      if (chunk % 64 == 0) ckpt.sync();
+      if (ckpt.journal_records() >= 16384) ckpt.compact();
+    }
+    bytes = ckpt.bytes_written();
+  }
+  for (const char* name : {"/journal", "/snapshot"}) ::unlink((dir + name).c_str());
+  ::rmdir(dir.c_str());
+  state.SetItemsProcessed(state.iterations());
+  state.counters["bytes_per_chunk"] = static_cast<double>(bytes) / static_cast<double>(state.iterations());
+}
+ETHEROS_BENCHMARK(BM_CheckpointChunkDone)->UseRealTime();
+
+}  // namespace
+}  // namespace etheros::bench
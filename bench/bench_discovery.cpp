@@ -0,0 +1,77 @@
+// Service-discovery harvesting: packets/s through decode plus the mDNS,
+// LLMNR, NBNS and SSDP parsers, and what the deduplicated inventory costs in
+// memory for a LAN of range(0) hosts.
+
+#include <vector>
+
+#include "bench_support.hpp"
+#include "etheros/capture/pcap.hpp"
+#include "etheros/discovery/dns.hpp"
+#include "etheros/discovery/harvester.hpp"
+#include "etheros/parse/decode.hpp"
+#include "synthetic.hpp"
+
+namespace etheros::bench {
+namespace {
+
+// Decode and harvest a replayed capture. Nearly every discovery packet after
+// the first few thousand repeats a known fact, which is the steady state on a
+// real network.
+void BM_HarvestTrace(benchmark::State& state) {
+  const auto hosts = static_cast<std::size_t>(state.range(0));
+  const Trace trace = discovery_trace(200'000, hosts, 11);
+
+  std::size_t inventory_bytes = 0, host_count = 0, fact_count = 0;
+  PerfScope perf(state);
+  for (auto _ : state) {
+    discovery::Harvester harvester;
+    capture::PcapReader reader(trace.pcap);
+    capture::Packet pkt;
+    parse::DecodedPacket decoded;
+    while (reader.next(pkt))
+      if (parse::decode(trace.link_type, pkt.data, decoded)) harvester.process(pkt.ts_ns, decoded);
+    inventory_bytes = harvester.inventory().memory_bytes();
+    host_count = harvester.inventory().hosts().size();
+    fact_count = harvester.inventory().facts().size();
+    benchmark::DoNotOptimize(fact_count);
+  }
+  state.SetItemsProcessed(state.iterations() * trace.packets);
+  state.counters["hosts"] = static_cast<double>(host_count);
+  state.counters["facts"] = static_cast<double>(fact_count);
+  state.counters["inventory_kib"] = static_cast<double>(inventory_bytes) / 1024;
+}
+ETHEROS_BENCHMARK(BM_HarvestTrace)->Arg(256)->Arg(4096)->Unit(benchmark::kMillisecond);
+
+// Walking every record of an mDNS announcement and expanding each owner name
+// through compression pointers, without the inventory.
+void BM_DnsParse(benchmark::State& state) {
+  const Trace trace = discovery_trace(20'000, 256, 12);
+  std::vector<ByteSpan> messages;
+  capture::PcapReader reader(trace.pcap);
+  capture::Packet pkt;
+  parse::DecodedPacket decoded;
+  while (reader.next(pkt))
+    if (parse::decode(trace.link_type, pkt.data, decoded) && decoded.has(parse::kLayerUdp) &&
+        decoded.dst_port == discovery::kMdnsPort)
+      messages.push_back(decoded.payload);
+
+  std::size_t i = 0, records = 0;
+  discovery::DnsName name;
+  PerfScope perf(state);
+  for (auto _ : state) {
+    discovery::DnsReader dns(messages[i]);
+    discovery::DnsRecord rr;
+    while (dns.next(rr)) {
+      dns.name(rr.name_offset, name);
+      ++records;
+    }
+    benchmark::DoNotOptimize(name);
+    if (++i == messages.size()) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["records"] = benchmark::Counter(static_cast<double>(records), benchmark::Counter::kIsRate);
+}
+ETHEROS_BENCHMARK(BM_DnsParse);
+
+}  // namespace
+}  // namespace etheros::bench
@@ -0,0 +1,157 @@
+// Flow tracking: per-packet lookup cost and memory per flow at the 100k+
+// concurrent flows a busy LAN or a scan produces.
+
+#include <algorithm>
+#include <vector>
+
+#include "bench_support.hpp"
+#include "etheros/capture/pcap.hpp"
+#include "etheros/flow/flow_table.hpp"
+#include "etheros/parse/decode.hpp"
+#include "flow_packets.hpp"
+#include "synthetic.hpp"
+
+namespace etheros::bench {
+namespace {
+
+constexpr std::uint64_t kStartNs = 1'700'000'000ull * 1'000'000'000;
+
+using test::tcp_packet;
+
+void report_memory(benchmark::State& state, const flow::FlowTable& table) {
+  state.counters["flows"] = static_cast<double>(table.size());
+  // What the live flows cost: the tracking state (zeroed up front, so all of
+  // it resident, empty slots included) plus pool blocks in use, per live flow.
+  if (table.size() != 0)
+    state.counters["bytes_per_flow"] =
+        static_cast<double>(table.table_memory_bytes() + table.buffer_memory_in_use()) /
+        static_cast<double>(table.size());
+  // Secondary: reserved tracking state per slot, whether or not a flow occupies it.
+  state.counters["reserved_bytes_per_slot"] =
+      static_cast<double>(table.table_memory_bytes()) / static_cast<double>(table.capacity());
+  state.counters["table_mib"] = static_cast<double>(table.table_memory_bytes()) / (1 << 20);
+}
+
+// range(0) = established flows. Lookups are spread over the whole table, so
+// at 100k+ flows most of them miss the cache.
+void BM_FlowLookup(benchmark::State& state) {
+  const auto flows = static_cast<std::uint32_t>(state.range(0));
+  flow::FlowTableOptions options;
+  options.max_flows = flows;
+  flow::FlowTable table(options);
+  for (std::uint32_t f = 0; f < flows; ++f) table.process(kStartNs, tcp_packet(f, 1, parse::kTcpSyn));
+
+  Rng rng(9);
+  std::vector<flow::FlowKey> probes(65536);
+  for (auto& key : probes) {
+    bool from_a = false;
+    key = flow::FlowKey::from(tcp_packet(rng.below(flows), 0, 0), from_a);
+  }
+
+  std::size_t i = 0;
+  PerfScope perf(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table.find(probes[i]));
+    i = (i + 1) & 65535;
+  }
+  state.SetItemsProcessed(state.iterations());
+  report_memory(state, table);
+}
+ETHEROS_BENCHMARK(BM_FlowLookup)->Arg(1'000)->Arg(100'000)->Arg(250'000);
+
+// Decode plus tracking over an office-style trace with range(0) flows, whose
+// TCP segments are range(1) per mille reordered and range(2) per mille lost.
+void BM_FlowTrace(benchmark::State& state) {
+  const auto flows = static_cast<std::size_t>(state.range(0));
+  TcpOrdering ordering;
+  ordering.reorder_per_mille = static_cast<std::uint32_t>(state.range(1));
+  ordering.loss_per_mille = static_cast<std::uint32_t>(state.range(2));
+  const Trace trace = mixed_ethernet_trace(200'000, flows, 10, ordering);
+  flow::FlowTableOptions options;
+  options.max_flows = static_cast<std::uint32_t>(flows * 2);
+
+  std::size_t live = 0;
+  flow::FlowTableStats stats;
+  PerfScope perf(state);
+  for (auto _ : state) {
+    flow::FlowTable table(options);
+    capture::PcapReader reader(trace.pcap);
+    capture::Packet pkt;
+    parse::DecodedPacket decoded;
+    while (reader.next(pkt))
+      if (parse::decode(trace.link_type, pkt.data, decoded)) table.process(pkt.ts_ns, decoded);
+    live = table.size();
+    // Flushes what is still buffered behind lost segments.
+    table.clear();
+    stats = table.stats();
+    benchmark::DoNotOptimize(live);
+  }
+  state.SetItemsProcessed(state.iterations() * trace.packets);
+  state.counters["flows"] = static_cast<double>(live);
+  state.counters["delivered_mib"] = static_cast<double>(stats.delivered_bytes) / (1 << 20);
+  state.counters["gaps"] = static_cast<double>(stats.gaps);
+}
+ETHEROS_BENCHMARK(BM_FlowTrace)->Args({100'000, 0, 0})->Args({100'000, 20, 2})->Unit(benchmark::kMillisecond);
+
+// A SYN scan: every packet opens a new flow that is never answered. With 1ms
+// between probes and the 10s half-open timeout, ~10k flows stay live and the
+// timing wheel retires one per packet.
+void BM_FlowScanChurn(benchmark::State& state) {
+  flow::FlowTableOptions options;
+  options.max_flows = 128 * 1024;
+  flow::FlowTable table(options);
+  std::uint64_t ts = kStartNs;
+  std::uint32_t flow = 0;
+
+  PerfScope perf(state);
+  for (auto _ : state) {
+    ts += 1'000'000;
+    table.process(ts, tcp_packet(flow++, 7, parse::kTcpSyn));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["rejected"] = static_cast<double>(table.stats().rejected);
+  report_memory(state, table);
+}
+ETHEROS_BENCHMARK(BM_FlowScanChurn);
+
+class CountingHandler : public flow::StreamHandler {
+ public:
+  void on_data(flow::FlowId, flow::Direction, ByteSpan data) override { bytes += data.size(); }
+  std::uint64_t bytes = 0;
+};
+
+// 1024 flows sending 512-byte segments, one pair in four swapped so that it
+// passes through the segment pool.
+void BM_FlowReassembly(benchmark::State& state) {
+  constexpr std::uint32_t kFlows = 1024;
+  constexpr std::uint32_t kSegment = 512;
+  std::vector<std::uint8_t> payload(kSegment, 0x5a);
+  CountingHandler handler;
+  flow::FlowTable table(flow::FlowTableOptions{}, &handler);
+  for (std::uint32_t f = 0; f < kFlows; ++f) table.process(kStartNs, tcp_packet(f, 0, parse::kTcpSyn));
+  std::vector<std::uint32_t> seq(kFlows, 1);
+
+  std::uint32_t f = 0, round = 0;
+  PerfScope perf(state);
+  for (auto _ : state) {
+    const std::uint32_t s = seq[f];
+    if (round % 4 == 0) {
+      table.process(kStartNs, tcp_packet(f, s + kSegment, parse::kTcpAck, payload));
+      table.process(kStartNs, tcp_packet(f, s, parse::kTcpAck, payload));
+    } else {
+      table.process(kStartNs, tcp_packet(f, s, parse::kTcpAck, payload));
+      table.process(kStartNs, tcp_packet(f, s + kSegment, parse::kTcpAck, payload));
+    }
+    seq[f] = s + 2 * kSegment;
+    if (++f == kFlows) {
+      f = 0;
+      ++round;
+    }
+  }
+  state.SetBytesProcessed(static_cast<std::int64_t>(handler.bytes));
+  state.counters["gaps"] = static_cast<double>(table.stats().gaps);
+}
+ETHEROS_BENCHMARK(BM_FlowReassembly);
+
+}  // namespace
+}  // namespace etheros::bench
@@ -0,0 +1,61 @@
+// I/O: pcap capture-to-disk and replay from a mapped file.
+//
+// Files go to temp_path(); set ETHEROS_BENCH_TMPDIR to measure the SD card.
+
+#include <unistd.h>
+
+#include <string>
+
+#include "bench_support.hpp"
+#include "etheros/capture/pcap.hpp"
+#include "etheros/io/fd_writer.hpp"
+#include "etheros/io/mapped_file.hpp"
+#include "synthetic.hpp"
+
+namespace etheros::bench {
+namespace {
+
+void BM_PcapWrite(benchmark::State& state) {
+  const Trace trace = mixed_ethernet_trace(10'000, 1'000, 5);
+  const std::string path = temp_path("etheros-bench-write.pcap");
+
+  PerfScope perf(state);
+  for (auto _ : state) {
+    io::FdWriter out = io::FdWriter::open(path);
+    capture::PcapWriter writer(out, trace.link_type);
+    capture::PcapReader reader(trace.pcap);
+    capture::Packet pkt;
+    while (reader.next(pkt)) writer.write(pkt);
+    out.close();
+  }
+  ::unlink(path.c_str());
+  state.SetItemsProcessed(state.iterations() * trace.packets);
+  state.SetBytesProcessed(state.iterations() * trace.pcap.size());
+}
+ETHEROS_BENCHMARK(BM_PcapWrite)->UseRealTime();
+
+void BM_MappedReplay(benchmark::State& state) {
+  const Trace trace = mixed_ethernet_trace(10'000, 1'000, 6);
+  const std::string path = temp_path("etheros-bench-read.pcap");
+  {
+    io::FdWriter out = io::FdWriter::open(path);
+    out.write(ByteSpan(trace.pcap));
+  }
+
+  PerfScope perf(state);
+  for (auto _ : state) {
+    io::MappedFile file(path);
+    capture::PcapReader reader(file.bytes());
+    capture::Packet pkt;
+    std::uint64_t sum = 0;
+    while (reader.next(pkt)) sum += pkt.data[pkt.data.size() - 1];
+    benchmark::DoNotOptimize(sum);
+  }
+  ::unlink(path.c_str());
+  state.SetItemsProcessed(state.iterations() * trace.packets);
+  state.SetBytesProcessed(state.iterations() * trace.pcap.size());
+}
+ETHEROS_BENCHMARK(BM_MappedReplay)->UseRealTime();
+
+}  // namespace
+}  // namespace etheros::bench
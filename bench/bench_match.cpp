@@ -0,0 +1,46 @@
+// Matching: target/ignore list lookups on every decoded frame.
+
+#include <vector>
+
+#include "bench_support.hpp"
+#include "etheros/match/mac_set.hpp"
+#include "synthetic.hpp"
+
+namespace etheros::bench {
+namespace {
+
+MacAddress mac_from(std::uint64_t v) {
+  MacAddress m;
+  for (int i = 0; i < 6; ++i) m.octets[i] = static_cast<std::uint8_t>(v >> (40 - 8 * i));
+  return m;
+}
+
+// range(0) = set size; range(1) = percentage of probes that hit.
+void BM_MacSetLookup(benchmark::State& state) {
+  const auto size = static_cast<std::size_t>(state.range(0));
+  const auto hit_pct = static_cast<std::uint32_t>(state.range(1));
+  Rng rng(4);
+  match::MacSet set(size);
+  std::vector<std::uint64_t> members;
+  for (std::size_t i = 0; i < size; ++i) {
+    const std::uint64_t v = rng.next() & 0xffffffffffffull;
+    set.insert(mac_from(v));
+    members.push_back(v);
+  }
+  std::vector<std::uint64_t> probes(4096);
+  for (auto& p : probes)
+    p = rng.below(100) < hit_pct ? members[rng.below(static_cast<std::uint32_t>(size))]
+                                 : (rng.next() & 0xffffffffffffull);
+
+  std::size_t i = 0;
+  PerfScope perf(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(set.contains(probes[i]));
+    i = (i + 1) & 4095;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+ETHEROS_BENCHMARK(BM_MacSetLookup)->Args({16, 10})->Args({4096, 10})->Args({65536, 50});
+
+}  // namespace
+}  // namespace etheros::bench
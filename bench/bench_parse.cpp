@@ -0,0 +1,63 @@
+// Parsing: pcap record framing and L2-L4 decoding.
+
+#include "bench_support.hpp"
+#include "etheros/capture/pcap.hpp"
+#include "etheros/parse/decode.hpp"
+#include "synthetic.hpp"
+
+namespace etheros::bench {
+namespace {
+
+void BM_PcapReplay(benchmark::State& state) {
+  const Trace trace = mixed_ethernet_trace(10'000, 1'000, 1);
+  capture::PcapReader reader(trace.pcap);
+  capture::Packet pkt;
+
+  PerfScope perf(state);
+  for (auto _ : state) {
+    reader.rewind();
+    while (reader.next(pkt)) benchmark::DoNotOptimize(pkt.data.data());
+  }
+  state.SetItemsProcessed(state.iterations() * trace.packets);
+  state.SetBytesProcessed(state.iterations() * trace.pcap.size());
+}
+ETHEROS_BENCHMARK(BM_PcapReplay);
+
+void BM_DecodeEthernet(benchmark::State& state) {
+  const Trace trace = mixed_ethernet_trace(10'000, 1'000, 2);
+  capture::PcapReader reader(trace.pcap);
+  capture::Packet pkt;
+  parse::DecodedPacket decoded;
+
+  PerfScope perf(state);
+  for (auto _ : state) {
+    reader.rewind();
+    while (reader.next(pkt)) {
+      parse::decode(reader.link_type(), pkt.data, decoded);
+      benchmark::DoNotOptimize(decoded.layers);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * trace.packets);
+}
+ETHEROS_BENCHMARK(BM_DecodeEthernet);
+
+void BM_DecodeRadiotap(benchmark::State& state) {
+  const Trace trace = beacon_trace(10'000, 64, 3);
+  capture::PcapReader reader(trace.pcap);
+  capture::Packet pkt;
+  parse::DecodedPacket decoded;
+
+  PerfScope perf(state);
+  for (auto _ : state) {
+    reader.rewind();
+    while (reader.next(pkt)) {
+      parse::decode(reader.link_type(), pkt.data, decoded);
+      benchmark::DoNotOptimize(decoded.layers);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * trace.packets);
+}
+ETHEROS_BENCHMARK(BM_DecodeRadiotap);
+
+}  // namespace
+}  // namespace etheros::bench
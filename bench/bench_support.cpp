@@ -0,0 +1,86 @@
+#include "bench_support.hpp"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace etheros::bench {
+
+namespace {
+
+bool perf_enabled() {
+  const char* v = std::getenv("ETHEROS_BENCH_PERF");
+  return v == nullptr || std::strcmp(v, "0") != 0;
+}
+
+int open_counter(std::uint32_t type, std::uint64_t config) {
+  perf_event_attr attr{};
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+}  // namespace
+
+void configure(benchmark::internal::Benchmark* b) {
+  if (const char* n = std::getenv("ETHEROS_BENCH_ITERATIONS")) {
+    const long long iters = std::atoll(n);
+    if (iters > 0) b->Iterations(iters);
+  }
+}
+
+std::string temp_path(const char* name) {
+  const char* dir = std::getenv("ETHEROS_BENCH_TMPDIR");
+  return std::string(dir ? dir : "/tmp") + "/" + name + "." + std::to_string(::getpid());
+}
+
+PerfScope::PerfScope(benchmark::State& state) : state_(state) {
+  if (!perf_enabled()) return;
+
+  struct Event {
+    const char* name;
+    std::uint32_t type;
+    std::uint64_t config;
+  };
+  static constexpr Event kEvents[kMaxEvents] = {
+      {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {"cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+      {"l1d_misses", PERF_TYPE_HW_CACHE,
+       PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+  };
+
+  for (const Event& e : kEvents) {
+    const int fd = open_counter(e.type, e.config);
+    if (fd < 0) continue;
+    fds_[count_] = fd;
+    names_[count_] = e.name;
+    ++count_;
+  }
+  for (int i = 0; i < count_; ++i) {
+    ::ioctl(fds_[i], PERF_EVENT_IOC_RESET, 0);
+    ::ioctl(fds_[i], PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+PerfScope::~PerfScope() {
+  for (int i = 0; i < count_; ++i) ::ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+  for (int i = 0; i < count_; ++i) {
+    std::uint64_t value = 0;
+    if (::read(fds_[i], &value, sizeof(value)) == sizeof(value))
+      state_.counters[names_[i]] = benchmark::Counter(static_cast<double>(value),
+                                                      benchmark::Counter::kAvgIterations);
+    ::close(fds_[i]);
+  }
+}
+
+}  // namespace etheros::bench
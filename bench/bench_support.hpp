@@ -0,0 +1,48 @@
+#pragma once
+
+// Shared plumbing for etheros-bench.
+//
+// ETHEROS_BENCHMARK registers a benchmark that honours two environment
+// variables used by bench/run.py:
+//   ETHEROS_BENCH_ITERATIONS=N  pin the iteration count (cost-model runs
+//                               difference two pinned runs to cancel setup)
+//   ETHEROS_BENCH_PERF=0        skip hardware counters (set under qemu, where
+//                               they would count the emulator, not the guest)
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+
+namespace etheros::bench {
+
+void configure(benchmark::internal::Benchmark* b);
+
+// Per-process scratch path under ETHEROS_BENCH_TMPDIR (default /tmp). On the
+// board, point it at the SD card to measure the card rather than tmpfs.
+std::string temp_path(const char* name);
+
+// Reads hardware counters for the timed loop and publishes them per iteration
+// as user counters: instructions, cycles, cache_misses, l1d_misses. Construct
+// immediately before `for (auto _ : state)`; counters that the kernel or CPU
+// does not provide are simply omitted.
+class PerfScope {
+ public:
+  explicit PerfScope(benchmark::State& state);
+  ~PerfScope();
+
+  PerfScope(const PerfScope&) = delete;
+  PerfScope& operator=(const PerfScope&) = delete;
+
+ private:
+  static constexpr int kMaxEvents = 4;
+
+  benchmark::State& state_;
+  int fds_[kMaxEvents] = {-1, -1, -1, -1};
+  const char* names_[kMaxEvents] = {};
+  int count_ = 0;
+};
+
+}  // namespace etheros::bench
+
+#define ETHEROS_BENCHMARK(fn) BENCHMARK(fn)->Apply(::etheros::bench::configure)
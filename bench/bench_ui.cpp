@@ -0,0 +1,60 @@
+// Dashboard: cost of one frame when every counter changes, drawn into plain
+// memory laid out like a scanout buffer.
+
+#include <vector>
+
+#include "bench_support.hpp"
+#include "etheros/ui/canvas.hpp"
+#include "etheros/ui/dashboard.hpp"
+
+namespace etheros::bench {
+namespace {
+
+// range(0) x range(1) pixels; range(2) = bytes per pixel (2 = RGB565 fbdev,
+// 4 = XRGB8888 DRM dumb buffer).
+void BM_DashboardFrame(benchmark::State& state) {
+  ui::Surface surface;
+  surface.width = static_cast<int>(state.range(0));
+  surface.height = static_cast<int>(state.range(1));
+  surface.format = state.range(2) == 2 ? ui::PixelFormat::kRgb565 : ui::PixelFormat::kXrgb8888;
+  surface.stride = static_cast<std::size_t>(surface.width) * static_cast<std::size_t>(state.range(2));
+  std::vector<std::uint8_t> pixels(surface.stride * static_cast<std::size_t>(surface.height));
+  surface.pixels = pixels.data();
+
+  ui::Canvas canvas(surface);
+  ui::Dashboard dashboard(canvas);
+  canvas.dirty().clear();
+
+  ui::DashboardStats stats;
+  stats.crack_total = 10'000'000;
+  stats.mem_total_kb = 427'000;
+  stats.last_handshake = "lab-ap";
+  std::uint64_t frame = 0;
+  long dirty_area = 0;
+  const std::uint64_t pixels_before = canvas.pixels_written();
+
+  PerfScope perf(state);
+  for (auto _ : state) {
+    ++frame;
+    stats.uptime_s = frame / 4;
+    stats.packets += 1500 + (frame * 7919) % 900;
+    stats.packets_per_s = 6000 + static_cast<double>((frame * 31) % 2000);
+    stats.bytes_per_s = stats.packets_per_s * 600;
+    stats.drops += frame % 5 == 0;
+    stats.crack_done += 90;
+    stats.crack_per_s = 330 + static_cast<double>(frame % 7);
+    stats.mem_available_kb = 200'000 - (frame % 512) * 8;
+    stats.self_rss_kb = 1800;
+    dashboard.update(stats);
+    dirty_area += canvas.dirty().area();
+    canvas.dirty().clear();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["dirty_px"] = benchmark::Counter(static_cast<double>(dirty_area), benchmark::Counter::kAvgIterations);
+  state.counters["written_px"] = benchmark::Counter(static_cast<double>(canvas.pixels_written() - pixels_before),
+                                                    benchmark::Counter::kAvgIterations);
+}
+ETHEROS_BENCHMARK(BM_DashboardFrame)->Args({640, 480, 2})->Args({1280, 720, 4})->Args({1920, 1080, 4});
+
+}  // namespace
+}  // namespace etheros::bench
@@ -0,0 +1,351 @@
+#!/usr/bin/env python3
+"""Run etheros-bench, record results and flag regressions.
+
+Native run on the build host (or on the board itself):
+
+    bench/run.py --build _build
+
+AArch64 build under qemu user mode, plus the Cortex-A53 cost model:
+
+    bench/run.py --build _build-a64 --qemu --cost-model
+
+Every run appends one JSON line to bench/history.jsonl. A run is compared with
+the median of the last --window entries that have the same mode and
+architecture (and, for native runs, the same host); any metric that got worse by more than its threshold in
+bench/thresholds.json fails the run with exit status 1.
+
+Metrics per benchmark:
+  cpu_ns          Google Benchmark CPU time per iteration (native only;
+                  wall-clock under qemu says nothing about the board)
+  items_per_second,
+  bytes_per_second
+                  throughput (native only); recorded for reading, not
+                  compared, since cpu_ns already covers it
+  instructions,   hardware counters per iteration, read with perf_event_open
+  cycles, ...     when the kernel allows it
+  a53_insns,      qemu TCG plugin counts per iteration (--cost-model)
+  a53_l1d_misses, with caches configured as on the BCM2710A1: 32KiB 4-way L1D,
+  a53_l1i_misses, 32KiB 2-way L1I, 512KiB 16-way shared L2, 64-byte lines
+  a53_l2_misses
+  a53_est_ns      first-order time estimate at 1GHz from the counts above
+"""
+
+import argparse
+import datetime
+import json
+import os
+import platform
+import re
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+REPO = os.path.dirname(HERE)
+
+# Cortex-A53 @ 1GHz, in-order dual issue. Penalties are load-to-use latencies
+# for an L2 hit and for LPDDR2 on the Zero 2 W; they are estimates, good for
+# ranking changes, not for predicting absolute runtimes.
+A53_CACHE_ARGS = ("dcachesize=32768,dassoc=4,dblksize=64,"
+                  "icachesize=32768,iassoc=2,iblksize=64,"
+                  "l2=on,l2cachesize=524288,l2assoc=16,l2blksize=64")
+A53_BASE_CPI = 1.0
+A53_L1_MISS_CYCLES = 13
+A53_L2_MISS_CYCLES = 120
+A53_CLOCK_GHZ = 1.0
+
+PLUGIN_SEARCH = [
+    "/usr/lib/qemu/plugins",
+    "/usr/local/lib/qemu/plugins",
+    "/usr/libexec/qemu/plugins",
+]
+
+
+def parse_args():
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument("--build", default=os.path.join(REPO, "_build"), help="CMake build directory")
+    p.add_argument("--filter", default=".", help="regex passed to --benchmark_filter")
+    p.add_argument("--min-time", type=float, default=0.2, help="seconds per benchmark")
+    p.add_argument("--qemu", action="store_true", help="run an AArch64 binary under qemu-aarch64")
+    p.add_argument("--qemu-bin", default="qemu-aarch64")
+    p.add_argument("--qemu-ld-prefix", default="/usr/aarch64-linux-gnu", help="sysroot for -L")
+    p.add_argument("--qemu-plugin-dir", help="directory containing libinsn.so and libcache.so")
+    p.add_argument("--cost-model", action="store_true", help="collect A53 cost-model counts (needs --qemu)")
+    p.add_argument("--cost-iterations", type=int, default=200,
+                   help="iterations N for the N/2N differencing runs")
+    p.add_argument("--no-perf", action="store_true", help="do not read hardware counters")
+    p.add_argument("--history", default=os.path.join(HERE, "history.jsonl"))
+    p.add_argument("--thresholds", default=os.path.join(HERE, "thresholds.json"))
+    p.add_argument("--window", type=int, default=5, help="history entries forming the baseline")
+    p.add_argument("--label", default="", help="free-form tag stored with the run")
+    p.add_argument("--no-record", action="store_true", help="compare but do not append to history")
+    args = p.parse_args()
+    if args.cost_model and not args.qemu:
+        p.error("--cost-model needs --qemu")
+    if args.qemu and not args.cost_model:
+        print("run.py: without --cost-model a qemu run records no metrics", file=sys.stderr)
+    return args
+
+
+def bench_binary(args):
+    path = os.path.join(args.build, "bench", "etheros-bench")
+    if not os.path.exists(path):
+        sys.exit(f"run.py: {path} not found; build with -DETHEROS_BUILD_BENCHMARKS=ON")
+    return path
+
+
+def base_command(args, plugins=(), plugin_log=None):
+    cmd = []
+    if args.qemu:
+        cmd = [args.qemu_bin]
+        if os.path.isdir(args.qemu_ld_prefix):
+            cmd += ["-L", args.qemu_ld_prefix]
+        for plugin in plugins:
+            cmd += ["-plugin", plugin]
+        if plugin_log:
+            cmd += ["-d", "plugin", "-D", plugin_log]
+    return cmd + [bench_binary(args)]
+
+
+def bench_env(args, iterations=None):
+    env = dict(os.environ)
+    # Under qemu the counters would measure the emulator, not the guest code.
+    if args.qemu or args.no_perf:
+        env["ETHEROS_BENCH_PERF"] = "0"
+    if iterations is not None:
+        env["ETHEROS_BENCH_ITERATIONS"] = str(iterations)
+    return env
+
+
+def run_benchmarks(args):
+    with tempfile.NamedTemporaryFile(suffix=".json") as out:
+        cmd = base_command(args) + [
+            f"--benchmark_filter={args.filter}",
+            f"--benchmark_min_time={args.min_time}",
+            "--benchmark_format=console",
+            "--benchmark_out_format=json",
+            f"--benchmark_out={out.name}",
+        ]
+        subprocess.run(cmd, env=bench_env(args), check=True)
+        with open(out.name) as f:
+            report = json.load(f)
+
+    to_ns = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+    results = {}
+    for b in report["benchmarks"]:
+        if b.get("run_type", "iteration") != "iteration":
+            continue
+        # Skipped (e.g. BM_PacketRingSpsc on one CPU): no timing to record.
+        if b.get("error_occurred"):
+            print(f"  skipped {b['name']}: {b.get('error_message', '')}")
+            continue
+        scale = to_ns[b.get("time_unit", "ns")]
+        metrics = {}
+        # Everything derived from time is emulator time under qemu; only the
+        # plugin counts added by --cost-model mean anything there.
+        if not args.qemu:
+            metrics["cpu_ns"] = b["cpu_time"] * scale
+            for key in RATE_METRICS:
+                if key in b:
+                    metrics[key] = b[key]
+        for key in ("instructions", "cycles", "cache_misses", "l1d_misses"):
+            if key in b:
+                metrics[key] = b[key]
+        results[b["name"]] = metrics
+    return report.get("context", {}), results
+
+
+def find_plugin(args, name):
+    dirs = [args.qemu_plugin_dir] if args.qemu_plugin_dir else PLUGIN_SEARCH
+    for d in dirs:
+        if d and os.path.exists(os.path.join(d, name)):
+            return os.path.join(d, name)
+    sys.exit(f"run.py: qemu plugin {name} not found; pass --qemu-plugin-dir")
+
+
+def parse_plugin_log(text):
+    counts = {}
+    # libinsn prints "total insns: N" and, with several vCPUs, one
+    # "cpu N insns: M" line per core before it. Per-core lines alone undercount
+    # multi-threaded benchmarks, so they are only summed when no total exists.
+    total = re.search(r"^total insns:\s*(\d+)", text, re.MULTILINE)
+    if total:
+        counts["insns"] = int(total.group(1))
+    else:
+        per_cpu = re.findall(r"^(?:cpu \d+ )?insns:\s*(\d+)", text, re.MULTILINE)
+        if per_cpu:
+            counts["insns"] = sum(int(n) for n in per_cpu)
+    # libcache prints a CSV-ish header followed by one row per core and, with
+    # several vCPUs, a "sum" row. Use the sum if present, else the first row.
+    lines = text.splitlines()
+    for i, line in enumerate(lines):
+        if not line.startswith("core #"):
+            continue
+        header = [h.strip() for h in line.split(",")]
+        rows = [l.split() for l in lines[i + 1:] if l.strip() and (l.split()[0].isdigit() or l.startswith("sum"))]
+        if not rows:
+            break
+        row = next((r for r in rows if r[0] == "sum"), rows[0])
+        for name, value in zip(header[1:], row[1:]):
+            if value.endswith("%"):
+                continue
+            counts[name] = int(value)
+        break
+    return counts
+
+
+def pinned_name_regex(name):
+    # Pinning iterations inserts "/iterations:N" before any "/real_time" suffix.
+    stem, real_time = (name[:-len("/real_time")], "/real_time") if name.endswith("/real_time") else (name, "")
+    return "^" + re.escape(stem) + "/iterations:[0-9]+" + re.escape(real_time) + "$"
+
+
+def cost_model_counts(args, name, iterations, plugins):
+    with tempfile.NamedTemporaryFile(suffix=".log") as log:
+        cmd = base_command(args, plugins, log.name) + [
+            f"--benchmark_filter={pinned_name_regex(name)}",
+            "--benchmark_format=json",
+        ]
+        subprocess.run(cmd, env=bench_env(args, iterations), check=True, stdout=subprocess.DEVNULL)
+        with open(log.name) as f:
+            return parse_plugin_log(f.read())
+
+
+def add_cost_model(args, results):
+    plugins = [
+        find_plugin(args, "libinsn.so"),
+        find_plugin(args, "libcache.so") + "," + A53_CACHE_ARGS,
+    ]
+    n = args.cost_iterations
+    for name, metrics in results.items():
+        # Difference two pinned-iteration runs so process start-up and
+        # benchmark setup cancel out.
+        lo = cost_model_counts(args, name, n, plugins)
+        hi = cost_model_counts(args, name, 2 * n, plugins)
+
+        def per_iter(key):
+            if key in lo and key in hi:
+                return max(0.0, (hi[key] - lo[key]) / n)
+            return None
+
+        model = {
+            "a53_insns": per_iter("insns"),
+            "a53_l1d_misses": per_iter("data misses"),
+            "a53_l1i_misses": per_iter("insn misses"),
+            "a53_l2_misses": per_iter("l2 misses"),
+        }
+        model = {k: v for k, v in model.items() if v is not None}
+        if "a53_insns" in model:
+            l1 = model.get("a53_l1d_misses", 0) + model.get("a53_l1i_misses", 0)
+            l2 = model.get("a53_l2_misses", 0)
+            cycles = (model["a53_insns"] * A53_BASE_CPI + (l1 - l2) * A53_L1_MISS_CYCLES
+                      + l2 * A53_L2_MISS_CYCLES)
+            model["a53_est_ns"] = cycles / A53_CLOCK_GHZ
+        metrics.update(model)
+        print(f"  cost model {name}: " + ", ".join(f"{k}={v:.1f}" for k, v in model.items()))
+
+
+def git_revision():
+    try:
+        rev = subprocess.run(["git", "-C", REPO, "rev-parse", "--short", "HEAD"],
+                             capture_output=True, text=True, check=True).stdout.strip()
+        dirty = subprocess.run(["git", "-C", REPO, "status", "--porcelain", "--untracked-files=no"],
+                               capture_output=True, text=True, check=True).stdout.strip()
+        return rev + ("-dirty" if dirty else "")
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def load_history(path):
+    if not os.path.exists(path):
+        return []
+    with open(path) as f:
+        return [json.loads(line) for line in f if line.strip()]
+
+
+def load_thresholds(path):
+    if not os.path.exists(path):
+        return {"default": 0.15}
+    with open(path) as f:
+        return json.load(f)
+
+
+# Throughput counters restate cpu_ns, so they are recorded but never compared;
+# a slowdown would otherwise be reported twice.
+RATE_METRICS = ("items_per_second", "bytes_per_second")
+
+
+def threshold_for(thresholds, bench, metric):
+    per_bench = thresholds.get("benchmarks", {}).get(bench.split("/")[0], {})
+    if metric in per_bench:
+        return per_bench[metric]
+    return thresholds.get("metrics", {}).get(metric, thresholds.get("default", 0.15))
+
+
+def compare(entry, history, thresholds, window):
+    def comparable(h):
+        if h["mode"] != entry["mode"] or h["arch"] != entry["arch"]:
+            return False
+        # Native timings only mean something on the machine that produced them.
+        return entry["mode"] != "native" or h.get("host") == entry["host"]
+
+    prior = [h for h in history if comparable(h)][-window:]
+    if not prior:
+        print("no baseline for this mode/arch/host yet; recording only")
+        return []
+
+    regressions = []
+    for name, metrics in entry["benchmarks"].items():
+        for metric, value in metrics.items():
+            if metric in RATE_METRICS:
+                continue
+            series = [h["benchmarks"][name][metric] for h in prior
+                      if metric in h["benchmarks"].get(name, {})]
+            if not series or value is None:
+                continue
+            base = statistics.median(series)
+            if base == 0:
+                continue
+            worse = (value - base) / base
+            limit = threshold_for(thresholds, name, metric)
+            if worse > limit:
+                regressions.append((name, metric, base, value, worse, limit))
+    return regressions
+
+
+def main():
+    args = parse_args()
+    if args.qemu and shutil.which(args.qemu_bin) is None:
+        sys.exit(f"run.py: {args.qemu_bin} not found")
+
+    context, results = run_benchmarks(args)
+    if args.cost_model:
+        add_cost_model(args, results)
+
+    entry = {
+        "timestamp": datetime.datetime.now(datetime.timezone.utc).isoformat(timespec="seconds"),
+        "revision": git_revision(),
+        "mode": "qemu" if args.qemu else "native",
+        "arch": "aarch64" if args.qemu else platform.machine(),
+        "host": context.get("host_name", platform.node()),
+        "label": args.label,
+        "benchmarks": results,
+    }
+
+    history = load_history(args.history)
+    regressions = compare(entry, history, load_thresholds(args.thresholds), args.window)
+
+    if not args.no_record:
+        with open(args.history, "a") as f:
+            f.write(json.dumps(entry, sort_keys=True) + "\n")
+
+    for name, metric, base, value, worse, limit in regressions:
+        print(f"REGRESSION {name} {metric}: {base:.4g} -> {value:.4g} "
+              f"({worse:+.1%} worse, limit {limit:.0%})")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
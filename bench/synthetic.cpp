@@ -0,0 +1,363 @@
+#include "synthetic.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "etheros/capture/pcap.hpp"
+
+namespace etheros::bench {
+
+namespace {
+
+void put16(Frame& f, std::size_t off, std::uint16_t v) {
+  f[off] = static_cast<std::uint8_t>(v >> 8);
+  f[off + 1] = static_cast<std::uint8_t>(v);
+}
+
+void ethernet_ipv4_header(Frame& f, std::uint32_t src_ip, std::uint32_t dst_ip, std::uint8_t proto,
+                          std::size_t l4_len) {
+  static constexpr std::uint8_t kMacs[12] = {0x02, 0, 0, 0, 0, 1, 0x02, 0, 0, 0, 0, 2};
+  std::memcpy(f.data(), kMacs, sizeof(kMacs));
+  put16(f, 12, 0x0800);
+  std::uint8_t* ip = f.data() + 14;
+  ip[0] = 0x45;
+  put16(f, 16, static_cast<std::uint16_t>(20 + l4_len));
+  ip[8] = 64;
+  ip[9] = proto;
+  store_be32(ip + 12, src_ip);
+  store_be32(ip + 16, dst_ip);
+}
+
+// Builds a DNS-format message (DNS, mDNS, LLMNR, NBNS) with name compression
+// against every suffix written so far.
+class DnsMessage {
+ public:
+  DnsMessage(std::uint16_t id, std::uint16_t flags) : bytes_(12, 0) {
+    put16(bytes_, 0, id);
+    put16(bytes_, 2, flags);
+  }
+
+  void question(std::string_view name, std::uint16_t type, std::uint16_t rr_class) {
+    write_name(name);
+    push16(type);
+    push16(rr_class);
+    bump(4);
+  }
+
+  // section: 6 = answer, 8 = authority, 10 = additional (header count offset).
+  void record(std::size_t section, std::string_view name, std::uint16_t type, std::uint32_t ttl,
+              std::string_view rdata) {
+    const std::size_t len = begin(section, name, type, ttl);
+    bytes_.insert(bytes_.end(), rdata.begin(), rdata.end());
+    end(len);
+  }
+  void a_record(std::size_t section, std::string_view name, std::uint32_t ip) {
+    const std::size_t len = begin(section, name, 1, 120);
+    push16(static_cast<std::uint16_t>(ip >> 16));
+    push16(static_cast<std::uint16_t>(ip));
+    end(len);
+  }
+  void name_record(std::size_t section, std::string_view name, std::uint16_t type, std::string_view target) {
+    const std::size_t len = begin(section, name, type, 4500);
+    write_name(target);
+    end(len);
+  }
+  void srv_record(std::size_t section, std::string_view name, std::uint16_t port, std::string_view target) {
+    const std::size_t len = begin(section, name, 33, 120);
+    push16(0);
+    push16(0);
+    push16(port);
+    write_name(target);
+    end(len);
+  }
+  void nb_record(std::size_t section, std::string_view name, std::uint32_t ip) {
+    const std::size_t len = begin(section, name, 32, 300000);
+    push16(0);
+    push16(static_cast<std::uint16_t>(ip >> 16));
+    push16(static_cast<std::uint16_t>(ip));
+    end(len);
+  }
+
+  ByteSpan bytes() const { return bytes_; }
+
+ private:
+  void push16(std::uint16_t v) {
+    bytes_.push_back(static_cast<std::uint8_t>(v >> 8));
+    bytes_.push_back(static_cast<std::uint8_t>(v));
+  }
+  void bump(std::size_t count_offset) {
+    put16(bytes_, count_offset, static_cast<std::uint16_t>((bytes_[count_offset] << 8 | bytes_[count_offset + 1]) + 1));
+  }
+  std::size_t begin(std::size_t section, std::string_view name, std::uint16_t type, std::uint32_t ttl) {
+    write_name(name);
+    push16(type);
+    push16(1);
+    push16(static_cast<std::uint16_t>(ttl >> 16));
+    push16(static_cast<std::uint16_t>(ttl));
+    push16(0);
+    bump(section);
+    return bytes_.size();
+  }
+  void end(std::size_t rdata_start) {
+    put16(bytes_, rdata_start - 2, static_cast<std::uint16_t>(bytes_.size() - rdata_start));
+  }
+  void write_name(std::string_view name) {
+    while (!name.empty()) {
+      for (const auto& [suffix, offset] : suffixes_) {
+        if (suffix == name) {
+          push16(static_cast<std::uint16_t>(0xc000 | offset));
+          return;
+        }
+      }
+      suffixes_.emplace_back(std::string(name), static_cast<std::uint16_t>(bytes_.size()));
+      const std::size_t dot = name.find('.');
+      const std::string_view label = name.substr(0, dot);
+      bytes_.push_back(static_cast<std::uint8_t>(label.size()));
+      bytes_.insert(bytes_.end(), label.begin(), label.end());
+      name = dot == std::string_view::npos ? std::string_view() : name.substr(dot + 1);
+    }
+    bytes_.push_back(0);
+  }
+
+  Frame bytes_;
+  std::vector<std::pair<std::string, std::uint16_t>> suffixes_;
+};
+
+// First-level NetBIOS encoding: 15 space-padded characters plus a suffix
+// byte, each nibble written as 'A' + nibble.
+std::string netbios_name(std::string_view name, std::uint8_t suffix) {
+  std::uint8_t raw[16];
+  std::memset(raw, ' ', 15);
+  std::memcpy(raw, name.data(), std::min<std::size_t>(name.size(), 15));
+  raw[15] = suffix;
+  std::string out;
+  for (const std::uint8_t c : raw) {
+    out.push_back(static_cast<char>('A' + (c >> 4)));
+    out.push_back(static_cast<char>('A' + (c & 0xf)));
+  }
+  return out;
+}
+
+ByteSpan text_bytes(std::string_view text) {
+  return ByteSpan(reinterpret_cast<const std::uint8_t*>(text.data()), text.size());
+}
+
+}  // namespace
+
+Frame ethernet_ipv4_tcp(std::uint32_t src_ip, std::uint32_t dst_ip, std::uint16_t sport,
+                        std::uint16_t dport, std::uint32_t seq, std::uint8_t flags,
+                        std::size_t payload_len) {
+  Frame f(14 + 20 + 20 + payload_len, 0);
+  ethernet_ipv4_header(f, src_ip, dst_ip, 6, 20 + payload_len);
+  put16(f, 34, sport);
+  put16(f, 36, dport);
+  store_be32(f.data() + 38, seq);
+  f[46] = 5 << 4;
+  f[47] = flags;
+  put16(f, 48, 65535);
+  for (std::size_t i = 0; i < payload_len; ++i) f[54 + i] = static_cast<std::uint8_t>(i);
+  return f;
+}
+
+Frame ethernet_ipv4_udp(std::uint32_t src_ip, std::uint32_t dst_ip, std::uint16_t sport,
+                        std::uint16_t dport, ByteSpan payload) {
+  Frame f(14 + 20 + 8 + payload.size(), 0);
+  ethernet_ipv4_header(f, src_ip, dst_ip, 17, 8 + payload.size());
+  put16(f, 34, sport);
+  put16(f, 36, dport);
+  put16(f, 38, static_cast<std::uint16_t>(8 + payload.size()));
+  if (!payload.empty()) std::memcpy(f.data() + 42, payload.data(), payload.size());
+  return f;
+}
+
+Frame radiotap_beacon(std::uint64_t bssid, std::string_view ssid) {
+  // Minimal radiotap header (version 0, length 8, no fields), a beacon header,
+  // 12 bytes of fixed parameters and the SSID element.
+  constexpr std::size_t kRadiotap = 8;
+  constexpr std::size_t kBody = kRadiotap + 24 + 12;
+  Frame f(kBody + 2 + ssid.size(), 0);
+  f[2] = kRadiotap;
+  f[kRadiotap] = 0x80;  // management / beacon
+  std::memset(f.data() + kRadiotap + 4, 0xff, 6);
+  for (int i = 0; i < 6; ++i) {
+    const auto b = static_cast<std::uint8_t>(bssid >> (40 - 8 * i));
+    f[kRadiotap + 10 + i] = b;
+    f[kRadiotap + 16 + i] = b;
+  }
+  f[kBody] = 0;  // SSID element
+  f[kBody + 1] = static_cast<std::uint8_t>(ssid.size());
+  std::memcpy(f.data() + kBody + 2, ssid.data(), ssid.size());
+  return f;
+}
+
+void append_record(Trace& trace, std::uint64_t ts_ns, ByteSpan frame) {
+  if (trace.pcap.empty()) {
+    std::uint8_t hdr[capture::PcapReader::kGlobalHeaderSize] = {};
+    store_le32(hdr, 0xa1b23c4d);
+    hdr[4] = 2;
+    hdr[6] = 4;
+    store_le32(hdr + 16, 262144);
+    store_le32(hdr + 20, static_cast<std::uint32_t>(trace.link_type));
+    trace.pcap.assign(hdr, hdr + sizeof(hdr));
+  }
+  std::uint8_t rec[capture::PcapReader::kRecordHeaderSize];
+  store_le32(rec, static_cast<std::uint32_t>(ts_ns / 1'000'000'000));
+  store_le32(rec + 4, static_cast<std::uint32_t>(ts_ns % 1'000'000'000));
+  store_le32(rec + 8, static_cast<std::uint32_t>(frame.size()));
+  store_le32(rec + 12, static_cast<std::uint32_t>(frame.size()));
+  const std::size_t off = trace.pcap.size();
+  trace.pcap.resize(off + sizeof(rec) + frame.size());
+  std::memcpy(trace.pcap.data() + off, rec, sizeof(rec));
+  std::memcpy(trace.pcap.data() + off + sizeof(rec), frame.data(), frame.size());
+  ++trace.packets;
+  trace.payload_bytes += frame.size();
+}
+
+Trace mixed_ethernet_trace(std::size_t packets, std::size_t flows, std::uint64_t seed, TcpOrdering ordering) {
+  Rng rng(seed);
+  Trace trace;
+  // Per-flow next sequence number, from a spread of initial values so some
+  // flows wrap around 2^32 during the trace.
+  std::vector<std::uint32_t> next_seq(flows);
+  for (std::size_t f = 0; f < flows; ++f) next_seq[f] = static_cast<std::uint32_t>(f * 0x9e3779b9u);
+  std::vector<Frame> held(flows);
+  std::uint64_t ts = 1'700'000'000ull * 1'000'000'000;
+  for (std::size_t i = 0; i < packets; ++i) {
+    ts += 10'000 + rng.below(90'000);
+    const auto flow = static_cast<std::uint32_t>(rng.below(static_cast<std::uint32_t>(flows)));
+    const std::uint32_t client = 0x0a000000u | (flow & 0xffff);
+    const std::uint32_t server = 0xc0a80000u | ((flow >> 16) & 0xff);
+    if (rng.below(10) >= 7) {
+      std::uint8_t payload[48] = {};
+      append_record(trace, ts,
+                    ethernet_ipv4_udp(client, server, static_cast<std::uint16_t>(1024 + rng.below(60000)), 53,
+                                      ByteSpan(payload, 16 + rng.below(32))));
+      continue;
+    }
+
+    static constexpr std::size_t kSizes[] = {0, 0, 64, 512, 1460};
+    const std::size_t len = kSizes[rng.below(5)];
+    const std::uint32_t seq = next_seq[flow];
+    next_seq[flow] = seq + static_cast<std::uint32_t>(len);
+    if (len > 0 && ordering.loss_per_mille && rng.below(1000) < ordering.loss_per_mille) continue;
+    Frame f = ethernet_ipv4_tcp(client, server, static_cast<std::uint16_t>(32768 + (flow % 28000)), 443, seq, 0x18,
+                                len);
+    if (!held[flow].empty()) {
+      append_record(trace, ts, f);
+      append_record(trace, ts + 1'000, held[flow]);
+      held[flow].clear();
+    } else if (len > 0 && ordering.reorder_per_mille && rng.below(1000) < ordering.reorder_per_mille) {
+      held[flow] = std::move(f);
+    } else {
+      append_record(trace, ts, f);
+    }
+  }
+  // Segments still held back arrive at the end.
+  for (const Frame& f : held) {
+    if (f.empty()) continue;
+    ts += 10'000;
+    append_record(trace, ts, f);
+  }
+  return trace;
+}
+
+Trace discovery_trace(std::size_t packets, std::size_t hosts, std::uint64_t seed) {
+  static constexpr std::string_view kServices[] = {"_ipp._tcp",        "_smb._tcp",  "_airplay._tcp",
+                                                   "_googlecast._tcp", "_http._tcp", "_ssh._tcp",
+                                                   "_workstation._tcp", "_printer._tcp"};
+  static constexpr std::string_view kDevices[] = {"urn:schemas-upnp-org:device:MediaRenderer:1",
+                                                  "urn:schemas-upnp-org:device:InternetGatewayDevice:1",
+                                                  "urn:schemas-upnp-org:device:Printer:1", "upnp:rootdevice"};
+  constexpr std::uint32_t kMdnsGroup = 0xe00000fb;
+  constexpr std::uint32_t kLlmnrGroup = 0xe00000fc;
+  constexpr std::uint32_t kSsdpGroup = 0xeffffffa;
+  constexpr std::uint32_t kBroadcast = 0x0a01ffff;
+
+  Rng rng(seed);
+  Trace trace;
+  std::uint64_t ts = 1'700'000'000ull * 1'000'000'000;
+  for (std::size_t i = 0; i < packets; ++i) {
+    ts += 10'000 + rng.below(90'000);
+    if (i % 2 == 0) {
+      const auto flow = static_cast<std::uint32_t>(rng.below(4096));
+      append_record(trace, ts,
+                    ethernet_ipv4_tcp(0x0a010000u | flow, 0xc0a80001u, static_cast<std::uint16_t>(32768 + flow), 443,
+                                      static_cast<std::uint32_t>(rng.next()), 0x18, 64 + rng.below(1400)));
+      continue;
+    }
+
+    const std::uint32_t h = rng.below(static_cast<std::uint32_t>(hosts));
+    const std::uint32_t ip = 0x0a010000u | (h & 0xffff);
+    const std::string host = "host-" + std::to_string(h);
+    const std::string_view service = kServices[(h + rng.below(2) * 3) % 8];
+    const auto id = static_cast<std::uint16_t>(rng.next());
+    const std::uint32_t kind = rng.below(20);
+    Frame f;
+    if (kind < 6) {
+      // mDNS announcement: PTR, SRV, TXT and A in one response.
+      const std::string type = std::string(service) + ".local";
+      const std::string instance = host + "." + type;
+      DnsMessage m(0, 0x8400);
+      m.name_record(6, type, 12, instance);
+      m.srv_record(6, instance, static_cast<std::uint16_t>(1024 + h % 4096), host + ".local");
+      m.record(6, instance, 16, 4500, "\x09txtvers=1");
+      m.a_record(6, host + ".local", ip);
+      f = ethernet_ipv4_udp(ip, kMdnsGroup, 5353, 5353, m.bytes());
+    } else if (kind < 10) {
+      DnsMessage m(0, 0);
+      m.question(std::string(service) + ".local", 12, 1);
+      f = ethernet_ipv4_udp(ip, kMdnsGroup, 5353, 5353, m.bytes());
+    } else if (kind < 13) {
+      DnsMessage m(id, 0);
+      m.question(rng.below(4) == 0 ? "wpad" : "fileserver-" + std::to_string(rng.below(64)), 1, 1);
+      f = ethernet_ipv4_udp(ip, kLlmnrGroup, static_cast<std::uint16_t>(49152 + rng.below(16384)), 5355, m.bytes());
+    } else if (kind < 16) {
+      DnsMessage m(id, 0x0110);
+      m.question(netbios_name("FILESERVER" + std::to_string(rng.below(16)), 0x20), 32, 1);
+      f = ethernet_ipv4_udp(ip, kBroadcast, 137, 137, m.bytes());
+    } else if (kind < 17) {
+      // Registration: the name as a question and its address as additional.
+      std::string upper = host;
+      for (char& c : upper) c = static_cast<char>(c >= 'a' && c <= 'z' ? c - 32 : c);
+      const std::string name = netbios_name(upper, 0x00);
+      DnsMessage m(id, 0x2910);
+      m.question(name, 32, 1);
+      m.nb_record(10, name, ip);
+      f = ethernet_ipv4_udp(ip, kBroadcast, 137, 137, m.bytes());
+    } else if (kind < 19) {
+      const std::string_view device = kDevices[h % 4];
+      const std::string notify = "NOTIFY * HTTP/1.1\r\nHOST: 239.255.255.250:1900\r\nCACHE-CONTROL: max-age=1800\r\n"
+                                 "LOCATION: http://10.1." + std::to_string(h >> 8 & 0xff) + "." +
+                                 std::to_string(h & 0xff) + ":49152/description.xml\r\nNT: " + std::string(device) +
+                                 "\r\nNTS: ssdp:alive\r\nSERVER: Linux/5.10 UPnP/1.0 etheros/1.0\r\nUSN: uuid:" +
+                                 std::to_string(h) + "::" + std::string(device) + "\r\n\r\n";
+      f = ethernet_ipv4_udp(ip, kSsdpGroup, 1900, 1900, text_bytes(notify));
+    } else {
+      static constexpr std::string_view kSearch =
+          "M-SEARCH * HTTP/1.1\r\nHOST: 239.255.255.250:1900\r\nMAN: \"ssdp:discover\"\r\nMX: 2\r\n"
+          "ST: ssdp:all\r\n\r\n";
+      f = ethernet_ipv4_udp(ip, kSsdpGroup, static_cast<std::uint16_t>(49152 + rng.below(16384)), 1900,
+                            text_bytes(kSearch));
+    }
+    append_record(trace, ts, f);
+  }
+  return trace;
+}
+
+Trace beacon_trace(std::size_t packets, std::size_t aps, std::uint64_t seed) {
+  Rng rng(seed);
+  Trace trace;
+  trace.link_type = capture::LinkType::kRadiotap;
+  std::uint64_t ts = 1'700'000'000ull * 1'000'000'000;
+  for (std::size_t i = 0; i < packets; ++i) {
+    ts += 102'400;
+    const std::uint32_t ap = rng.below(static_cast<std::uint32_t>(aps));
+    const Frame f = radiotap_beacon(0x020000000000ull | ap, "etheros-ap-" + std::to_string(ap));
+    append_record(trace, ts, f);
+  }
+  return trace;
+}
+
+}  // namespace etheros::bench
@@ -0,0 +1,70 @@
+#pragma once
+
+// Deterministic synthetic traffic for benchmarks. Generation uses its own PRNG
+// so a trace is byte-identical on x86-64 and AArch64, keeping native and qemu
+// results comparable.
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "etheros/capture/packet.hpp"
+#include "etheros/common/bytes.hpp"
+
+namespace etheros::bench {
+
+class Rng {
+ public:
+  explicit Rng(std::uint64_t seed) : s_(seed ? seed : 0x9e3779b97f4a7c15ull) {}
+  std::uint64_t next() {
+    s_ ^= s_ << 13;
+    s_ ^= s_ >> 7;
+    s_ ^= s_ << 17;
+    return s_;
+  }
+  std::uint32_t below(std::uint32_t n) { return static_cast<std::uint32_t>(next() % n); }
+
+ private:
+  std::uint64_t s_;
+};
+
+using Frame = std::vector<std::uint8_t>;
+
+Frame ethernet_ipv4_tcp(std::uint32_t src_ip, std::uint32_t dst_ip, std::uint16_t sport,
+                        std::uint16_t dport, std::uint32_t seq, std::uint8_t flags,
+                        std::size_t payload_len);
+Frame ethernet_ipv4_udp(std::uint32_t src_ip, std::uint32_t dst_ip, std::uint16_t sport,
+                        std::uint16_t dport, ByteSpan payload);
+Frame radiotap_beacon(std::uint64_t bssid, std::string_view ssid);
+
+// A whole trace serialised as a classic pcap file image.
+struct Trace {
+  capture::LinkType link_type = capture::LinkType::kEthernet;
+  std::vector<std::uint8_t> pcap;
+  std::size_t packets = 0;
+  std::size_t payload_bytes = 0;
+};
+
+void append_record(Trace& trace, std::uint64_t ts_ns, ByteSpan frame);
+
+// How TCP segments reach the capture. Sequence numbers always advance in
+// order within a flow; then reorder_per_mille of the data segments are held
+// back and sent after the flow's next one, and loss_per_mille are dropped,
+// leaving a hole in the stream.
+struct TcpOrdering {
+  std::uint32_t reorder_per_mille = 0;
+  std::uint32_t loss_per_mille = 0;
+};
+
+// Office-LAN style mix: ~70% TCP across `flows` connections, the rest UDP.
+// Dropped segments are not written, so the trace may hold fewer than
+// `packets` records.
+Trace mixed_ethernet_trace(std::size_t packets, std::size_t flows, std::uint64_t seed, TcpOrdering ordering = {});
+// Enterprise-LAN style discovery chatter from `hosts` machines: mDNS
+// announcements and queries, LLMNR, NBNS queries and registrations, and SSDP,
+// interleaved 1:1 with background TCP/UDP.
+Trace discovery_trace(std::size_t packets, std::size_t hosts, std::uint64_t seed);
+// Monitor-mode beacons from `aps` access points.
+Trace beacon_trace(std::size_t packets, std::size_t aps, std::uint64_t seed);
+
+}  // namespace etheros::bench
@@ -0,0 +1,24 @@
+# Cross toolchain for the Raspberry Pi Zero 2 W (Cortex-A53, AArch64).
+#
+#   cmake -S . -B build-a64 -DCMAKE_TOOLCHAIN_FILE=cmake/toolchains/aarch64-linux-gnu.cmake
+#
+# Binaries built this way run on the board or on a host under qemu-aarch64
+# user mode (see bench/run.py --qemu).
+
+set(CMAKE_SYSTEM_NAME Linux)
+set(CMAKE_SYSTEM_PROCESSOR aarch64)
+
+set(ETHEROS_CROSS_PREFIX aarch64-linux-gnu- CACHE STRING "Cross compiler prefix")
+set(CMAKE_C_COMPILER ${ETHEROS_CROSS_PREFIX}gcc)
+set(CMAKE_CXX_COMPILER ${ETHEROS_CROSS_PREFIX}g++)
+
+set(CMAKE_SYSROOT_DEFAULT /usr/aarch64-linux-gnu)
+if(EXISTS ${CMAKE_SYSROOT_DEFAULT})
+  list(APPEND CMAKE_FIND_ROOT_PATH ${CMAKE_SYSROOT_DEFAULT})
+endif()
+set(CMAKE_FIND_ROOT_PATH_MODE_PROGRAM NEVER)
+set(CMAKE_FIND_ROOT_PATH_MODE_LIBRARY ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_INCLUDE ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_PACKAGE ONLY)
+
+set(ETHEROS_TUNE_A53 ON CACHE BOOL "" FORCE)
@@ -0,0 +1,48 @@
+// libFuzzer entry point for the discovery parsers: DnsReader (mDNS, LLMNR and
+// NBNS), parse_ssdp, and the harvester on top of them. The first input byte
+// picks the port the packet appears on.
+//
+//   cmake -S . -B _fuzz -DCMAKE_CXX_COMPILER=clang++ -DETHEROS_BUILD_FUZZERS=ON
+//   cmake --build _fuzz --target etheros-fuzz-discovery
+//   _fuzz/fuzz/etheros-fuzz-discovery -max_len=1500 corpus/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "etheros/discovery/dns.hpp"
+#include "etheros/discovery/harvester.hpp"
+#include "etheros/discovery/ssdp.hpp"
+
+using namespace etheros;
+using namespace etheros::discovery;
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+  if (size == 0) return 0;
+  static constexpr std::uint16_t kPorts[] = {kMdnsPort, kLlmnrPort, kNbnsPort, kSsdpPort};
+  const std::uint16_t port = kPorts[data[0] % 4];
+  const ByteSpan payload(data + 1, size - 1);
+
+  DnsReader reader(payload);
+  DnsRecord rr;
+  DnsName name;
+  while (reader.next(rr)) {
+    if (reader.name(rr.name_offset, name)) decode_netbios_name(name.view(), name);
+    reader.name(rr.rdata_offset, name);
+  }
+  SsdpMessage msg;
+  parse_ssdp(payload, msg);
+
+  // A fresh harvester per input keeps runs reproducible.
+  Harvester harvester;
+  parse::DecodedPacket pkt;
+  pkt.layers = parse::kLayerL2 | parse::kLayerIp | parse::kLayerUdp;
+  pkt.ip_version = 4;
+  pkt.ip_proto = 17;
+  static constexpr std::uint8_t kSrc[4] = {10, 0, 0, 1};
+  pkt.src_ip = IpAddress::from_v4(kSrc);
+  pkt.src_port = port;
+  pkt.dst_port = port;
+  pkt.payload = payload;
+  harvester.process(1'700'000'000ull * 1'000'000'000, pkt);
+  return 0;
+}
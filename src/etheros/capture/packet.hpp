@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+#include "etheros/common/bytes.hpp"
+
+namespace etheros::capture {
+
+// DLT_* link-layer header types as recorded in pcap files.
+enum class LinkType : std::uint32_t {
+  kEthernet = 1,
+  kIeee80211 = 105,
+  kRadiotap = 127,
+};
+
+// A captured frame. `data` borrows from the capture buffer it came from and is
+// only valid until that buffer advances.
+struct Packet {
+  std::uint64_t ts_ns = 0;
+  std::uint32_t orig_len = 0;
+  ByteSpan data;
+};
+
+}  // namespace etheros::capture
@@ -0,0 +1,76 @@
+#include "etheros/capture/packet_ring.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace etheros::capture {
+
+PacketRing::PacketRing(std::size_t capacity)
+    : capacity_(std::bit_ceil(capacity < 4096 ? std::size_t{4096} : capacity)),
+      mask_(capacity_ - 1),
+      buffer_(new std::uint8_t[capacity_]) {}
+
+bool PacketRing::try_push(std::uint64_t ts_ns, std::uint32_t orig_len, ByteSpan data) {
+  const std::size_t need = record_size(data.size());
+  const std::uint64_t head = head_.load(std::memory_order_relaxed);
+  const std::size_t pos = head & mask_;
+  const std::size_t contiguous = capacity_ - pos;
+  const std::size_t total = need > contiguous ? contiguous + need : need;
+
+  if (need > capacity_ / 2) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  if (head + total - cached_tail_ > capacity_) {
+    cached_tail_ = tail_.load(std::memory_order_acquire);
+    if (head + total - cached_tail_ > capacity_) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  }
+
+  std::uint8_t* dst = buffer_.get() + pos;
+  if (need > contiguous) {
+    RecordHeader marker{kWrapMarker, 0, 0};
+    std::memcpy(dst, &marker, sizeof(marker));
+    dst = buffer_.get();
+  }
+  RecordHeader hdr{static_cast<std::uint32_t>(data.size()), orig_len, ts_ns};
+  std::memcpy(dst, &hdr, sizeof(hdr));
+  std::memcpy(dst + sizeof(hdr), data.data(), data.size());
+
+  head_.store(head + total, std::memory_order_release);
+  return true;
+}
+
+bool PacketRing::peek(Packet& out) {
+  for (;;) {
+    const std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == cached_head_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail == cached_head_) return false;
+    }
+
+    const std::size_t pos = tail & mask_;
+    RecordHeader hdr;
+    std::memcpy(&hdr, buffer_.get() + pos, sizeof(hdr));
+    if (hdr.caplen == kWrapMarker) {
+      tail_.store(tail + (capacity_ - pos), std::memory_order_release);
+      continue;
+    }
+
+    out.ts_ns = hdr.ts_ns;
+    out.orig_len = hdr.orig_len;
+    out.data = ByteSpan(buffer_.get() + pos + sizeof(hdr), hdr.caplen);
+    pending_pop_ = record_size(hdr.caplen);
+    return true;
+  }
+}
+
+void PacketRing::pop() {
+  if (pending_pop_ == 0) return;
+  tail_.store(tail_.load(std::memory_order_relaxed) + pending_pop_, std::memory_order_release);
+  pending_pop_ = 0;
+}
+
+}  // namespace etheros::capture
@@ -0,0 +1,62 @@
+#pragma once
+
+// Single-producer/single-consumer ring of variable-length packets, used to hand
+// frames from the capture thread to analysis without per-packet allocation.
+//
+// Records are laid out contiguously: a 16-byte header followed by the frame
+// bytes padded to 16. A record never straddles the end of the buffer; when it
+// would, the producer writes a wrap marker and restarts at offset 0.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "etheros/capture/packet.hpp"
+
+namespace etheros::capture {
+
+class PacketRing {
+ public:
+  // capacity is rounded up to a power of two (minimum 4 KiB).
+  explicit PacketRing(std::size_t capacity);
+
+  // Producer side. Returns false (and counts a drop) if the ring is full.
+  bool try_push(std::uint64_t ts_ns, std::uint32_t orig_len, ByteSpan data);
+
+  // Consumer side. peek() exposes the oldest packet without copying; the view
+  // stays valid until pop() is called.
+  bool peek(Packet& out);
+  void pop();
+
+  std::size_t capacity() const { return capacity_; }
+  std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  struct RecordHeader {
+    std::uint32_t caplen;
+    std::uint32_t orig_len;
+    std::uint64_t ts_ns;
+  };
+  static constexpr std::uint32_t kWrapMarker = 0xffffffffu;
+
+  static std::size_t record_size(std::size_t caplen) {
+    return sizeof(RecordHeader) + ((caplen + 15) & ~std::size_t{15});
+  }
+
+  std::size_t capacity_;
+  std::size_t mask_;
+  std::unique_ptr<std::uint8_t[]> buffer_;
+
+  // Producer and consumer indices live on separate cache lines; each side keeps
+  // a private copy of the other's index to avoid touching the shared line on
+  // every call.
+  alignas(64) std::atomic<std::uint64_t> head_{0};
+  std::uint64_t cached_tail_ = 0;
+  alignas(64) std::atomic<std::uint64_t> tail_{0};
+  std::uint64_t cached_head_ = 0;
+  std::size_t pending_pop_ = 0;
+  alignas(64) std::atomic<std::uint64_t> dropped_{0};
+};
+
+}  // namespace etheros::capture
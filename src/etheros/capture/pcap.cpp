@@ -0,0 +1,77 @@
+#include "etheros/capture/pcap.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace etheros::capture {
+
+namespace {
+
+constexpr std::uint32_t kMagicMicro = 0xa1b2c3d4;
+constexpr std::uint32_t kMagicNano = 0xa1b23c4d;
+
+}  // namespace
+
+PcapReader::PcapReader(ByteSpan file) : file_(file) {
+  if (file_.size() < kGlobalHeaderSize) throw std::runtime_error("pcap: file too short");
+
+  const std::uint32_t magic = load_le32(file_.data());
+  if (magic == kMagicMicro || magic == kMagicNano) {
+    swapped_ = false;
+  } else if (load_be32(file_.data()) == kMagicMicro || load_be32(file_.data()) == kMagicNano) {
+    swapped_ = true;
+  } else {
+    throw std::runtime_error("pcap: bad magic (pcapng is not supported)");
+  }
+  nanosecond_ = load32(file_.data()) == kMagicNano;
+  snaplen_ = load32(file_.data() + 16);
+  link_type_ = static_cast<LinkType>(load32(file_.data() + 20) & 0x0fffffff);
+}
+
+bool PcapReader::next(Packet& out) {
+  if (offset_ + kRecordHeaderSize > file_.size()) {
+    truncated_ = offset_ != file_.size();
+    return false;
+  }
+  const std::uint8_t* rec = file_.data() + offset_;
+  const std::uint32_t sec = load32(rec);
+  const std::uint32_t frac = load32(rec + 4);
+  const std::uint32_t caplen = load32(rec + 8);
+  const std::uint32_t orig_len = load32(rec + 12);
+
+  if (caplen > file_.size() - offset_ - kRecordHeaderSize) {
+    truncated_ = true;
+    offset_ = file_.size();
+    return false;
+  }
+
+  out.ts_ns = std::uint64_t{sec} * 1'000'000'000 + (nanosecond_ ? frac : std::uint64_t{frac} * 1000);
+  out.orig_len = orig_len;
+  out.data = ByteSpan(rec + kRecordHeaderSize, caplen);
+  offset_ += kRecordHeaderSize + caplen;
+  return true;
+}
+
+PcapWriter::PcapWriter(io::FdWriter& out, LinkType link_type, std::uint32_t snaplen)
+    : out_(out), snaplen_(snaplen) {
+  std::uint8_t hdr[PcapReader::kGlobalHeaderSize] = {};
+  store_le32(hdr, kMagicNano);
+  hdr[4] = 2;  // version 2.4
+  hdr[6] = 4;
+  store_le32(hdr + 16, snaplen);
+  store_le32(hdr + 20, static_cast<std::uint32_t>(link_type));
+  out_.write(ByteSpan(hdr, sizeof(hdr)));
+}
+
+void PcapWriter::write(const Packet& packet) {
+  const auto caplen = static_cast<std::uint32_t>(std::min<std::size_t>(packet.data.size(), snaplen_));
+  std::uint8_t rec[PcapReader::kRecordHeaderSize];
+  store_le32(rec, static_cast<std::uint32_t>(packet.ts_ns / 1'000'000'000));
+  store_le32(rec + 4, static_cast<std::uint32_t>(packet.ts_ns % 1'000'000'000));
+  store_le32(rec + 8, caplen);
+  store_le32(rec + 12, std::max(packet.orig_len, caplen));
+  out_.write(ByteSpan(rec, sizeof(rec)));
+  out_.write(packet.data.first(caplen));
+}
+
+}  // namespace etheros::capture
@@ -0,0 +1,57 @@
+#pragma once
+
+// Classic libpcap file format (not pcapng). Reading is zero-copy over a byte
+// buffer, normally a MappedFile; writing goes through a buffered FdWriter.
+
+#include <cstdint>
+
+#include "etheros/capture/packet.hpp"
+#include "etheros/io/fd_writer.hpp"
+
+namespace etheros::capture {
+
+class PcapReader {
+ public:
+  // Throws std::runtime_error if the global header is missing or unknown.
+  explicit PcapReader(ByteSpan file);
+
+  // Returns false at end of file. A record cut short by power loss ends the
+  // stream and sets truncated() instead of throwing.
+  bool next(Packet& out);
+  void rewind() { offset_ = kGlobalHeaderSize; }
+
+  LinkType link_type() const { return link_type_; }
+  std::uint32_t snaplen() const { return snaplen_; }
+  bool truncated() const { return truncated_; }
+
+  static constexpr std::size_t kGlobalHeaderSize = 24;
+  static constexpr std::size_t kRecordHeaderSize = 16;
+
+ private:
+  std::uint32_t load32(const std::uint8_t* p) const {
+    return swapped_ ? load_be32(p) : load_le32(p);
+  }
+
+  ByteSpan file_;
+  std::size_t offset_ = kGlobalHeaderSize;
+  bool swapped_ = false;
+  bool nanosecond_ = false;
+  bool truncated_ = false;
+  LinkType link_type_ = LinkType::kEthernet;
+  std::uint32_t snaplen_ = 0;
+};
+
+class PcapWriter {
+ public:
+  // Writes the global header immediately. Timestamps are stored with
+  // nanosecond resolution.
+  PcapWriter(io::FdWriter& out, LinkType link_type, std::uint32_t snaplen = 262144);
+
+  void write(const Packet& packet);
+
+ private:
+  io::FdWriter& out_;
+  std::uint32_t snaplen_;
+};
+
+}  // namespace etheros::capture
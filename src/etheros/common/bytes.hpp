@@ -0,0 +1,94 @@
+#pragma once
+
+// Byte-order helpers and small value types shared by the parsers.
+// All loads are unaligned-safe; capture buffers make no alignment promises.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace etheros {
+
+using ByteSpan = std::span<const std::uint8_t>;
+
+inline std::uint16_t load_be16(const std::uint8_t* p) {
+  return static_cast<std::uint16_t>((p[0] << 8) | p[1]);
+}
+
+inline std::uint32_t load_be32(const std::uint8_t* p) {
+  return (std::uint32_t{p[0]} << 24) | (std::uint32_t{p[1]} << 16) |
+         (std::uint32_t{p[2]} << 8) | std::uint32_t{p[3]};
+}
+
+inline std::uint16_t load_le16(const std::uint8_t* p) {
+  return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline std::uint32_t load_le32(const std::uint8_t* p) {
+  return std::uint32_t{p[0]} | (std::uint32_t{p[1]} << 8) |
+         (std::uint32_t{p[2]} << 16) | (std::uint32_t{p[3]} << 24);
+}
+
+inline void store_le32(std::uint8_t* p, std::uint32_t v) {
+  p[0] = static_cast<std::uint8_t>(v);
+  p[1] = static_cast<std::uint8_t>(v >> 8);
+  p[2] = static_cast<std::uint8_t>(v >> 16);
+  p[3] = static_cast<std::uint8_t>(v >> 24);
+}
+
+inline void store_be32(std::uint8_t* p, std::uint32_t v) {
+  p[0] = static_cast<std::uint8_t>(v >> 24);
+  p[1] = static_cast<std::uint8_t>(v >> 16);
+  p[2] = static_cast<std::uint8_t>(v >> 8);
+  p[3] = static_cast<std::uint8_t>(v);
+}
+
+struct MacAddress {
+  std::array<std::uint8_t, 6> octets{};
+
+  static MacAddress from(const std::uint8_t* p) {
+    MacAddress m;
+    std::memcpy(m.octets.data(), p, 6);
+    return m;
+  }
+
+  // Packs the address into the low 48 bits, for hashing and compact storage.
+  std::uint64_t to_u64() const {
+    std::uint64_t v = 0;
+    for (std::uint8_t b : octets) v = (v << 8) | b;
+    return v;
+  }
+
+  friend bool operator==(const MacAddress&, const MacAddress&) = default;
+};
+
+// IPv4 addresses are stored IPv4-mapped (::ffff:a.b.c.d) so that flow keys and
+// inventories have a single fixed-width representation.
+struct IpAddress {
+  std::array<std::uint8_t, 16> bytes{};
+
+  static IpAddress from_v4(const std::uint8_t* p) {
+    IpAddress a;
+    a.bytes[10] = 0xff;
+    a.bytes[11] = 0xff;
+    std::memcpy(a.bytes.data() + 12, p, 4);
+    return a;
+  }
+
+  static IpAddress from_v6(const std::uint8_t* p) {
+    IpAddress a;
+    std::memcpy(a.bytes.data(), p, 16);
+    return a;
+  }
+
+  bool is_v4() const {
+    static constexpr std::uint8_t prefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+    return std::memcmp(bytes.data(), prefix, sizeof(prefix)) == 0;
+  }
+
+  friend bool operator==(const IpAddress&, const IpAddress&) = default;
+};
+
+}  // namespace etheros
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+#include "etheros/common/bytes.hpp"
+
+namespace etheros {
+
+// CRC-32 (IEEE 802.3, reflected). Pass a previous result as `crc` to extend it.
+std::uint32_t crc32(ByteSpan data, std::uint32_t crc = 0);
+
+}  // namespace etheros
@@ -0,0 +1,49 @@
+#pragma once
+
+// Lowercase hex encoding, shared by the 22000 target format and the cluster
+// protocol. Decoding accepts either case.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "etheros/common/bytes.hpp"
+
+namespace etheros {
+
+// Value of one hex digit, or -1.
+inline int hex_value(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+inline void append_hex(std::string& out, ByteSpan bytes) {
+  static constexpr char kDigits[] = "0123456789abcdef";
+  for (const std::uint8_t b : bytes) {
+    out.push_back(kDigits[b >> 4]);
+    out.push_back(kDigits[b & 0xf]);
+  }
+}
+
+inline void append_hex(std::string& out, std::string_view bytes) {
+  append_hex(out, ByteSpan(reinterpret_cast<const std::uint8_t*>(bytes.data()), bytes.size()));
+}
+
+// Decodes into out (a std::string or std::vector<std::uint8_t>). Returns false
+// on odd length or a non-hex digit; out is then unspecified.
+template <typename Bytes>
+bool decode_hex(std::string_view hex, Bytes& out) {
+  if (hex.size() % 2 != 0) return false;
+  out.resize(hex.size() / 2);
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    const int hi = hex_value(hex[2 * i]), lo = hex_value(hex[2 * i + 1]);
+    if (hi < 0 || lo < 0) return false;
+    out[i] = static_cast<typename Bytes::value_type>(hi << 4 | lo);
+  }
+  return true;
+}
+
+}  // namespace etheros
@@ -0,0 +1,258 @@
+#include "etheros/crack/checkpoint.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include "etheros/common/bytes.hpp"
+#include "etheros/common/crc32.hpp"
+#include "etheros/io/fd_writer.hpp"
+#include "etheros/io/mapped_file.hpp"
+
+namespace etheros::crack {
+
+namespace {
+
+constexpr char kSnapshotMagic[8] = {'E', 'T', 'H', 'C', 'K', 'P', 'T', '1'};
+constexpr std::size_t kSnapshotHeader = 8 + 8 + 8 + 8 + 4;  // magic, job, chunks, found index, found length
+constexpr std::uint64_t kNotFound = ~std::uint64_t{0};
+
+// Journal record: type u16, payload length u16, crc u32, value u64, payload
+// padded to 16. The CRC covers the record with the crc field zeroed.
+constexpr std::size_t kRecordHeader = 16;
+enum RecordType : std::uint16_t {
+  kRecordOpen = 1,  // value = job id, payload = total chunks (u64 LE)
+  kRecordDone = 2,  // value = chunk
+  kRecordFound = 3, // value = candidate index, payload = candidate
+};
+
+std::uint64_t load_le64(const std::uint8_t* p) { return std::uint64_t{load_le32(p)} | std::uint64_t{load_le32(p + 4)} << 32; }
+
+void store_le64(std::uint8_t* p, std::uint64_t v) {
+  store_le32(p, static_cast<std::uint32_t>(v));
+  store_le32(p + 4, static_cast<std::uint32_t>(v >> 32));
+}
+
+std::size_t padded(std::size_t n) { return (n + 7) & ~std::size_t{7}; }
+std::size_t record_padded(std::size_t n) { return (n + 15) & ~std::size_t{15}; }
+
+[[noreturn]] void throw_errno(const std::string& what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+void fsync_dir(const std::string& dir) {
+  const int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) throw_errno("open " + dir);
+  const int r = ::fsync(fd);
+  ::close(fd);
+  if (r != 0) throw_errno("fsync " + dir);
+}
+
+bool file_exists(const std::string& path) { return ::access(path.c_str(), F_OK) == 0; }
+
+}  // namespace
+
+Checkpoint::Checkpoint(const std::string& dir, std::uint64_t job_id, std::uint64_t total_chunks)
+    : dir_(dir), job_id_(job_id), total_chunks_(total_chunks), bitmap_((total_chunks + 63) / 64, 0) {
+  load_snapshot();
+  const std::string journal = dir_ + "/journal";
+  const bool existed = file_exists(journal);
+  journal_fd_ = ::open(journal.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (journal_fd_ < 0) throw_errno("open " + journal);
+  try {
+    if (existed) {
+      replay_journal();
+    } else {
+      reset_journal();
+      // Without this the new journal's entry, and the run's progress with
+      // it, can be missing after power loss.
+      fsync_dir(dir_);
+    }
+  } catch (...) {
+    ::close(journal_fd_);
+    throw;
+  }
+}
+
+Checkpoint::~Checkpoint() {
+  try {
+    sync();
+  } catch (...) {
+  }
+  if (journal_fd_ >= 0) ::close(journal_fd_);
+}
+
+void Checkpoint::load_snapshot() {
+  const std::string path = dir_ + "/snapshot";
+  if (!file_exists(path)) return;
+
+  io::MappedFile file(path);
+  const ByteSpan b = file.bytes();
+  if (b.size() < kSnapshotHeader + 4 || std::memcmp(b.data(), kSnapshotMagic, 8) != 0)
+    throw std::runtime_error(path + ": not a checkpoint snapshot");
+  if (crc32(b.first(b.size() - 4)) != load_le32(b.data() + b.size() - 4))
+    throw std::runtime_error(path + ": checksum mismatch");
+  if (load_le64(b.data() + 8) != job_id_ || load_le64(b.data() + 16) != total_chunks_)
+    throw std::runtime_error(dir_ + " holds state for a different job; use another directory or --reset");
+
+  const std::uint64_t found_index = load_le64(b.data() + 24);
+  const std::uint32_t found_len = load_le32(b.data() + 32);
+  const std::size_t bitmap_bytes = bitmap_.size() * 8;
+  if (b.size() != kSnapshotHeader + padded(found_len) + bitmap_bytes + 4)
+    throw std::runtime_error(path + ": truncated");
+  if (found_index != kNotFound)
+    found_ = Found{found_index, std::string(reinterpret_cast<const char*>(b.data()) + kSnapshotHeader, found_len)};
+
+  const std::uint8_t* bits = b.data() + kSnapshotHeader + padded(found_len);
+  for (std::size_t i = 0; i < bitmap_.size(); ++i) {
+    bitmap_[i] = load_le64(bits + 8 * i);
+    done_count_ += static_cast<std::uint64_t>(__builtin_popcountll(bitmap_[i]));
+  }
+}
+
+void Checkpoint::replay_journal() {
+  std::vector<std::uint8_t> data;
+  {
+    std::uint8_t buf[65536];
+    for (;;) {
+      const ssize_t n = ::read(journal_fd_, buf, sizeof(buf));
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        throw_errno("read " + dir_ + "/journal");
+      }
+      if (n == 0) break;
+      data.insert(data.end(), buf, buf + n);
+    }
+  }
+
+  std::size_t off = 0;
+  bool opened = false;
+  while (off + kRecordHeader <= data.size()) {
+    std::uint8_t* rec = data.data() + off;
+    const std::uint16_t type = load_le16(rec);
+    const std::uint16_t len = load_le16(rec + 2);
+    const std::size_t size = kRecordHeader + record_padded(len);
+    if (off + size > data.size()) break;
+    const std::uint32_t crc = load_le32(rec + 4);
+    store_le32(rec + 4, 0);
+    if (crc32(ByteSpan(rec, kRecordHeader + len)) != crc) break;
+
+    const std::uint64_t value = load_le64(rec + 8);
+    if (type == kRecordOpen) {
+      if (value != job_id_ || len != 8 || load_le64(rec + kRecordHeader) != total_chunks_)
+        throw std::runtime_error(dir_ + " holds state for a different job; use another directory or --reset");
+      opened = true;
+    } else if (!opened) {
+      break;
+    } else if (type == kRecordDone && value < total_chunks_) {
+      apply_done(value);
+    } else if (type == kRecordFound && !found_) {
+      found_ = Found{value, std::string(reinterpret_cast<const char*>(rec + kRecordHeader), len)};
+    }
+    ++journal_records_;
+    off += size;
+  }
+
+  if (!opened) {
+    reset_journal();
+    return;
+  }
+  // Drop a torn tail so that new records start on a clean boundary.
+  if (off != data.size() && ::ftruncate(journal_fd_, static_cast<off_t>(off)) != 0)
+    throw_errno("truncate " + dir_ + "/journal");
+  if (::lseek(journal_fd_, 0, SEEK_END) < 0) throw_errno("seek " + dir_ + "/journal");
+}
+
+void Checkpoint::apply_done(std::uint64_t chunk) {
+  std::uint64_t& word = bitmap_[chunk / 64];
+  const std::uint64_t bit = std::uint64_t{1} << (chunk % 64);
+  if (word & bit) return;
+  word |= bit;
+  ++done_count_;
+}
+
+void Checkpoint::append(std::uint16_t type, std::uint64_t value, std::string_view payload) {
+  if (payload.size() > kMaxCandidate)
+    throw std::invalid_argument("journal record payload of " + std::to_string(payload.size()) + " bytes");
+  std::uint8_t rec[kRecordHeader + kMaxCandidate] = {};
+  const std::size_t len = payload.size();
+  store_le32(rec, static_cast<std::uint32_t>(type) | static_cast<std::uint32_t>(len) << 16);
+  store_le64(rec + 8, value);
+  if (len) std::memcpy(rec + kRecordHeader, payload.data(), len);
+  store_le32(rec + 4, crc32(ByteSpan(rec, kRecordHeader + len)));
+
+  const std::size_t size = kRecordHeader + record_padded(len);
+  for (std::size_t done = 0; done < size;) {
+    const ssize_t n = ::write(journal_fd_, rec + done, size - done);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      throw_errno("write " + dir_ + "/journal");
+    }
+    done += static_cast<std::size_t>(n);
+  }
+  bytes_written_ += size;
+  ++journal_records_;
+  journal_dirty_ = true;
+}
+
+void Checkpoint::reset_journal() {
+  if (::ftruncate(journal_fd_, 0) != 0) throw_errno("truncate " + dir_ + "/journal");
+  if (::lseek(journal_fd_, 0, SEEK_SET) < 0) throw_errno("seek " + dir_ + "/journal");
+  journal_records_ = 0;
+  std::uint8_t total[8];
+  store_le64(total, total_chunks_);
+  append(kRecordOpen, job_id_, std::string_view(reinterpret_cast<const char*>(total), sizeof(total)));
+  sync();
+}
+
+void Checkpoint::mark_done(std::uint64_t chunk) {
+  if (chunk >= total_chunks_ || is_done(chunk)) return;
+  append(kRecordDone, chunk, {});
+  apply_done(chunk);
+}
+
+void Checkpoint::record_found(std::uint64_t index, std::string_view candidate) {
+  if (found_) return;
+  append(kRecordFound, index, candidate);
+  found_ = Found{index, std::string(candidate)};
+  sync();
+}
+
+void Checkpoint::sync() {
+  if (!journal_dirty_) return;
+  if (::fdatasync(journal_fd_) != 0) throw_errno("fdatasync " + dir_ + "/journal");
+  journal_dirty_ = false;
+}
+
+void Checkpoint::compact() {
+  const std::string path = dir_ + "/snapshot";
+  const std::string tmp = path + ".tmp";
+  {
+    const std::uint32_t found_len = found_ ? static_cast<std::uint32_t>(found_->candidate.size()) : 0;
+    std::vector<std::uint8_t> image(kSnapshotHeader + padded(found_len) + bitmap_.size() * 8 + 4, 0);
+    std::memcpy(image.data(), kSnapshotMagic, 8);
+    store_le64(image.data() + 8, job_id_);
+    store_le64(image.data() + 16, total_chunks_);
+    store_le64(image.data() + 24, found_ ? found_->index : kNotFound);
+    store_le32(image.data() + 32, found_len);
+    if (found_) std::memcpy(image.data() + kSnapshotHeader, found_->candidate.data(), found_len);
+    std::uint8_t* bits = image.data() + kSnapshotHeader + padded(found_len);
+    for (std::size_t i = 0; i < bitmap_.size(); ++i) store_le64(bits + 8 * i, bitmap_[i]);
+    store_le32(image.data() + image.size() - 4, crc32(ByteSpan(image.data(), image.size() - 4)));
+
+    io::FdWriter out = io::FdWriter::open(tmp);
+    out.write(ByteSpan(image));
+    out.sync();
+    out.close();
+    bytes_written_ += image.size();
+  }
+  if (::rename(tmp.c_str(), path.c_str()) != 0) throw_errno("rename " + tmp);
+  fsync_dir(dir_);
+  reset_journal();
+}
+
+}  // namespace etheros::crack
@@ -0,0 +1,89 @@
+#pragma once
+
+// Durable progress of one cracking job: which chunks are finished and, once it
+// happens, the recovered key.
+//
+// State lives in two files under the job's directory:
+//   snapshot  whole-state image (header, result, done-bitmap, CRC), replaced
+//             atomically via rename; rewritten only on compaction
+//   journal   append-only 16-byte records, one per finished chunk, each with
+//             its own CRC, made durable in batches by sync()
+//
+// Records are padded to 16 bytes and written with a single write(), so they
+// start on 16-byte boundaries and the per-chunk records (exactly 16 bytes)
+// never straddle a sector. Longer records (the header and a found key) may;
+// like any torn tail after power loss, a torn one fails its CRC and is cut
+// off on open. Replaying is idempotent, so a crash between writing a snapshot
+// and truncating the journal is harmless. Resuming costs one read of each
+// file.
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace etheros::crack {
+
+class Checkpoint {
+ public:
+  struct Found {
+    std::uint64_t index = 0;
+    std::string candidate;
+  };
+
+  // Longest key a journal record can hold; WPA passphrases are at most 63.
+  static constexpr std::size_t kMaxCandidate = 256;
+
+  // Opens or creates the state in dir (which must exist). Throws
+  // std::runtime_error if dir holds another job and std::system_error on I/O
+  // failure.
+  Checkpoint(const std::string& dir, std::uint64_t job_id, std::uint64_t total_chunks);
+  ~Checkpoint();
+
+  Checkpoint(const Checkpoint&) = delete;
+  Checkpoint& operator=(const Checkpoint&) = delete;
+
+  std::uint64_t total_chunks() const { return total_chunks_; }
+  std::uint64_t done_count() const { return done_count_; }
+  bool is_done(std::uint64_t chunk) const { return (bitmap_[chunk / 64] >> (chunk % 64)) & 1; }
+  const std::optional<Found>& found() const { return found_; }
+
+  // Appends a record; durable after the next sync(). Already-done chunks are
+  // ignored without writing.
+  void mark_done(std::uint64_t chunk);
+  // Records the key and syncs immediately; it is the one result that must
+  // never be lost. Throws std::invalid_argument if the candidate is longer
+  // than kMaxCandidate.
+  void record_found(std::uint64_t index, std::string_view candidate);
+
+  // fdatasync()s the journal if anything was appended since the last call.
+  void sync();
+  // Writes a fresh snapshot and empties the journal.
+  void compact();
+
+  std::uint64_t journal_records() const { return journal_records_; }
+  std::uint64_t bytes_written() const { return bytes_written_; }
+
+ private:
+  void load_snapshot();
+  void replay_journal();
+  void append(std::uint16_t type, std::uint64_t value, std::string_view payload);
+  void reset_journal();
+  void apply_done(std::uint64_t chunk);
+
+  std::string dir_;
+  std::uint64_t job_id_;
+  std::uint64_t total_chunks_;
+  std::vector<std::uint64_t> bitmap_;
+  std::uint64_t done_count_ = 0;
+  std::optional<Found> found_;
+
+  int journal_fd_ = -1;
+  bool journal_dirty_ = false;
+  std::uint64_t journal_records_ = 0;
+  std::uint64_t bytes_written_ = 0;
+};
+
+}  // namespace etheros::crack
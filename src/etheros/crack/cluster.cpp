@@ -0,0 +1,433 @@
+#include "etheros/crack/cluster.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "etheros/common/hex.hpp"
+
+namespace etheros::crack {
+
+namespace {
+
+constexpr std::size_t kMaxLine = 4096;
+constexpr auto kReplyTimeout = std::chrono::seconds(30);
+// Reconnects tried for a job already known to be finished (about 1.5 s of
+// back-off): the coordinator has most likely exited for good.
+constexpr int kFinishedReconnects = 5;
+
+[[noreturn]] void throw_errno(const std::string& what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+bool parse_u64(std::string_view s, std::uint64_t& out) {
+  const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+  return ec == std::errc() && end == s.data() + s.size() && !s.empty();
+}
+
+// Splits "VERB rest" at the first space.
+std::pair<std::string_view, std::string_view> split_word(std::string_view line) {
+  const std::size_t space = line.find(' ');
+  if (space == std::string_view::npos) return {line, {}};
+  return {line.substr(0, space), line.substr(space + 1)};
+}
+
+bool send_all(int fd, std::string_view data) {
+  while (!data.empty()) {
+    const ssize_t n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data.remove_prefix(static_cast<std::size_t>(n));
+  }
+  return true;
+}
+
+void set_nodelay(int fd) {
+  const int one = 1;
+  ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+// "host:port" or "port"; host defaults to fallback_host.
+std::pair<std::string, std::string> split_address(const std::string& address, const char* fallback_host) {
+  const std::size_t colon = address.rfind(':');
+  if (colon == std::string::npos) return {fallback_host, address};
+  return {address.substr(0, colon), address.substr(colon + 1)};
+}
+
+// Compares without an early exit, so response timing does not leak how much
+// of a guessed token was right.
+bool same_token(std::string_view a, std::string_view b) {
+  unsigned diff = a.size() != b.size();
+  for (std::size_t i = 0; i < a.size() && i < b.size(); ++i) diff |= static_cast<unsigned char>(a[i] ^ b[i]);
+  return diff == 0;
+}
+
+// Sleeps for the back-off before reconnect attempt number `attempt`: 100 ms
+// more each time, up to 5 s.
+void back_off(int attempt, const std::atomic<bool>& stop) {
+  for (int i = 0; i < std::min(attempt + 1, 50) && !stop.load(); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+}
+
+JobSpec parse_job_line(std::string_view line) {
+  auto [verb, rest] = split_word(line);
+  auto [chunk, rest2] = split_word(rest);
+  auto [target, keyspace] = split_word(rest2);
+  JobSpec spec;
+  if (verb != "JOB" || !parse_u64(chunk, spec.chunk_size) || spec.chunk_size == 0 || target.empty() ||
+      keyspace.empty())
+    throw std::runtime_error("coordinator sent a malformed JOB line");
+  spec.target = target;
+  spec.keyspace = keyspace;
+  return spec;
+}
+
+}  // namespace
+
+std::optional<std::uint64_t> LocalWorkSource::lease(bool& finished) {
+  const std::optional<std::uint64_t> chunk = jobs_.lease();
+  finished = !chunk && jobs_.finished();
+  return chunk;
+}
+
+RemoteWorkSource::RemoteWorkSource(std::string address, Options options, const std::atomic<bool>& stop)
+    : address_(std::move(address)), options_(std::move(options)), stop_(stop) {
+  if (options_.name.empty() || options_.name.find_first_of(" \t\r\n") != std::string::npos)
+    throw std::invalid_argument("worker name must be non-empty and without spaces");
+  std::lock_guard lock(mutex_);
+  const auto give_up = std::chrono::steady_clock::now() + options_.connect_timeout;
+  for (int attempt = 0; !connect_and_hello(); ++attempt) {
+    back_off(attempt, stop_);
+    if (stop_.load()) throw std::runtime_error("stopped before reaching coordinator " + address_);
+    if (options_.connect_timeout.count() > 0 && std::chrono::steady_clock::now() > give_up)
+      throw std::runtime_error("no coordinator at " + address_ + " after " +
+                               std::to_string(options_.connect_timeout.count()) + " s");
+  }
+  spec_ = parse_job_line(job_line_);
+}
+
+RemoteWorkSource::~RemoteWorkSource() { disconnect(); }
+
+void RemoteWorkSource::disconnect() {
+  if (fd_ >= 0) ::close(fd_);
+  fd_ = -1;
+  input_.clear();
+}
+
+bool RemoteWorkSource::connect_and_hello() {
+  const auto [host, port] = split_address(address_, "127.0.0.1");
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* found = nullptr;
+  if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0) return false;
+  for (addrinfo* ai = found; ai && fd_ < 0; ai = ai->ai_next) {
+    fd_ = ::socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+    if (fd_ >= 0 && ::connect(fd_, ai->ai_addr, ai->ai_addrlen) != 0) disconnect();
+  }
+  ::freeaddrinfo(found);
+  if (fd_ < 0) return false;
+  set_nodelay(fd_);
+  // Short receive timeout so a blocked reply still notices stop_.
+  const timeval tv{1, 0};
+  ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  std::string hello = "HELLO " + options_.name;
+  if (!options_.token.empty()) hello += " " + options_.token;
+  if (!send_all(fd_, hello + "\n")) {
+    disconnect();
+    return false;
+  }
+  const auto deadline = std::chrono::steady_clock::now() + kReplyTimeout;
+  for (;;) {
+    const std::size_t nl = input_.find('\n');
+    if (nl != std::string::npos) {
+      std::string line = input_.substr(0, nl);
+      input_.erase(0, nl + 1);
+      // Retrying cannot fix a refusal (a wrong token), so give up loudly.
+      if (line.rfind("ERR", 0) == 0) {
+        disconnect();
+        throw std::runtime_error("coordinator " + address_ + " refused " + options_.name + ": " + line);
+      }
+      if (!job_line_.empty() && line != job_line_) job_changed_ = true;
+      if (job_line_.empty()) job_line_ = std::move(line);
+      return true;
+    }
+    char buf[1024];
+    const ssize_t n = ::recv(fd_, buf, sizeof(buf), 0);
+    if (n > 0) {
+      input_.append(buf, static_cast<std::size_t>(n));
+    } else if (n == 0 || (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) || stop_.load() ||
+               std::chrono::steady_clock::now() > deadline || input_.size() > kMaxLine) {
+      disconnect();
+      return false;
+    }
+  }
+}
+
+std::optional<std::string> RemoteWorkSource::request(const std::string& line) {
+  std::lock_guard lock(mutex_);
+  for (int attempt = 0; !stop_.load() && !job_changed_; ++attempt) {
+    if (fd_ < 0 && !connect_and_hello()) {
+      // A coordinator that is away while the job still runs is probably
+      // rebooting, so keep trying; once the job is over it is not coming
+      // back for us.
+      if (finished_ && attempt >= kFinishedReconnects) break;
+      back_off(attempt, stop_);
+      continue;
+    }
+    if (job_changed_) break;
+    if (!send_all(fd_, line + "\n")) {
+      disconnect();
+      continue;
+    }
+    const auto deadline = std::chrono::steady_clock::now() + kReplyTimeout;
+    for (;;) {
+      const std::size_t nl = input_.find('\n');
+      if (nl != std::string::npos) {
+        std::string reply = input_.substr(0, nl);
+        input_.erase(0, nl + 1);
+        return reply;
+      }
+      char buf[256];
+      const ssize_t n = ::recv(fd_, buf, sizeof(buf), 0);
+      if (n > 0) {
+        input_.append(buf, static_cast<std::size_t>(n));
+        continue;
+      }
+      if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) && !stop_.load() &&
+          std::chrono::steady_clock::now() < deadline)
+        continue;
+      disconnect();
+      break;
+    }
+  }
+  return std::nullopt;
+}
+
+bool RemoteWorkSource::finished_reply(const std::optional<std::string>& reply) {
+  if (reply && *reply != "FINISHED") return false;
+  if (reply) finished_ = true;
+  return true;
+}
+
+std::optional<std::uint64_t> RemoteWorkSource::lease(bool& finished) {
+  const std::optional<std::string> reply = request("LEASE");
+  finished = finished_reply(reply);
+  if (finished) return std::nullopt;
+  const auto [verb, arg] = split_word(*reply);
+  std::uint64_t chunk = 0;
+  if (verb == "CHUNK" && parse_u64(arg, chunk)) return chunk;
+  if (verb != "WAIT") throw std::runtime_error("coordinator: unexpected reply '" + *reply + "'");
+  return std::nullopt;
+}
+
+bool RemoteWorkSource::renew(std::uint64_t chunk) {
+  return !finished_reply(request("RENEW " + std::to_string(chunk)));
+}
+
+bool RemoteWorkSource::complete(std::uint64_t chunk) {
+  return !finished_reply(request("DONE " + std::to_string(chunk)));
+}
+
+void RemoteWorkSource::found(std::uint64_t index, std::string_view candidate) {
+  std::string line = "FOUND " + std::to_string(index) + " ";
+  append_hex(line, candidate);
+  request(line);
+}
+
+Coordinator::Coordinator(JobManager& jobs, const std::string& listen, std::string token)
+    : jobs_(jobs), token_(std::move(token)) {
+  const JobSpec& spec = jobs_.spec();
+  job_line_ = "JOB " + std::to_string(spec.chunk_size) + " " + spec.target + " " + spec.keyspace;
+  if (token_.find_first_of(" \t\r\n") != std::string::npos)
+    throw std::invalid_argument("cluster token must not contain whitespace");
+
+  const auto [host, port] = split_address(listen, "127.0.0.1");
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  std::uint64_t port_number = 0;
+  if (!parse_u64(port, port_number) || port_number > 65535 || ::inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1)
+    throw std::invalid_argument("listen address must be [ipv4:]port, got '" + listen + "'");
+  addr.sin_port = htons(static_cast<std::uint16_t>(port_number));
+  // Anyone who can connect can report chunks done, so only loopback is open.
+  if (token_.empty() && (ntohl(addr.sin_addr.s_addr) >> 24) != 127)
+    throw std::invalid_argument("listening on " + host + " needs a cluster token");
+
+  listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listen_fd_ < 0) throw_errno("socket");
+  const int one = 1;
+  ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  socklen_t len = sizeof(addr);
+  if (::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      ::listen(listen_fd_, 16) != 0 || ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+    const int saved = errno;
+    ::close(listen_fd_);
+    throw std::system_error(saved, std::generic_category(), "listen " + listen);
+  }
+  port_ = ntohs(addr.sin_port);
+}
+
+Coordinator::~Coordinator() {
+  for (const Connection& conn : connections_) ::close(conn.fd);
+  if (listen_fd_ >= 0) ::close(listen_fd_);
+}
+
+void Coordinator::poll(int timeout_ms) {
+  std::vector<pollfd> fds;
+  fds.reserve(connections_.size() + 1);
+  fds.push_back({listen_fd_, POLLIN, 0});
+  for (const Connection& conn : connections_) fds.push_back({conn.fd, POLLIN, 0});
+
+  if (::poll(fds.data(), fds.size(), timeout_ms) <= 0) return;
+
+  // Serve existing connections first; indices shift once new ones arrive.
+  std::vector<Connection> kept;
+  kept.reserve(connections_.size());
+  for (std::size_t i = 0; i < connections_.size(); ++i) {
+    Connection& conn = connections_[i];
+    if (fds[i + 1].revents == 0 || serve(conn))
+      kept.push_back(std::move(conn));
+    else
+      ::close(conn.fd);
+  }
+  connections_ = std::move(kept);
+
+  if (fds[0].revents & POLLIN) {
+    for (;;) {
+      const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (fd < 0) break;
+      set_nodelay(fd);
+      connections_.push_back({fd, {}, {}});
+    }
+  }
+}
+
+bool Coordinator::serve(Connection& conn) {
+  for (;;) {
+    char buf[1024];
+    const ssize_t n = ::recv(conn.fd, buf, sizeof(buf), 0);
+    if (n > 0) {
+      conn.input.append(buf, static_cast<std::size_t>(n));
+      continue;
+    }
+    if (n == 0) return false;
+    if (errno == EINTR) continue;
+    if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+    return false;
+  }
+
+  std::size_t start = 0;
+  for (std::size_t nl; (nl = conn.input.find('\n', start)) != std::string::npos; start = nl + 1) {
+    std::string_view line(conn.input.data() + start, nl - start);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    // Replies are a few dozen bytes and workers wait for each one, so a send
+    // that would block means the peer is broken.
+    if (!send_all(conn.fd, handle(conn, line) + "\n") || conn.refused) return false;
+  }
+  conn.input.erase(0, start);
+  return conn.input.size() <= kMaxLine;
+}
+
+std::string Coordinator::handle(Connection& conn, std::string_view line) {
+  const auto [verb, arg] = split_word(line);
+  if (verb == "HELLO") {
+    const auto [name, token] = split_word(arg);
+    if (!same_token(token, token_)) {
+      conn.refused = true;
+      return "ERR bad token";
+    }
+    conn.name = name.empty() ? "anonymous" : std::string(name);
+    return job_line_;
+  }
+  if (conn.name.empty()) return "ERR HELLO first";
+
+  std::uint64_t n = 0;
+  if (verb == "LEASE") {
+    if (const std::optional<std::uint64_t> chunk = jobs_.lease()) return "CHUNK " + std::to_string(*chunk);
+    return jobs_.finished() ? "FINISHED" : "WAIT";
+  }
+  if ((verb == "RENEW" || verb == "DONE") && parse_u64(arg, n) && n < jobs_.total_chunks()) {
+    const bool running = verb == "RENEW" ? jobs_.renew(n) : jobs_.complete(n);
+    return running ? "OK" : "FINISHED";
+  }
+  if (verb == "FOUND") {
+    const auto [index, hex] = split_word(arg);
+    std::string candidate;
+    // Same bounds as crack_worker: a WPA passphrase is 8 to 63 bytes.
+    if (!parse_u64(index, n) || !decode_hex(hex, candidate) || candidate.size() < 8 || candidate.size() > 63)
+      return "ERR malformed FOUND";
+    // The index is logged and persisted as the key's position; it must name
+    // a candidate of this job.
+    if (n >= jobs_.keyspace_size()) return "ERR index out of range";
+    // Cheap next to the search itself, and keeps a faulty board from ending
+    // the job with a wrong key.
+    if (!PmkidTarget::parse(jobs_.spec().target).matches_passphrase(candidate)) return "ERR candidate does not match";
+    jobs_.found(n, candidate);
+    return "OK";
+  }
+  return "ERR unknown request";
+}
+
+void crack_worker(WorkSource& source, const Keyspace& keyspace, const PmkidTarget& target,
+                  std::uint64_t chunk_size, const std::atomic<bool>& stop, std::atomic<std::uint64_t>& tested) {
+  using Clock = std::chrono::steady_clock;
+  while (!stop.load(std::memory_order_relaxed)) {
+    bool finished = false;
+    const std::optional<std::uint64_t> chunk = source.lease(finished);
+    if (!chunk) {
+      if (finished) return;
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      continue;
+    }
+
+    std::optional<std::pair<std::uint64_t, std::string>> hit;
+    bool aborted = false;
+    const Clock::duration renew_interval = source.renew_interval();
+    Clock::time_point last_renew = Clock::now();
+    keyspace.enumerate(*chunk * chunk_size, chunk_size, [&](std::uint64_t index, std::string_view candidate) {
+      if (candidate.size() >= 8 && candidate.size() <= 63 && target.matches_passphrase(candidate))
+        hit.emplace(index, candidate);
+      tested.fetch_add(1, std::memory_order_relaxed);
+      if (hit) return false;
+      if (stop.load(std::memory_order_relaxed)) {
+        aborted = true;
+        return false;
+      }
+      if (Clock::now() - last_renew >= renew_interval) {
+        // Finished elsewhere (the key was found): drop the rest of the chunk.
+        if (!source.renew(*chunk)) {
+          aborted = true;
+          return false;
+        }
+        last_renew = Clock::now();
+      }
+      return true;
+    });
+
+    if (hit) {
+      source.found(hit->first, hit->second);
+      return;
+    }
+    // An abandoned chunk is simply leased again after restart or expiry.
+    if (aborted || !source.complete(*chunk)) return;
+  }
+}
+
+}  // namespace etheros::crack
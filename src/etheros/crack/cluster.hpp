@@ -0,0 +1,165 @@
+#pragma once
+
+// Spreading one job across boards on a local network. The coordinator owns the
+// JobManager and its checkpoint; workers are stateless and write nothing to
+// flash. The protocol is line-based over TCP, one request and one reply at a
+// time:
+//
+//   worker                          coordinator
+//   HELLO <name> [<token>]          JOB <chunk size> <target> <keyspace spec>
+//   LEASE                           CHUNK <n> | WAIT | FINISHED
+//   RENEW <n>                       OK | FINISHED
+//   DONE <n>                        OK | FINISHED
+//   FOUND <index> <candidate hex>   OK
+//   (anything else)                 ERR <reason>
+//
+// A worker that loses its coordinator reconnects and replays the request it
+// was making, so results are delivered at least once; the JobManager makes
+// repeats harmless. FINISHED tells a busy worker to drop its chunk; the
+// coordinator keeps answering until every lease is returned or has expired.
+//
+// The protocol is not encrypted. A coordinator listening beyond loopback
+// requires a shared token in HELLO, so that other hosts on the LAN cannot
+// report chunks done and empty the job.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "etheros/crack/job_manager.hpp"
+#include "etheros/crack/keyspace.hpp"
+#include "etheros/crack/pmkid.hpp"
+
+namespace etheros::crack {
+
+inline constexpr std::uint16_t kDefaultClusterPort = 7390;
+
+// Where a cracking thread gets its chunks.
+class WorkSource {
+ public:
+  virtual ~WorkSource() = default;
+
+  // nullopt with finished set means stop; without it, retry shortly.
+  virtual std::optional<std::uint64_t> lease(bool& finished) = 0;
+  // Both return false once the job is finished; the caller then stops.
+  virtual bool renew(std::uint64_t chunk) = 0;
+  virtual bool complete(std::uint64_t chunk) = 0;
+  virtual void found(std::uint64_t index, std::string_view candidate) = 0;
+  // How often a busy thread renews its lease, which also bounds how long it
+  // keeps testing after the job finished elsewhere.
+  virtual std::chrono::seconds renew_interval() const { return std::chrono::seconds(60); }
+};
+
+class LocalWorkSource final : public WorkSource {
+ public:
+  explicit LocalWorkSource(JobManager& jobs) : jobs_(jobs) {}
+
+  std::optional<std::uint64_t> lease(bool& finished) override;
+  bool renew(std::uint64_t chunk) override { return jobs_.renew(chunk); }
+  bool complete(std::uint64_t chunk) override { return jobs_.complete(chunk); }
+  void found(std::uint64_t index, std::string_view candidate) override { jobs_.found(index, candidate); }
+  // Renewing locally is just a lock, so notice a finished job quickly.
+  std::chrono::seconds renew_interval() const override { return std::chrono::seconds(1); }
+
+ private:
+  JobManager& jobs_;
+};
+
+class RemoteWorkSource final : public WorkSource {
+ public:
+  struct Options {
+    std::string name;   // no spaces
+    std::string token;  // must match the coordinator's, if it has one
+    // How long to wait for a coordinator to appear; zero waits forever.
+    std::chrono::seconds connect_timeout{300};
+  };
+
+  // Connects to "host:port" and fetches the job; keeps retrying until it
+  // succeeds, connect_timeout passes or stop is set (then throws
+  // std::runtime_error). Later disconnects are retried the same way, but
+  // only briefly once the job is known to be finished. A refused HELLO
+  // (e.g. a wrong token) throws std::runtime_error.
+  RemoteWorkSource(std::string address, Options options, const std::atomic<bool>& stop);
+  ~RemoteWorkSource() override;
+
+  const JobSpec& spec() const { return spec_; }
+  // True once the coordinator came back with a different job; the current
+  // one is then reported finished and the caller should start over.
+  bool job_changed() const { return job_changed_; }
+
+  std::optional<std::uint64_t> lease(bool& finished) override;
+  bool renew(std::uint64_t chunk) override;
+  bool complete(std::uint64_t chunk) override;
+  void found(std::uint64_t index, std::string_view candidate) override;
+
+ private:
+  // Returns the reply, or nullopt once stop is set or the coordinator of a
+  // finished job stays away.
+  std::optional<std::string> request(const std::string& line);
+  // True if the reply means the job is over; remembers it.
+  bool finished_reply(const std::optional<std::string>& reply);
+  bool connect_and_hello();
+  void disconnect();
+
+  std::string address_;
+  Options options_;
+  const std::atomic<bool>& stop_;
+  std::mutex mutex_;
+  int fd_ = -1;
+  std::string input_;
+  std::string job_line_;
+  JobSpec spec_;
+  std::atomic<bool> job_changed_{false};
+  std::atomic<bool> finished_{false};
+};
+
+// Serves a JobManager to remote workers. Single-threaded; drive it with
+// poll() from the coordinator's main loop.
+class Coordinator {
+ public:
+  // listen is "[host:]port"; host defaults to 127.0.0.1. Workers must send
+  // token in HELLO when it is not empty. Throws std::invalid_argument for a
+  // bad address, or for a non-loopback address without a token, and
+  // std::system_error if the socket cannot be set up.
+  Coordinator(JobManager& jobs, const std::string& listen, std::string token = {});
+  ~Coordinator();
+
+  Coordinator(const Coordinator&) = delete;
+  Coordinator& operator=(const Coordinator&) = delete;
+
+  // Accepts and answers requests for up to timeout_ms.
+  void poll(int timeout_ms);
+  std::size_t workers() const { return connections_.size(); }
+  std::uint16_t port() const { return port_; }
+
+ private:
+  struct Connection {
+    int fd;
+    std::string input;
+    std::string name;
+    bool refused = false;
+  };
+
+  bool serve(Connection& conn);
+  std::string handle(Connection& conn, std::string_view line);
+
+  JobManager& jobs_;
+  std::string job_line_;
+  std::string token_;
+  int listen_fd_ = -1;
+  std::uint16_t port_ = 0;
+  std::vector<Connection> connections_;
+};
+
+// Tests chunks from source until it reports the job finished or stop is set.
+// Candidates that cannot be WPA passphrases (outside 8..63 bytes) are skipped
+// but still count as tested.
+void crack_worker(WorkSource& source, const Keyspace& keyspace, const PmkidTarget& target,
+                  std::uint64_t chunk_size, const std::atomic<bool>& stop, std::atomic<std::uint64_t>& tested);
+
+}  // namespace etheros::crack
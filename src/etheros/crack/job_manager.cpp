@@ -0,0 +1,149 @@
+#include "etheros/crack/job_manager.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#include "etheros/crack/sha1.hpp"
+
+namespace etheros::crack {
+
+std::uint64_t JobSpec::job_id() const {
+  Sha1 h;
+  const std::string chunk = std::to_string(chunk_size);
+  for (std::string_view field : {std::string_view(target), std::string_view(keyspace), std::string_view(chunk)}) {
+    h.update(ByteSpan(reinterpret_cast<const std::uint8_t*>(field.data()), field.size()));
+    const std::uint8_t separator = '\n';
+    h.update(ByteSpan(&separator, 1));
+  }
+  const Sha1Digest digest = h.final();
+  std::uint64_t id = 0;
+  for (int i = 0; i < 8; ++i) id = id << 8 | digest[static_cast<std::size_t>(i)];
+  return id;
+}
+
+std::uint64_t JobManager::chunk_count(std::uint64_t keyspace_size, std::uint64_t chunk_size) {
+  if (chunk_size == 0) throw std::invalid_argument("chunk size must be positive");
+  // Rounded up without keyspace_size + chunk_size - 1, which can wrap.
+  const std::uint64_t chunks = keyspace_size / chunk_size + (keyspace_size % chunk_size != 0);
+  if (chunks > kMaxChunks)
+    throw std::invalid_argument("keyspace of " + std::to_string(keyspace_size) + " candidates needs " +
+                                std::to_string(chunks) + " chunks of " + std::to_string(chunk_size) + "; the limit is " +
+                                std::to_string(kMaxChunks) + " (raise --chunk or split the job)");
+  return chunks;
+}
+
+JobManager::JobManager(const JobSpec& spec, std::uint64_t keyspace_size, const std::string& state_dir,
+                       Options options)
+    : spec_(spec),
+      options_(options),
+      keyspace_size_(keyspace_size),
+      total_chunks_(chunk_count(keyspace_size, spec.chunk_size)),
+      checkpoint_(state_dir, spec.job_id(), total_chunks_) {}
+
+std::optional<std::uint64_t> JobManager::lease() {
+  std::lock_guard lock(mutex_);
+  if (checkpoint_.found()) return std::nullopt;
+  const Clock::time_point deadline = Clock::now() + options_.lease_timeout;
+
+  while (!requeued_.empty()) {
+    const std::uint64_t chunk = requeued_.front();
+    requeued_.pop_front();
+    if (!checkpoint_.is_done(chunk) && !leases_.contains(chunk)) {
+      leases_.emplace(chunk, deadline);
+      return chunk;
+    }
+  }
+  while (cursor_ < total_chunks_) {
+    const std::uint64_t chunk = cursor_++;
+    if (!checkpoint_.is_done(chunk)) {
+      leases_.emplace(chunk, deadline);
+      return chunk;
+    }
+  }
+  return std::nullopt;
+}
+
+bool JobManager::renew(std::uint64_t chunk) {
+  std::lock_guard lock(mutex_);
+  const auto it = leases_.find(chunk);
+  if (finished_locked()) {
+    if (it != leases_.end()) leases_.erase(it);
+    return false;
+  }
+  if (it != leases_.end()) it->second = Clock::now() + options_.lease_timeout;
+  return true;
+}
+
+bool JobManager::complete(std::uint64_t chunk) {
+  std::lock_guard lock(mutex_);
+  leases_.erase(chunk);
+  checkpoint_.mark_done(chunk);
+  return !finished_locked();
+}
+
+void JobManager::found(std::uint64_t index, std::string_view candidate) {
+  std::lock_guard lock(mutex_);
+  // The finder stops without reporting its chunk done; return its lease.
+  leases_.erase(index / spec_.chunk_size);
+  checkpoint_.record_found(index, candidate);
+}
+
+bool JobManager::finished() const {
+  std::lock_guard lock(mutex_);
+  return finished_locked();
+}
+
+bool JobManager::finished_locked() const {
+  return checkpoint_.found() || checkpoint_.done_count() == total_chunks_;
+}
+
+std::optional<Checkpoint::Found> JobManager::result() const {
+  std::lock_guard lock(mutex_);
+  return checkpoint_.found();
+}
+
+std::uint64_t JobManager::chunk_candidates(std::uint64_t chunk) const {
+  const std::uint64_t first = chunk * spec_.chunk_size;
+  return keyspace_size_ - first < spec_.chunk_size ? keyspace_size_ - first : spec_.chunk_size;
+}
+
+JobProgress JobManager::progress() const {
+  std::lock_guard lock(mutex_);
+  JobProgress p;
+  p.done_chunks = checkpoint_.done_count();
+  p.total_chunks = total_chunks_;
+  p.total_candidates = keyspace_size_;
+  p.done_candidates = p.done_chunks * spec_.chunk_size;
+  // Only the last chunk can be short.
+  if (total_chunks_ > 0 && checkpoint_.is_done(total_chunks_ - 1))
+    p.done_candidates -= spec_.chunk_size - chunk_candidates(total_chunks_ - 1);
+  p.leased = leases_.size();
+  return p;
+}
+
+void JobManager::tick() {
+  std::lock_guard lock(mutex_);
+  const Clock::time_point now = Clock::now();
+  for (auto it = leases_.begin(); it != leases_.end();) {
+    if (it->second <= now) {
+      requeued_.push_back(it->first);
+      it = leases_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  if (now - last_sync_ >= options_.sync_interval) {
+    if (checkpoint_.journal_records() >= options_.compact_after)
+      checkpoint_.compact();
+    else
+      checkpoint_.sync();
+    last_sync_ = now;
+  }
+}
+
+void JobManager::close() {
+  std::lock_guard lock(mutex_);
+  checkpoint_.compact();
+}
+
+}  // namespace etheros::crack
@@ -0,0 +1,109 @@
+#pragma once
+
+// Chunk scheduler for one cracking job. The keyspace is cut into fixed-size
+// chunks; workers (local threads or remote boards) lease a chunk, test it and
+// report it done. Leases expire so that a board which vanishes mid-chunk only
+// costs that chunk. Progress is persisted through Checkpoint with
+// group-committed syncs, so restarting resumes where the last sync left off.
+//
+// All methods are thread-safe.
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "etheros/crack/checkpoint.hpp"
+
+namespace etheros::crack {
+
+// Everything a node needs to regenerate the same work: the target line, the
+// keyspace spec and the chunk size. Nodes agree on a job by its id.
+struct JobSpec {
+  std::string target;
+  std::string keyspace;
+  std::uint64_t chunk_size = 4096;
+
+  std::uint64_t job_id() const;
+};
+
+struct JobProgress {
+  std::uint64_t done_chunks = 0;
+  std::uint64_t total_chunks = 0;
+  std::uint64_t done_candidates = 0;
+  std::uint64_t total_candidates = 0;
+  std::uint64_t leased = 0;
+};
+
+class JobManager {
+ public:
+  // Largest job accepted: the done-bitmap takes total_chunks / 8 bytes of RAM
+  // (16MiB here), which has to fit next to everything else on a 512MB board.
+  // Bigger keyspaces need a larger chunk size or splitting into several jobs.
+  static constexpr std::uint64_t kMaxChunks = std::uint64_t{1} << 27;
+
+  struct Options {
+    std::chrono::seconds lease_timeout{300};
+    // Longest window of finished chunks a power cut can lose.
+    std::chrono::seconds sync_interval{15};
+    // Journal records before it is folded into the snapshot.
+    std::uint64_t compact_after = 16384;
+  };
+
+  // Opens or resumes the job's state in state_dir. Throws
+  // std::invalid_argument if the job would exceed kMaxChunks, otherwise like
+  // Checkpoint.
+  JobManager(const JobSpec& spec, std::uint64_t keyspace_size, const std::string& state_dir, Options options);
+  JobManager(const JobSpec& spec, std::uint64_t keyspace_size, const std::string& state_dir)
+      : JobManager(spec, keyspace_size, state_dir, Options{}) {}
+
+  const JobSpec& spec() const { return spec_; }
+  std::uint64_t total_chunks() const { return total_chunks_; }
+  std::uint64_t keyspace_size() const { return keyspace_size_; }
+
+  // Returns an unfinished, unleased chunk, or nullopt if none is available
+  // now; finished() tells whether that is permanent.
+  std::optional<std::uint64_t> lease();
+  // Extends a lease; harmless if it already expired. Once the job is finished
+  // it returns the lease instead and returns false, so the worker can stop.
+  bool renew(std::uint64_t chunk);
+  // Idempotent, so a late report for a re-leased chunk is fine. Returns false
+  // once the job is finished.
+  bool complete(std::uint64_t chunk);
+  void found(std::uint64_t index, std::string_view candidate);
+
+  bool finished() const;
+  std::optional<Checkpoint::Found> result() const;
+  JobProgress progress() const;
+
+  // Requeues expired leases and syncs or compacts the checkpoint when due.
+  // Call about once a second.
+  void tick();
+  // Syncs and compacts; call on orderly shutdown.
+  void close();
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  static std::uint64_t chunk_count(std::uint64_t keyspace_size, std::uint64_t chunk_size);
+  std::uint64_t chunk_candidates(std::uint64_t chunk) const;
+  bool finished_locked() const;
+
+  JobSpec spec_;
+  Options options_;
+  std::uint64_t keyspace_size_;
+  std::uint64_t total_chunks_;
+
+  mutable std::mutex mutex_;
+  Checkpoint checkpoint_;
+  std::uint64_t cursor_ = 0;                 // chunks below are done or leased
+  std::deque<std::uint64_t> requeued_;       // expired leases below cursor_
+  std::unordered_map<std::uint64_t, Clock::time_point> leases_;
+  Clock::time_point last_sync_ = Clock::now();
+};
+
+}  // namespace etheros::crack
@@ -0,0 +1,151 @@
+#include "etheros/crack/keyspace.hpp"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "etheros/io/mapped_file.hpp"
+
+namespace etheros::crack {
+
+namespace {
+
+constexpr std::string_view kLower = "abcdefghijklmnopqrstuvwxyz";
+constexpr std::string_view kUpper = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+constexpr std::string_view kDigits = "0123456789";
+constexpr std::string_view kSymbols = " !\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~";
+
+class MaskKeyspace final : public Keyspace {
+ public:
+  explicit MaskKeyspace(std::string_view mask) {
+    for (std::size_t i = 0; i < mask.size(); ++i) {
+      if (mask[i] != '?') {
+        positions_.emplace_back(1, mask[i]);
+        continue;
+      }
+      if (++i == mask.size()) throw std::invalid_argument("mask: trailing '?'");
+      switch (mask[i]) {
+        case 'l':
+          positions_.emplace_back(kLower);
+          break;
+        case 'u':
+          positions_.emplace_back(kUpper);
+          break;
+        case 'd':
+          positions_.emplace_back(kDigits);
+          break;
+        case 's':
+          positions_.emplace_back(kSymbols);
+          break;
+        case 'a':
+          positions_.emplace_back(std::string(kLower) + std::string(kUpper) + std::string(kDigits) +
+                                  std::string(kSymbols));
+          break;
+        case '?':
+          positions_.emplace_back(1, '?');
+          break;
+        default:
+          throw std::invalid_argument(std::string("mask: unknown class ?") + mask[i]);
+      }
+    }
+    if (positions_.empty()) throw std::invalid_argument("mask: empty");
+
+    size_ = 1;
+    for (const std::string& set : positions_) {
+      if (size_ > std::numeric_limits<std::uint64_t>::max() / set.size())
+        throw std::invalid_argument("mask: keyspace exceeds 2^64");
+      size_ *= set.size();
+    }
+  }
+
+  std::uint64_t size() const override { return size_; }
+
+  void enumerate(std::uint64_t first, std::uint64_t count, const Visitor& visit) const override {
+    if (first >= size_) return;
+    const std::size_t n = positions_.size();
+    std::vector<std::size_t> digit(n);
+    std::string candidate(n, '\0');
+
+    // Decode the starting index once (last position varies fastest), then
+    // step like an odometer.
+    std::uint64_t rest = first;
+    for (std::size_t p = n; p-- > 0;) {
+      digit[p] = static_cast<std::size_t>(rest % positions_[p].size());
+      rest /= positions_[p].size();
+      candidate[p] = positions_[p][digit[p]];
+    }
+
+    // first + count can wrap for keyspaces near 2^64.
+    const std::uint64_t end = count > size_ - first ? size_ : first + count;
+    for (std::uint64_t index = first; index < end; ++index) {
+      if (!visit(index, candidate)) return;
+      for (std::size_t p = n; p-- > 0;) {
+        if (++digit[p] < positions_[p].size()) {
+          candidate[p] = positions_[p][digit[p]];
+          break;
+        }
+        digit[p] = 0;
+        candidate[p] = positions_[p][0];
+      }
+    }
+  }
+
+ private:
+  std::vector<std::string> positions_;
+  std::uint64_t size_ = 0;
+};
+
+class WordlistKeyspace final : public Keyspace {
+ public:
+  WordlistKeyspace(const std::string& path, std::uint64_t chunk_size) : file_(path), chunk_size_(chunk_size) {
+    // One pass to count lines and remember where every chunk starts.
+    const ByteSpan bytes = file_.bytes();
+    const char* base = reinterpret_cast<const char*>(bytes.data());
+    std::size_t off = 0;
+    while (off < bytes.size()) {
+      if (lines_ % chunk_size_ == 0) chunk_offsets_.push_back(off);
+      const void* nl = std::memchr(base + off, '\n', bytes.size() - off);
+      off = nl ? static_cast<std::size_t>(static_cast<const char*>(nl) - base) + 1 : bytes.size();
+      ++lines_;
+    }
+  }
+
+  std::uint64_t size() const override { return lines_; }
+
+  void enumerate(std::uint64_t first, std::uint64_t count, const Visitor& visit) const override {
+    if (first >= lines_) return;
+    const ByteSpan bytes = file_.bytes();
+    const char* base = reinterpret_cast<const char*>(bytes.data());
+    const std::uint64_t chunk = first / chunk_size_;
+    std::size_t off = chunk_offsets_[static_cast<std::size_t>(chunk)];
+    const std::uint64_t end = count > lines_ - first ? lines_ : first + count;
+
+    for (std::uint64_t index = chunk * chunk_size_; index < end; ++index) {
+      const void* nl = std::memchr(base + off, '\n', bytes.size() - off);
+      const std::size_t line_end = nl ? static_cast<std::size_t>(static_cast<const char*>(nl) - base) : bytes.size();
+      std::string_view word(base + off, line_end - off);
+      if (!word.empty() && word.back() == '\r') word.remove_suffix(1);
+      off = line_end + 1;
+      if (index >= first && !visit(index, word)) return;
+    }
+  }
+
+ private:
+  io::MappedFile file_;
+  std::uint64_t chunk_size_;
+  std::uint64_t lines_ = 0;
+  std::vector<std::size_t> chunk_offsets_;
+};
+
+}  // namespace
+
+std::unique_ptr<Keyspace> open_keyspace(std::string_view spec, std::uint64_t chunk_size) {
+  if (chunk_size == 0) throw std::invalid_argument("keyspace: chunk size must be positive");
+  if (spec.rfind("mask:", 0) == 0) return std::make_unique<MaskKeyspace>(spec.substr(5));
+  if (spec.rfind("wordlist:", 0) == 0)
+    return std::make_unique<WordlistKeyspace>(std::string(spec.substr(9)), chunk_size);
+  throw std::invalid_argument("keyspace: expected mask:<pattern> or wordlist:<path>");
+}
+
+}  // namespace etheros::crack
@@ -0,0 +1,35 @@
+#pragma once
+
+// Candidate keyspaces addressed by a dense index, so work can be cut into
+// fixed-size chunks that any node can regenerate on its own.
+//
+//   mask:<pattern>   ?l ?u ?d ?s ?a ?? and literals, e.g. mask:lab?d?d?d?d
+//   wordlist:<path>  one candidate per line; the file must be identical on
+//                    every node
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace etheros::crack {
+
+class Keyspace {
+ public:
+  // Return false to stop early.
+  using Visitor = std::function<bool(std::uint64_t index, std::string_view candidate)>;
+
+  virtual ~Keyspace() = default;
+
+  virtual std::uint64_t size() const = 0;
+  // Visits candidates [first, first + count) in index order.
+  virtual void enumerate(std::uint64_t first, std::uint64_t count, const Visitor& visit) const = 0;
+};
+
+// chunk_size lets a wordlist index one file offset per chunk instead of per
+// line. Throws std::invalid_argument for a malformed spec and
+// std::system_error if a wordlist cannot be read.
+std::unique_ptr<Keyspace> open_keyspace(std::string_view spec, std::uint64_t chunk_size);
+
+}  // namespace etheros::crack
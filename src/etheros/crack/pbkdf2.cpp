@@ -0,0 +1,139 @@
+#include "etheros/crack/pbkdf2.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "etheros/crack/sha1.hpp"
+
+namespace etheros::crack {
+
+namespace {
+
+// Keys longer than a block are hashed first; shorter ones are zero-padded.
+void hmac_block_key(ByteSpan key, std::uint8_t (&k)[64]) {
+  std::memset(k, 0, sizeof(k));
+  if (key.size() > 64) {
+    Sha1 h;
+    h.update(key);
+    const Sha1Digest d = h.final();
+    std::memcpy(k, d.data(), d.size());
+  } else if (!key.empty()) {
+    std::memcpy(k, key.data(), key.size());
+  }
+}
+
+struct HmacMidstates {
+  Sha1State inner;
+  Sha1State outer;
+};
+
+HmacMidstates hmac_midstates(ByteSpan key) {
+  std::uint8_t k[64];
+  hmac_block_key(key, k);
+
+  std::uint8_t pad[64];
+  HmacMidstates m{kSha1Init, kSha1Init};
+  for (int i = 0; i < 64; ++i) pad[i] = k[i] ^ 0x36;
+  sha1_compress(m.inner, pad);
+  for (int i = 0; i < 64; ++i) pad[i] = k[i] ^ 0x5c;
+  sha1_compress(m.outer, pad);
+  return m;
+}
+
+// Finishes a hash whose only remaining input is a 20-byte digest, starting from
+// a midstate that has already absorbed one 64-byte block.
+void finish_20(const Sha1State& mid, const std::uint8_t* digest20, Sha1State& out) {
+  std::uint8_t block[64] = {};
+  std::memcpy(block, digest20, 20);
+  block[20] = 0x80;
+  store_be32(block + 60, (64 + 20) * 8);
+  out = mid;
+  sha1_compress(out, block);
+}
+
+void state_to_bytes(const Sha1State& s, std::uint8_t* out) {
+  for (int i = 0; i < 5; ++i) store_be32(out + 4 * i, s[i]);
+}
+
+// Inner hash of the first iteration: SHA1(ipad || salt || INT(block_index)),
+// resumed from the ipad midstate.
+void inner_first(const Sha1State& mid, ByteSpan salt, std::uint32_t block_index, Sha1State& out) {
+  out = mid;
+  ByteSpan rest = salt;
+  for (; rest.size() >= 64; rest = rest.subspan(64)) sha1_compress(out, rest.data());
+
+  std::uint8_t tail[128] = {};
+  std::size_t off = rest.size();
+  std::memcpy(tail, rest.data(), off);
+  store_be32(tail + off, block_index);
+  off += 4;
+  tail[off++] = 0x80;
+  const std::size_t blocks = off + 8 <= 64 ? 1 : 2;
+  const std::uint64_t bits = (64 + salt.size() + 4) * 8;
+  store_be32(tail + blocks * 64 - 8, static_cast<std::uint32_t>(bits >> 32));
+  store_be32(tail + blocks * 64 - 4, static_cast<std::uint32_t>(bits));
+  for (std::size_t b = 0; b < blocks; ++b) sha1_compress(out, tail + 64 * b);
+}
+
+}  // namespace
+
+Sha1Digest hmac_sha1(ByteSpan key, ByteSpan message) {
+  std::uint8_t k[64];
+  hmac_block_key(key, k);
+
+  std::uint8_t pad[64];
+  for (int i = 0; i < 64; ++i) pad[i] = k[i] ^ 0x36;
+  Sha1 inner;
+  inner.update(pad);
+  inner.update(message);
+  const Sha1Digest ih = inner.final();
+
+  for (int i = 0; i < 64; ++i) pad[i] = k[i] ^ 0x5c;
+  Sha1 outer;
+  outer.update(pad);
+  outer.update(ih);
+  return outer.final();
+}
+
+void pbkdf2_hmac_sha1(ByteSpan password, ByteSpan salt, std::uint32_t iterations,
+                      std::span<std::uint8_t> out) {
+  const HmacMidstates m = hmac_midstates(password);
+
+  std::size_t produced = 0;
+  for (std::uint32_t block_index = 1; produced < out.size(); ++block_index) {
+    // U1 = HMAC(P, S || INT(i)); the salt may be any length.
+    Sha1State s;
+    inner_first(m.inner, salt, block_index, s);
+
+    std::uint8_t u[20];
+    Sha1State o;
+    state_to_bytes(s, u);
+    finish_20(m.outer, u, o);
+    state_to_bytes(o, u);
+
+    Sha1State acc = o;
+    for (std::uint32_t it = 1; it < iterations; ++it) {
+      finish_20(m.inner, u, s);
+      state_to_bytes(s, u);
+      finish_20(m.outer, u, o);
+      state_to_bytes(o, u);
+      for (int i = 0; i < 5; ++i) acc[i] ^= o[i];
+    }
+
+    std::uint8_t t[20];
+    state_to_bytes(acc, t);
+    const std::size_t take = std::min<std::size_t>(20, out.size() - produced);
+    std::memcpy(out.data() + produced, t, take);
+    produced += take;
+  }
+}
+
+Pmk wpa_pmk(std::string_view passphrase, std::string_view ssid) {
+  Pmk pmk;
+  pbkdf2_hmac_sha1(ByteSpan(reinterpret_cast<const std::uint8_t*>(passphrase.data()), passphrase.size()),
+                   ByteSpan(reinterpret_cast<const std::uint8_t*>(ssid.data()), ssid.size()),
+                   kWpaIterations, pmk);
+  return pmk;
+}
+
+}  // namespace etheros::crack
@@ -0,0 +1,30 @@
+#pragma once
+
+// HMAC-SHA1, PBKDF2-HMAC-SHA1 and the WPA/WPA2-PSK pairwise master key.
+// The HMAC inner/outer pads are hashed once per password and reused as
+// midstates, so each of the 4096 iterations costs exactly two compressions.
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "etheros/common/bytes.hpp"
+#include "etheros/crack/sha1.hpp"
+
+namespace etheros::crack {
+
+using Pmk = std::array<std::uint8_t, 32>;
+
+inline constexpr std::uint32_t kWpaIterations = 4096;
+
+Sha1Digest hmac_sha1(ByteSpan key, ByteSpan message);
+
+void pbkdf2_hmac_sha1(ByteSpan password, ByteSpan salt, std::uint32_t iterations,
+                      std::span<std::uint8_t> out);
+
+// PMK = PBKDF2(passphrase, ssid, 4096, 256 bits). Passphrases must be 8..63
+// bytes for a real network, but this is not enforced here.
+Pmk wpa_pmk(std::string_view passphrase, std::string_view ssid);
+
+}  // namespace etheros::crack
@@ -0,0 +1,85 @@
+#include "etheros/crack/pmkid.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "etheros/common/hex.hpp"
+
+namespace etheros::crack {
+
+namespace {
+
+std::vector<std::uint8_t> decode_field(std::string_view hex, const char* field) {
+  if (hex.size() % 2 != 0) throw std::invalid_argument(std::string("22000: odd-length ") + field);
+  std::vector<std::uint8_t> out;
+  if (!decode_hex(hex, out)) throw std::invalid_argument(std::string("22000: bad hex in ") + field);
+  return out;
+}
+
+std::array<std::uint8_t, 16> compute_pmkid(const Pmk& pmk, const MacAddress& ap, const MacAddress& station) {
+  std::uint8_t msg[8 + 6 + 6];
+  std::memcpy(msg, "PMK Name", 8);
+  std::memcpy(msg + 8, ap.octets.data(), 6);
+  std::memcpy(msg + 14, station.octets.data(), 6);
+  const Sha1Digest mac = hmac_sha1(pmk, ByteSpan(msg, sizeof(msg)));
+  std::array<std::uint8_t, 16> out;
+  std::memcpy(out.data(), mac.data(), out.size());
+  return out;
+}
+
+}  // namespace
+
+PmkidTarget PmkidTarget::parse(std::string_view line) {
+  while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.remove_suffix(1);
+
+  std::vector<std::string_view> fields;
+  for (std::size_t start = 0;;) {
+    const std::size_t star = line.find('*', start);
+    fields.push_back(line.substr(start, star == std::string_view::npos ? std::string_view::npos : star - start));
+    if (star == std::string_view::npos) break;
+    start = star + 1;
+  }
+  if (fields.size() < 6 || fields[0] != "WPA" || fields[1] != "01")
+    throw std::invalid_argument("22000: only WPA*01 (PMKID) lines are supported");
+
+  PmkidTarget t;
+  const auto pmkid = decode_field(fields[2], "pmkid");
+  const auto ap = decode_field(fields[3], "mac_ap");
+  const auto sta = decode_field(fields[4], "mac_client");
+  const auto essid = decode_field(fields[5], "essid");
+  if (pmkid.size() != 16 || ap.size() != 6 || sta.size() != 6 || essid.empty() || essid.size() > 32)
+    throw std::invalid_argument("22000: field has the wrong length");
+  std::memcpy(t.pmkid.data(), pmkid.data(), 16);
+  t.ap = MacAddress::from(ap.data());
+  t.station = MacAddress::from(sta.data());
+  t.essid.assign(essid.begin(), essid.end());
+  return t;
+}
+
+PmkidTarget PmkidTarget::from_passphrase(std::string_view passphrase, std::string_view essid, const MacAddress& ap,
+                                         const MacAddress& station) {
+  PmkidTarget t;
+  t.ap = ap;
+  t.station = station;
+  t.essid = essid;
+  t.pmkid = compute_pmkid(wpa_pmk(passphrase, essid), ap, station);
+  return t;
+}
+
+std::string PmkidTarget::format() const {
+  std::string out = "WPA*01*";
+  append_hex(out, pmkid);
+  out.push_back('*');
+  append_hex(out, ap.octets);
+  out.push_back('*');
+  append_hex(out, station.octets);
+  out.push_back('*');
+  append_hex(out, essid);
+  out += "***";
+  return out;
+}
+
+bool PmkidTarget::matches(const Pmk& pmk) const { return compute_pmkid(pmk, ap, station) == pmkid; }
+
+}  // namespace etheros::crack
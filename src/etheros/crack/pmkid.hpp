@@ -0,0 +1,37 @@
+#pragma once
+
+// WPA PMKID targets in hashcat's 22000 format, type 01:
+//
+//   WPA*01*<pmkid>*<mac_ap>*<mac_client>*<essid hex>***
+//
+// PMKID = HMAC-SHA1-128(PMK, "PMK Name" || MAC_AP || MAC_STA), so testing a
+// candidate costs one PMK derivation plus a single HMAC.
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "etheros/common/bytes.hpp"
+#include "etheros/crack/pbkdf2.hpp"
+
+namespace etheros::crack {
+
+struct PmkidTarget {
+  std::array<std::uint8_t, 16> pmkid{};
+  MacAddress ap;
+  MacAddress station;
+  std::string essid;
+
+  // Throws std::invalid_argument on anything but a well-formed WPA*01 line.
+  static PmkidTarget parse(std::string_view line);
+  // Builds a target from a known passphrase; used for lab setups.
+  static PmkidTarget from_passphrase(std::string_view passphrase, std::string_view essid, const MacAddress& ap,
+                                     const MacAddress& station);
+
+  std::string format() const;
+  bool matches(const Pmk& pmk) const;
+  bool matches_passphrase(std::string_view passphrase) const { return matches(wpa_pmk(passphrase, essid)); }
+};
+
+}  // namespace etheros::crack
@@ -0,0 +1,89 @@
+#include "etheros/crack/sha1.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace etheros::crack {
+
+void sha1_compress(Sha1State& state, const std::uint8_t* block) {
+  std::uint32_t w[16];
+  for (int i = 0; i < 16; ++i) w[i] = load_be32(block + 4 * i);
+
+  std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+  // 16-word rolling schedule keeps the working set in registers on AArch64.
+  for (int i = 0; i < 80; ++i) {
+    std::uint32_t wi;
+    if (i < 16) {
+      wi = w[i];
+    } else {
+      wi = std::rotl(w[(i + 13) & 15] ^ w[(i + 8) & 15] ^ w[(i + 2) & 15] ^ w[i & 15], 1);
+      w[i & 15] = wi;
+    }
+    std::uint32_t f, k;
+    if (i < 20) {
+      f = (b & c) | (~b & d);
+      k = 0x5a827999;
+    } else if (i < 40) {
+      f = b ^ c ^ d;
+      k = 0x6ed9eba1;
+    } else if (i < 60) {
+      f = (b & c) | (b & d) | (c & d);
+      k = 0x8f1bbcdc;
+    } else {
+      f = b ^ c ^ d;
+      k = 0xca62c1d6;
+    }
+    const std::uint32_t t = std::rotl(a, 5) + f + e + k + wi;
+    e = d;
+    d = c;
+    c = std::rotl(b, 30);
+    b = a;
+    a = t;
+  }
+
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+}
+
+void Sha1::update(ByteSpan data) {
+  length_ += data.size();
+  const std::uint8_t* p = data.data();
+  std::size_t n = data.size();
+  if (used_ > 0) {
+    const std::size_t take = n < 64 - used_ ? n : 64 - used_;
+    std::memcpy(block_ + used_, p, take);
+    used_ += take;
+    p += take;
+    n -= take;
+    if (used_ < 64) return;
+    sha1_compress(state_, block_);
+    used_ = 0;
+  }
+  for (; n >= 64; p += 64, n -= 64) sha1_compress(state_, p);
+  std::memcpy(block_, p, n);
+  used_ = n;
+}
+
+Sha1Digest Sha1::final() {
+  const std::uint64_t bits = length_ * 8;
+  block_[used_++] = 0x80;
+  if (used_ > 56) {
+    std::memset(block_ + used_, 0, 64 - used_);
+    sha1_compress(state_, block_);
+    used_ = 0;
+  }
+  std::memset(block_ + used_, 0, 56 - used_);
+  store_be32(block_ + 56, static_cast<std::uint32_t>(bits >> 32));
+  store_be32(block_ + 60, static_cast<std::uint32_t>(bits));
+  sha1_compress(state_, block_);
+
+  Sha1Digest out;
+  for (int i = 0; i < 5; ++i) store_be32(out.data() + 4 * i, state_[i]);
+  return out;
+}
+
+}  // namespace etheros::crack
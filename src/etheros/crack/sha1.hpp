@@ -0,0 +1,34 @@
+#pragma once
+
+// SHA-1, kept in-tree because PBKDF2 for WPA needs direct access to the
+// compression function and midstates, which general crypto APIs hide.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "etheros/common/bytes.hpp"
+
+namespace etheros::crack {
+
+using Sha1State = std::array<std::uint32_t, 5>;
+using Sha1Digest = std::array<std::uint8_t, 20>;
+
+inline constexpr Sha1State kSha1Init = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+// Processes one 64-byte block into state.
+void sha1_compress(Sha1State& state, const std::uint8_t* block);
+
+class Sha1 {
+ public:
+  void update(ByteSpan data);
+  Sha1Digest final();
+
+ private:
+  Sha1State state_ = kSha1Init;
+  std::uint8_t block_[64] = {};
+  std::size_t used_ = 0;
+  std::uint64_t length_ = 0;
+};
+
+}  // namespace etheros::crack
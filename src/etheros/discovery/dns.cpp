@@ -0,0 +1,112 @@
+#include "etheros/discovery/dns.hpp"
+
+namespace etheros::discovery {
+
+namespace {
+
+constexpr std::size_t kHeaderSize = 12;
+constexpr int kMaxPointers = 16;
+
+void append(DnsName& out, char c) {
+  if (out.size < sizeof(out.text)) out.text[out.size++] = c;
+}
+
+}  // namespace
+
+DnsReader::DnsReader(ByteSpan message) : msg_(message) {
+  if (msg_.size() < kHeaderSize) return;
+  valid_ = true;
+  for (int i = 0; i < 4; ++i) remaining_[i] = load_be16(msg_.data() + 4 + 2 * i);
+}
+
+std::size_t DnsReader::skip_name(std::size_t offset) const {
+  while (offset < msg_.size()) {
+    const std::uint8_t len = msg_[offset];
+    if (len == 0) return offset + 1;
+    if ((len & 0xc0) == 0xc0) return offset + 2 <= msg_.size() ? offset + 2 : 0;
+    if (len & 0xc0) return 0;
+    offset += 1 + len;
+  }
+  return 0;
+}
+
+bool DnsReader::next(DnsRecord& rr) {
+  if (!valid_) return false;
+  while (section_ < 4 && remaining_[section_] == 0) ++section_;
+  if (section_ == 4) return false;
+  --remaining_[section_];
+
+  const std::size_t end = skip_name(pos_);
+  const std::size_t fixed = section_ == 0 ? 4 : 10;
+  if (end == 0 || end + fixed > msg_.size()) {
+    valid_ = false;
+    return false;
+  }
+  rr.section = static_cast<DnsSection>(section_);
+  rr.name_offset = pos_;
+  rr.type = load_be16(msg_.data() + end);
+  rr.rr_class = load_be16(msg_.data() + end + 2);
+  if (section_ == 0) {
+    rr.ttl = 0;
+    rr.rdata = {};
+    rr.rdata_offset = end + 4;
+    pos_ = end + 4;
+    return true;
+  }
+  rr.ttl = load_be32(msg_.data() + end + 4);
+  const std::size_t rdlen = load_be16(msg_.data() + end + 8);
+  rr.rdata_offset = end + 10;
+  if (rr.rdata_offset + rdlen > msg_.size()) {
+    valid_ = false;
+    return false;
+  }
+  rr.rdata = msg_.subspan(rr.rdata_offset, rdlen);
+  pos_ = rr.rdata_offset + rdlen;
+  return true;
+}
+
+bool DnsReader::name(std::size_t offset, DnsName& out) const {
+  out.size = 0;
+  int pointers = 0;
+  while (offset < msg_.size()) {
+    const std::uint8_t len = msg_[offset];
+    if (len == 0) return true;
+    if ((len & 0xc0) == 0xc0) {
+      if (offset + 1 >= msg_.size() || ++pointers > kMaxPointers) return false;
+      const std::size_t target = (len & 0x3fu) << 8 | msg_[offset + 1];
+      // Pointers must go backwards, which also rules out loops.
+      if (target >= offset) return false;
+      offset = target;
+      continue;
+    }
+    if ((len & 0xc0) != 0 || offset + 1 + len > msg_.size()) return false;
+    if (out.size > 0) append(out, '.');
+    for (std::size_t i = 0; i < len; ++i) append(out, static_cast<char>(msg_[offset + 1 + i]));
+    offset += 1 + len;
+  }
+  return false;
+}
+
+bool decode_netbios_name(std::string_view label, DnsName& out) {
+  // The label is the first (and, without a scope id, only) label of the name.
+  if (label.size() < 32 || (label.size() > 32 && label[32] != '.')) return false;
+  char raw[16];
+  for (std::size_t i = 0; i < 16; ++i) {
+    const char hi = label[2 * i], lo = label[2 * i + 1];
+    if (hi < 'A' || hi > 'P' || lo < 'A' || lo > 'P') return false;
+    raw[i] = static_cast<char>((hi - 'A') << 4 | (lo - 'A'));
+  }
+  std::size_t n = 15;
+  while (n > 0 && (raw[n - 1] == ' ' || raw[n - 1] == '\0')) --n;
+  static constexpr char kHex[] = "0123456789abcdef";
+  out.size = 0;
+  for (std::size_t i = 0; i < n; ++i) append(out, raw[i]);
+  const auto suffix = static_cast<std::uint8_t>(raw[15]);
+  append(out, '<');
+  append(out, kHex[suffix >> 4]);
+  append(out, kHex[suffix & 0xf]);
+  append(out, '>');
+  return true;
+}
+
+}  // namespace etheros::discovery
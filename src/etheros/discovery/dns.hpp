@@ -0,0 +1,83 @@
+#pragma once
+
+// Allocation-free reader for DNS-format messages, shared by mDNS, LLMNR and
+// NBNS. Records are walked in place; names are decoded only when asked for,
+// into a caller-provided fixed buffer, so uninteresting records cost a few
+// bounds checks.
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "etheros/common/bytes.hpp"
+
+namespace etheros::discovery {
+
+enum DnsType : std::uint16_t {
+  kDnsA = 1,
+  kDnsPtr = 12,
+  kDnsTxt = 16,
+  kDnsAaaa = 28,
+  kDnsSrv = 33,
+  kNbnsNb = 32,  // NBNS name record (flags + IPv4 address)
+};
+
+enum class DnsSection : std::uint8_t { kQuestion, kAnswer, kAuthority, kAdditional };
+
+struct DnsRecord {
+  DnsSection section = DnsSection::kQuestion;
+  std::size_t name_offset = 0;
+  std::uint16_t type = 0;
+  std::uint16_t rr_class = 0;  // mDNS uses the top bit for cache-flush / unicast-response
+  std::uint32_t ttl = 0;
+  ByteSpan rdata;
+  std::size_t rdata_offset = 0;
+};
+
+// Dotted presentation form, truncated at 255 bytes.
+struct DnsName {
+  char text[256];
+  std::size_t size = 0;
+
+  std::string_view view() const { return {text, size}; }
+};
+
+class DnsReader {
+ public:
+  explicit DnsReader(ByteSpan message);
+
+  // False if the message is shorter than a header.
+  bool valid() const { return valid_; }
+  std::uint16_t id() const { return load_be16(msg_.data()); }
+  std::uint16_t flags() const { return load_be16(msg_.data() + 2); }
+  bool is_response() const { return (flags() & 0x8000) != 0; }
+  std::uint8_t opcode() const { return static_cast<std::uint8_t>((flags() >> 11) & 0xf); }
+  std::uint8_t rcode() const { return static_cast<std::uint8_t>(flags() & 0xf); }
+
+  // Walks questions, then answer, authority and additional records. Returns
+  // false at the end or at the first malformed entry.
+  bool next(DnsRecord& rr);
+
+  // Decodes the (possibly compressed) name at offset. Returns false if it is
+  // malformed or loops.
+  bool name(std::size_t offset, DnsName& out) const;
+
+  ByteSpan message() const { return msg_; }
+
+ private:
+  // Offset just past the name at offset, or 0 if malformed.
+  std::size_t skip_name(std::size_t offset) const;
+
+  ByteSpan msg_;
+  bool valid_ = false;
+  std::size_t pos_ = 12;
+  std::uint16_t remaining_[4] = {};
+  int section_ = 0;
+};
+
+// NBNS first-level encoding: 32 letters 'A'..'P' carrying 16 bytes, the last
+// of which is the service suffix. Writes "NAME<xx>" with padding trimmed;
+// returns false for anything else.
+bool decode_netbios_name(std::string_view label, DnsName& out);
+
+}  // namespace etheros::discovery
@@ -0,0 +1,273 @@
+#include "etheros/discovery/harvester.hpp"
+
+#include <arpa/inet.h>
+
+#include <cstdio>
+
+#include "etheros/discovery/ssdp.hpp"
+
+namespace etheros::discovery {
+
+namespace {
+
+// NBNS opcodes that announce a name together with its address.
+bool nbns_announces(std::uint8_t opcode) { return opcode == 5 || opcode == 8 || opcode == 9 || opcode == 15; }
+
+// Length of the valid UTF-8 sequence at p, or 0.
+std::size_t utf8_length(const unsigned char* p, std::size_t n) {
+  const unsigned char c = p[0];
+  std::size_t len;
+  std::uint32_t min;
+  if (c >= 0xc2 && c <= 0xdf) {
+    len = 2;
+    min = 0x80;
+  } else if (c >= 0xe0 && c <= 0xef) {
+    len = 3;
+    min = 0x800;
+  } else if (c >= 0xf0 && c <= 0xf4) {
+    len = 4;
+    min = 0x10000;
+  } else {
+    return 0;
+  }
+  if (len > n) return 0;
+  std::uint32_t cp = c & (0x7f >> len);
+  for (std::size_t i = 1; i < len; ++i) {
+    if ((p[i] & 0xc0) != 0x80) return 0;
+    cp = cp << 6 | (p[i] & 0x3f);
+  }
+  if (cp < min || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff)) return 0;
+  return len;
+}
+
+// Names come straight off the wire, so anything that is not valid UTF-8 is
+// escaped byte by byte rather than producing an invalid JSON line.
+void append_json_string(std::string& out, std::string_view s) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  out.push_back('"');
+  const auto* p = reinterpret_cast<const unsigned char*>(s.data());
+  for (std::size_t i = 0; i < s.size();) {
+    const unsigned char c = p[i];
+    if (c == '"' || c == '\\') {
+      out.push_back('\\');
+      out.push_back(static_cast<char>(c));
+    } else if (c >= 0x20 && c < 0x7f) {
+      out.push_back(static_cast<char>(c));
+    } else if (const std::size_t len = c >= 0x80 ? utf8_length(p + i, s.size() - i) : 0) {
+      out.append(s.data() + i, len);
+      i += len;
+      continue;
+    } else {
+      out += "\\u00";
+      out.push_back(kHex[c >> 4]);
+      out.push_back(kHex[c & 0xf]);
+    }
+    ++i;
+  }
+  out.push_back('"');
+}
+
+void append_field(std::string& out, std::string_view key, std::string_view value) {
+  out += ",\"";
+  out += key;
+  out += "\":";
+  append_json_string(out, value);
+}
+
+void append_ip(std::string& out, const IpAddress& ip) {
+  char text[INET6_ADDRSTRLEN];
+  if (ip.is_v4())
+    ::inet_ntop(AF_INET, ip.bytes.data() + 12, text, sizeof(text));
+  else
+    ::inet_ntop(AF_INET6, ip.bytes.data(), text, sizeof(text));
+  out += text;
+}
+
+// JSON keys for Fact::a, b and c, per FactKind.
+constexpr std::string_view kFieldNames[][3] = {
+    {"name", "", ""},                  // kName
+    {"name", "", ""},                  // kQuery
+    {"name", "type", ""},              // kService
+    {"name", "target", ""},            // kEndpoint
+    {"type", "location", "server"},    // kDevice
+};
+
+}  // namespace
+
+bool Harvester::process(std::uint64_t ts_ns, const parse::DecodedPacket& pkt) {
+  if (!pkt.has(parse::kLayerUdp)) return false;
+  auto on_port = [&](std::uint16_t port) { return pkt.src_port == port || pkt.dst_port == port; };
+  if (on_port(kMdnsPort)) {
+    ++stats_.mdns;
+    dns_family(Protocol::kMdns, ts_ns, pkt);
+  } else if (on_port(kLlmnrPort)) {
+    ++stats_.llmnr;
+    dns_family(Protocol::kLlmnr, ts_ns, pkt);
+  } else if (on_port(kNbnsPort)) {
+    ++stats_.nbns;
+    dns_family(Protocol::kNbns, ts_ns, pkt);
+  } else if (on_port(kSsdpPort)) {
+    ++stats_.ssdp;
+    ssdp(ts_ns, pkt);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::uint32_t Harvester::address_host(ByteSpan rdata, const parse::DecodedPacket& pkt, std::uint32_t ts_s) {
+  IpAddress ip;
+  if (rdata.size() == 4)
+    ip = IpAddress::from_v4(rdata.data());
+  else if (rdata.size() == 16)
+    ip = IpAddress::from_v6(rdata.data());
+  else
+    return kNoHost;
+  // The MAC is only known when a host speaks for itself.
+  return touch_host(ip, ip == pkt.src_ip ? pkt.src_mac : MacAddress{}, ts_s);
+}
+
+std::uint32_t Harvester::touch_host(const IpAddress& ip, const MacAddress& mac, std::uint32_t ts_s) {
+  const std::uint32_t id = inventory_.touch_host(ip, mac, ts_s);
+  if (id == kNoHost) ++stats_.rejected_hosts;
+  return id;
+}
+
+std::uint32_t Harvester::intern(std::string_view s) {
+  const std::uint32_t id = inventory_.strings().intern(s);
+  if (id == kNoString) ++stats_.rejected_strings;
+  return id;
+}
+
+void Harvester::dns_family(Protocol protocol, std::uint64_t ts_ns, const parse::DecodedPacket& pkt) {
+  DnsReader reader(pkt.payload);
+  if (!reader.valid()) {
+    ++stats_.malformed;
+    return;
+  }
+  const auto ts_s = static_cast<std::uint32_t>(ts_ns / 1'000'000'000);
+  const std::uint32_t sender = touch_host(pkt.src_ip, pkt.src_mac, ts_s);
+  const bool nbns = protocol == Protocol::kNbns;
+
+  DnsRecord rr;
+  while (reader.next(rr)) {
+    if (rr.section == DnsSection::kQuestion) {
+      // NBNS registrations repeat the name as a question; only opcode 0 asks.
+      if (reader.is_response() || (nbns && reader.opcode() != 0)) continue;
+      if (!reader.name(rr.name_offset, name_) || name_.size == 0) continue;
+      if (nbns && !decode_netbios_name(name_.view(), name_)) continue;
+      record(ts_ns, Fact{sender, FactKind::kQuery, protocol, 0, intern(name_.view())});
+      continue;
+    }
+
+    if (nbns) {
+      if (rr.type != kNbnsNb || (!reader.is_response() && !nbns_announces(reader.opcode()))) continue;
+      if (reader.is_response() && reader.rcode() != 0) continue;
+      if (!reader.name(rr.name_offset, name_) || !decode_netbios_name(name_.view(), name_)) continue;
+      const std::uint32_t id = intern(name_.view());
+      // NB rdata: one (flags, IPv4 address) pair per address.
+      for (std::size_t off = 0; off + 6 <= rr.rdata.size(); off += 6) {
+        const std::uint32_t host = address_host(rr.rdata.subspan(off + 2, 4), pkt, ts_s);
+        record(ts_ns, Fact{host, FactKind::kName, protocol, 0, id});
+      }
+      continue;
+    }
+
+    // Answers inside a query are the asker's cached known answers, not facts
+    // about the asker; only probes (authority records) speak for it.
+    if (!reader.is_response() && rr.section != DnsSection::kAuthority) continue;
+    switch (rr.type) {
+      case kDnsA:
+      case kDnsAaaa: {
+        const std::uint32_t host = address_host(rr.rdata, pkt, ts_s);
+        if (host == kNoHost || !reader.name(rr.name_offset, name_) || name_.size == 0) break;
+        record(ts_ns, Fact{host, FactKind::kName, protocol, 0, intern(name_.view())});
+        break;
+      }
+      case kDnsPtr: {
+        // Reverse-lookup PTRs repeat what A/AAAA records already say.
+        if (protocol != Protocol::kMdns || !reader.name(rr.name_offset, name_) ||
+            name_.view().ends_with(".arpa") || !reader.name(rr.rdata_offset, name2_))
+          break;
+        record(ts_ns, Fact{sender, FactKind::kService, protocol, 0, intern(name2_.view()),
+                           intern(name_.view())});
+        break;
+      }
+      case kDnsSrv: {
+        if (protocol != Protocol::kMdns || rr.rdata.size() < 7 || !reader.name(rr.name_offset, name_) ||
+            !reader.name(rr.rdata_offset + 6, name2_))
+          break;
+        const std::uint16_t port = load_be16(rr.rdata.data() + 4);
+        record(ts_ns, Fact{sender, FactKind::kEndpoint, protocol, port, intern(name_.view()),
+                           intern(name2_.view())});
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  if (!reader.valid()) ++stats_.malformed;
+}
+
+void Harvester::ssdp(std::uint64_t ts_ns, const parse::DecodedPacket& pkt) {
+  SsdpMessage msg;
+  if (!parse_ssdp(pkt.payload, msg)) {
+    ++stats_.malformed;
+    return;
+  }
+  const auto ts_s = static_cast<std::uint32_t>(ts_ns / 1'000'000'000);
+  const std::uint32_t sender = touch_host(pkt.src_ip, pkt.src_mac, ts_s);
+  if (msg.kind == SsdpMessage::Kind::kSearch) {
+    if (!msg.type.empty()) record(ts_ns, Fact{sender, FactKind::kQuery, Protocol::kSsdp, 0, intern(msg.type)});
+    return;
+  }
+  // Without a type or a location there is nothing to say about the device;
+  // the sighting itself is already on the host.
+  if (msg.nts == "ssdp:byebye" || (msg.type.empty() && msg.location.empty())) return;
+  record(ts_ns, Fact{sender, FactKind::kDevice, Protocol::kSsdp, 0, intern(msg.type),
+                     intern(msg.location), intern(msg.server)});
+}
+
+void Harvester::record(std::uint64_t ts_ns, const Fact& fact) {
+  // A refused host or string was already counted; the fact cannot be stored.
+  if (fact.host == kNoHost || fact.a == kNoString || fact.b == kNoString || fact.c == kNoString) return;
+  const AddResult added = inventory_.add(fact);
+  if (added == AddResult::kFull) ++stats_.rejected_facts;
+  if (added != AddResult::kAdded) return;
+  ++stats_.new_facts;
+  if (!out_) return;
+
+  const Host& host = inventory_.hosts()[fact.host];
+  const StringTable& strings = inventory_.strings();
+  char ts[32];
+  std::snprintf(ts, sizeof(ts), "%llu.%06llu", static_cast<unsigned long long>(ts_ns / 1'000'000'000),
+                static_cast<unsigned long long>(ts_ns % 1'000'000'000 / 1000));
+
+  line_.clear();
+  line_ += "{\"ts\":";
+  line_ += ts;
+  append_field(line_, "proto", to_string(fact.protocol));
+  append_field(line_, "kind", to_string(fact.kind));
+  line_ += ",\"ip\":\"";
+  append_ip(line_, host.ip);
+  line_ += '"';
+  if (host.mac.to_u64() != 0) {
+    char mac[18];
+    const auto& o = host.mac.octets;
+    std::snprintf(mac, sizeof(mac), "%02x:%02x:%02x:%02x:%02x:%02x", o[0], o[1], o[2], o[3], o[4], o[5]);
+    append_field(line_, "mac", mac);
+  }
+  const std::uint32_t values[3] = {fact.a, fact.b, fact.c};
+  for (int i = 0; i < 3; ++i) {
+    const std::string_view key = kFieldNames[static_cast<int>(fact.kind)][i];
+    if (!key.empty() && values[i] != 0) append_field(line_, key, strings.get(values[i]));
+  }
+  if (fact.port != 0) {
+    line_ += ",\"port\":";
+    line_ += std::to_string(fact.port);
+  }
+  line_ += "}\n";
+  out_->write(std::string_view(line_));
+}
+
+}  // namespace etheros::discovery
@@ -0,0 +1,72 @@
+#pragma once
+
+// Passive service-discovery harvesting: mDNS, LLMNR, NBNS and SSDP traffic is
+// parsed in place and folded into an Inventory. Each fact the inventory has
+// not seen before is appended to the output as one JSON line, e.g.
+//
+//   {"ts":1700000000.000120,"proto":"mdns","kind":"endpoint","ip":"10.0.0.7",
+//    "mac":"02:00:00:00:00:07","name":"Office._ipp._tcp.local",
+//    "target":"printer-7.local","port":631}
+//
+// (one line in the file). Lines accumulate in the FdWriter's buffer, so a
+// steady trickle of discoveries costs one write() per buffer, not per line.
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "etheros/discovery/dns.hpp"
+#include "etheros/discovery/inventory.hpp"
+#include "etheros/io/fd_writer.hpp"
+#include "etheros/parse/decode.hpp"
+
+namespace etheros::discovery {
+
+inline constexpr std::uint16_t kNbnsPort = 137;
+inline constexpr std::uint16_t kSsdpPort = 1900;
+inline constexpr std::uint16_t kMdnsPort = 5353;
+inline constexpr std::uint16_t kLlmnrPort = 5355;
+
+struct HarvestStats {
+  std::uint64_t mdns = 0;
+  std::uint64_t llmnr = 0;
+  std::uint64_t nbns = 0;
+  std::uint64_t ssdp = 0;
+  std::uint64_t malformed = 0;
+  std::uint64_t new_facts = 0;
+  // Refused because the inventory reached a cap; repeats count each time.
+  std::uint64_t rejected_hosts = 0;
+  std::uint64_t rejected_facts = 0;
+  std::uint64_t rejected_strings = 0;
+};
+
+class Harvester {
+ public:
+  // out may be null to only build the inventory.
+  explicit Harvester(io::FdWriter* out = nullptr, const InventoryOptions& options = {})
+      : inventory_(options), out_(out) {}
+
+  // Returns true if the packet was discovery traffic.
+  bool process(std::uint64_t ts_ns, const parse::DecodedPacket& pkt);
+
+  const Inventory& inventory() const { return inventory_; }
+  const HarvestStats& stats() const { return stats_; }
+
+ private:
+  void dns_family(Protocol protocol, std::uint64_t ts_ns, const parse::DecodedPacket& pkt);
+  void ssdp(std::uint64_t ts_ns, const parse::DecodedPacket& pkt);
+  void record(std::uint64_t ts_ns, const Fact& fact);
+  std::uint32_t address_host(ByteSpan rdata, const parse::DecodedPacket& pkt, std::uint32_t ts_s);
+  // Inventory lookups that count refusals.
+  std::uint32_t touch_host(const IpAddress& ip, const MacAddress& mac, std::uint32_t ts_s);
+  std::uint32_t intern(std::string_view s);
+
+  Inventory inventory_;
+  io::FdWriter* out_;
+  HarvestStats stats_;
+  std::string line_;  // reused for every JSON line
+  DnsName name_;
+  DnsName name2_;
+};
+
+}  // namespace etheros::discovery
@@ -0,0 +1,169 @@
+#include "etheros/discovery/inventory.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace etheros::discovery {
+
+namespace {
+
+constexpr std::size_t kInitialSlots = 256;
+
+std::uint32_t fnv1a(const void* data, std::size_t n, std::uint32_t h = 2166136261u) {
+  const auto* p = static_cast<const std::uint8_t*>(data);
+  for (std::size_t i = 0; i < n; ++i) h = (h ^ p[i]) * 16777619u;
+  return h;
+}
+
+// Reduces a 32-bit hash to a slot; mixing first so FNV's weak low bits do not
+// cluster.
+std::size_t home(std::uint32_t hash, std::size_t mask) {
+  return static_cast<std::size_t>((hash * 0x9e3779b1u) >> 8) & mask;
+}
+
+}  // namespace
+
+std::string_view to_string(Protocol p) {
+  switch (p) {
+    case Protocol::kMdns:
+      return "mdns";
+    case Protocol::kLlmnr:
+      return "llmnr";
+    case Protocol::kNbns:
+      return "nbns";
+    case Protocol::kSsdp:
+      return "ssdp";
+  }
+  return "?";
+}
+
+std::string_view to_string(FactKind k) {
+  switch (k) {
+    case FactKind::kName:
+      return "name";
+    case FactKind::kQuery:
+      return "query";
+    case FactKind::kService:
+      return "service";
+    case FactKind::kEndpoint:
+      return "endpoint";
+    case FactKind::kDevice:
+      return "device";
+  }
+  return "?";
+}
+
+StringTable::StringTable(std::size_t max_bytes) : max_bytes_(max_bytes), index_(kInitialSlots, Slot{0, 0}) {
+  // The last id must stay below kNoString.
+  if (max_bytes >= kNoString - 1) throw std::invalid_argument("string table: max_bytes must be below 4GiB");
+  arena_.reserve(std::min<std::size_t>(4096, max_bytes));
+}
+
+std::uint32_t StringTable::intern(std::string_view s) {
+  if (s.empty()) return 0;
+  if (s.size() > 255) s = s.substr(0, 255);
+  const std::uint32_t h = fnv1a(s.data(), s.size());
+  if ((size_ + 1) * 4 > index_.size() * 3) grow();
+
+  const std::size_t mask = index_.size() - 1;
+  std::size_t i = home(h, mask);
+  for (; index_[i].id != 0; i = (i + 1) & mask)
+    if (index_[i].hash == h && get(index_[i].id) == s) return index_[i].id;
+
+  const std::size_t need = arena_.size() + 1 + s.size();
+  if (need > max_bytes_) return kNoString;
+  // Grow by doubling, but never reserve past the cap.
+  if (need > arena_.capacity()) arena_.reserve(std::min(std::max(arena_.capacity() * 2, need), max_bytes_));
+  const auto id = static_cast<std::uint32_t>(arena_.size() + 1);
+  arena_.push_back(static_cast<char>(s.size()));
+  arena_.insert(arena_.end(), s.begin(), s.end());
+  index_[i] = Slot{h, id};
+  ++size_;
+  return id;
+}
+
+std::string_view StringTable::get(std::uint32_t id) const {
+  if (id == 0) return {};
+  const char* p = arena_.data() + id - 1;
+  return {p + 1, static_cast<unsigned char>(*p)};
+}
+
+void StringTable::grow() {
+  std::vector<Slot> old = std::exchange(index_, std::vector<Slot>(index_.size() * 2, Slot{0, 0}));
+  const std::size_t mask = index_.size() - 1;
+  for (const Slot& slot : old) {
+    if (slot.id == 0) continue;
+    std::size_t i = home(slot.hash, mask);
+    while (index_[i].id != 0) i = (i + 1) & mask;
+    index_[i] = slot;
+  }
+}
+
+std::size_t StringTable::memory_bytes() const { return arena_.capacity() + index_.capacity() * sizeof(Slot); }
+
+Inventory::Inventory(const InventoryOptions& options)
+    : options_(options),
+      strings_(options.max_string_bytes),
+      host_index_(kInitialSlots, Slot{0, 0}),
+      fact_index_(kInitialSlots, Slot{0, 0}) {}
+
+std::uint32_t Inventory::hash(const IpAddress& ip) { return fnv1a(ip.bytes.data(), ip.bytes.size()); }
+
+std::uint32_t Inventory::hash(const Fact& f) {
+  const std::uint32_t words[6] = {f.host,
+                                  static_cast<std::uint32_t>(f.kind) | static_cast<std::uint32_t>(f.protocol) << 8 |
+                                      static_cast<std::uint32_t>(f.port) << 16,
+                                  f.a, f.b, f.c, 0};
+  return fnv1a(words, sizeof(words));
+}
+
+void Inventory::grow(std::vector<Slot>& index) {
+  std::vector<Slot> old = std::exchange(index, std::vector<Slot>(index.size() * 2, Slot{0, 0}));
+  const std::size_t mask = index.size() - 1;
+  for (const Slot& slot : old) {
+    if (slot.id == 0) continue;
+    std::size_t i = home(slot.hash, mask);
+    while (index[i].id != 0) i = (i + 1) & mask;
+    index[i] = slot;
+  }
+}
+
+std::uint32_t Inventory::touch_host(const IpAddress& ip, const MacAddress& mac, std::uint32_t ts_s) {
+  if ((hosts_.size() + 1) * 4 > host_index_.size() * 3) grow(host_index_);
+  const std::uint32_t h = hash(ip);
+  const std::size_t mask = host_index_.size() - 1;
+  std::size_t i = home(h, mask);
+  for (; host_index_[i].id != 0; i = (i + 1) & mask) {
+    if (host_index_[i].hash != h) continue;
+    Host& host = hosts_[host_index_[i].id - 1];
+    if (host.ip != ip) continue;
+    host.last_seen_s = ts_s;
+    if (mac.to_u64() != 0) host.mac = mac;
+    return host_index_[i].id - 1;
+  }
+  if (hosts_.size() >= options_.max_hosts) return kNoHost;
+  hosts_.push_back(Host{ip, mac, ts_s, ts_s});
+  host_index_[i] = Slot{h, static_cast<std::uint32_t>(hosts_.size())};
+  return static_cast<std::uint32_t>(hosts_.size() - 1);
+}
+
+AddResult Inventory::add(const Fact& fact) {
+  if ((facts_.size() + 1) * 4 > fact_index_.size() * 3) grow(fact_index_);
+  const std::uint32_t h = hash(fact);
+  const std::size_t mask = fact_index_.size() - 1;
+  std::size_t i = home(h, mask);
+  for (; fact_index_[i].id != 0; i = (i + 1) & mask)
+    if (fact_index_[i].hash == h && facts_[fact_index_[i].id - 1] == fact) return AddResult::kKnown;
+  if (facts_.size() >= options_.max_facts) return AddResult::kFull;
+  facts_.push_back(fact);
+  fact_index_[i] = Slot{h, static_cast<std::uint32_t>(facts_.size())};
+  return AddResult::kAdded;
+}
+
+std::size_t Inventory::memory_bytes() const {
+  return strings_.memory_bytes() + hosts_.capacity() * sizeof(Host) + host_index_.capacity() * sizeof(Slot) +
+         facts_.capacity() * sizeof(Fact) + fact_index_.capacity() * sizeof(Slot);
+}
+
+}  // namespace etheros::discovery
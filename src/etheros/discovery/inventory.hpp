@@ -0,0 +1,136 @@
+#pragma once
+
+// Deduplicated host/service inventory built from discovery traffic.
+//
+// Everything is stored compactly: strings are interned once into a flat
+// arena and referred to by 32-bit id, hosts are fixed-size records indexed by
+// address, and each fact is 20 bytes of ids. All three use open-addressing
+// indexes, so re-observing a known fact (the common case: hosts repeat their
+// announcements every few seconds) costs lookups only and never allocates.
+//
+// Traffic decides how much is learned, so every part has a cap
+// (InventoryOptions). Past a cap, new hosts, facts and strings are refused
+// and known ones still match, so a flood of made-up names cannot exhaust the
+// board's memory.
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "etheros/common/bytes.hpp"
+
+namespace etheros::discovery {
+
+enum class Protocol : std::uint8_t { kMdns, kLlmnr, kNbns, kSsdp };
+
+enum class FactKind : std::uint8_t {
+  kName,      // host answers to a name (a)
+  kQuery,     // host looked up a name (a)
+  kService,   // host offers service instance a of type b
+  kEndpoint,  // service instance a runs on host name b, port
+  kDevice,    // UPnP device or service of type a, description at b, server c
+};
+
+// Returned instead of an id when a cap is reached.
+inline constexpr std::uint32_t kNoHost = ~std::uint32_t{0};
+inline constexpr std::uint32_t kNoString = ~std::uint32_t{0};
+
+struct InventoryOptions {
+  std::uint32_t max_hosts = 64 * 1024;
+  std::uint32_t max_facts = 256 * 1024;
+  // Interned text, one length byte plus up to 255 per string. Ids are
+  // offsets into it, so it must stay below 4GiB.
+  std::size_t max_string_bytes = 16 << 20;
+};
+
+std::string_view to_string(Protocol p);
+std::string_view to_string(FactKind k);
+
+struct Host {
+  IpAddress ip;
+  MacAddress mac;  // zero if only ever seen inside another host's records
+  std::uint32_t first_seen_s = 0;
+  std::uint32_t last_seen_s = 0;
+};
+
+struct Fact {
+  std::uint32_t host = 0;
+  FactKind kind = FactKind::kName;
+  Protocol protocol = Protocol::kMdns;
+  std::uint16_t port = 0;
+  std::uint32_t a = 0;  // interned strings; 0 = none
+  std::uint32_t b = 0;
+  std::uint32_t c = 0;
+
+  friend bool operator==(const Fact&, const Fact&) = default;
+};
+
+class StringTable {
+ public:
+  // Throws std::invalid_argument if max_bytes does not leave room for 32-bit
+  // ids.
+  explicit StringTable(std::size_t max_bytes = InventoryOptions{}.max_string_bytes);
+
+  // Returns a stable non-zero id; the empty string is 0. Strings are
+  // truncated to 255 bytes. A new string that does not fit in max_bytes
+  // gets kNoString.
+  std::uint32_t intern(std::string_view s);
+  // Valid until the next intern().
+  std::string_view get(std::uint32_t id) const;
+
+  std::size_t size() const { return size_; }
+  std::size_t memory_bytes() const;
+
+ private:
+  struct Slot {
+    std::uint32_t hash;
+    std::uint32_t id;  // 0 = empty
+  };
+  void grow();
+
+  std::size_t max_bytes_;
+  std::vector<char> arena_;  // length byte + text per string; id = offset + 1
+  std::vector<Slot> index_;
+  std::size_t size_ = 0;
+};
+
+enum class AddResult : std::uint8_t { kAdded, kKnown, kFull };
+
+class Inventory {
+ public:
+  explicit Inventory(const InventoryOptions& options = {});
+
+  // Finds or adds the host for ip and marks it seen. A non-zero mac replaces
+  // the stored one. Returns kNoHost for a new host once max_hosts are known.
+  std::uint32_t touch_host(const IpAddress& ip, const MacAddress& mac, std::uint32_t ts_s);
+  // kFull once max_facts are known. The fact must not hold kNoHost or
+  // kNoString.
+  AddResult add(const Fact& fact);
+
+  const InventoryOptions& options() const { return options_; }
+  StringTable& strings() { return strings_; }
+  const StringTable& strings() const { return strings_; }
+  const std::vector<Host>& hosts() const { return hosts_; }
+  const std::vector<Fact>& facts() const { return facts_; }
+
+  std::size_t memory_bytes() const;
+
+ private:
+  struct Slot {
+    std::uint32_t hash;
+    std::uint32_t id;  // index + 1; 0 = empty
+  };
+  static std::uint32_t hash(const IpAddress& ip);
+  static std::uint32_t hash(const Fact& fact);
+  static void grow(std::vector<Slot>& index);
+
+  InventoryOptions options_;
+  StringTable strings_;
+  std::vector<Host> hosts_;
+  std::vector<Slot> host_index_;
+  std::vector<Fact> facts_;
+  std::vector<Slot> fact_index_;
+};
+
+}  // namespace etheros::discovery
@@ -0,0 +1,69 @@
+#include "etheros/discovery/ssdp.hpp"
+
+namespace etheros::discovery {
+
+namespace {
+
+bool iequals(std::string_view a, std::string_view b) {
+  if (a.size() != b.size()) return false;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    char x = a[i], y = b[i];
+    if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+    if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+    if (x != y) return false;
+  }
+  return true;
+}
+
+std::string_view trim(std::string_view s) {
+  while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+  while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+  return s;
+}
+
+}  // namespace
+
+bool parse_ssdp(ByteSpan payload, SsdpMessage& out) {
+  std::string_view text(reinterpret_cast<const char*>(payload.data()), payload.size());
+  std::size_t eol = text.find('\n');
+  if (eol == std::string_view::npos) return false;
+  const std::string_view start = trim(text.substr(0, eol));
+  if (start.starts_with("NOTIFY * "))
+    out.kind = SsdpMessage::Kind::kNotify;
+  else if (start.starts_with("M-SEARCH * "))
+    out.kind = SsdpMessage::Kind::kSearch;
+  else if (start.starts_with("HTTP/1.1 200"))
+    out.kind = SsdpMessage::Kind::kResponse;
+  else
+    return false;
+
+  out.type = out.usn = out.location = out.server = out.nts = {};
+  text.remove_prefix(eol + 1);
+  while (!text.empty()) {
+    eol = text.find('\n');
+    const std::string_view line = text.substr(0, eol);
+    text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+    // A folded continuation of the previous header, never a header itself.
+    if (!line.empty() && (line.front() == ' ' || line.front() == '\t')) continue;
+    const std::size_t colon = line.find(':');
+    if (colon == std::string_view::npos) {
+      if (trim(line).empty()) break;  // end of headers
+      continue;
+    }
+    const std::string_view name = trim(line.substr(0, colon));
+    const std::string_view value = trim(line.substr(colon + 1));
+    if (iequals(name, "NT") || iequals(name, "ST"))
+      out.type = value;
+    else if (iequals(name, "USN"))
+      out.usn = value;
+    else if (iequals(name, "LOCATION"))
+      out.location = value;
+    else if (iequals(name, "SERVER"))
+      out.server = value;
+    else if (iequals(name, "NTS"))
+      out.nts = value;
+  }
+  return true;
+}
+
+}  // namespace etheros::discovery
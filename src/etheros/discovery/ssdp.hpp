@@ -0,0 +1,28 @@
+#pragma once
+
+// SSDP (UPnP discovery) messages: HTTP-style headers over UDP 1900. Parsing
+// only slices the payload; every field is a view into the capture buffer.
+
+#include <string_view>
+
+#include "etheros/common/bytes.hpp"
+
+namespace etheros::discovery {
+
+struct SsdpMessage {
+  enum class Kind { kNotify, kSearch, kResponse };
+
+  Kind kind = Kind::kNotify;
+  std::string_view type;      // NT (notify) or ST (search, response)
+  std::string_view usn;
+  std::string_view location;
+  std::string_view server;
+  std::string_view nts;       // ssdp:alive / ssdp:byebye
+};
+
+// Returns false for anything that is not an SSDP request or response. Header
+// names match in any case. Folded continuation lines (obsolete HTTP line
+// folding) are skipped, so a value keeps its first line only.
+bool parse_ssdp(ByteSpan payload, SsdpMessage& out);
+
+}  // namespace etheros::discovery
@@ -0,0 +1,46 @@
+#pragma once
+
+// Bidirectional 5-tuple. The lower endpoint is always stored as `a`, so both
+// directions of a conversation map to the same key.
+
+#include <cstdint>
+#include <cstring>
+
+#include "etheros/common/bytes.hpp"
+#include "etheros/parse/decode.hpp"
+
+namespace etheros::flow {
+
+struct FlowKey {
+  IpAddress a;
+  IpAddress b;
+  std::uint16_t a_port = 0;
+  std::uint16_t b_port = 0;
+  std::uint8_t proto = 0;
+
+  // from_a tells whether the packet was sent by endpoint a.
+  static FlowKey from(const parse::DecodedPacket& pkt, bool& from_a) {
+    FlowKey k;
+    const int order = std::memcmp(pkt.src_ip.bytes.data(), pkt.dst_ip.bytes.data(), 16);
+    from_a = order < 0 || (order == 0 && pkt.src_port <= pkt.dst_port);
+    k.a = from_a ? pkt.src_ip : pkt.dst_ip;
+    k.b = from_a ? pkt.dst_ip : pkt.src_ip;
+    k.a_port = from_a ? pkt.src_port : pkt.dst_port;
+    k.b_port = from_a ? pkt.dst_port : pkt.src_port;
+    k.proto = pkt.ip_proto;
+    return k;
+  }
+
+  std::uint64_t hash() const {
+    std::uint64_t w[4];
+    std::memcpy(w, a.bytes.data(), 16);
+    std::memcpy(w + 2, b.bytes.data(), 16);
+    std::uint64_t h = (std::uint64_t{a_port} << 24 | std::uint64_t{b_port} << 8 | proto) * 0x9e3779b97f4a7c15ull;
+    for (std::uint64_t v : w) h = (h ^ v) * 0xff51afd7ed558ccdull;
+    return h ^ (h >> 29);
+  }
+
+  friend bool operator==(const FlowKey&, const FlowKey&) = default;
+};
+
+}  // namespace etheros::flow
@@ -0,0 +1,315 @@
+#include "etheros/flow/flow_table.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace etheros::flow {
+
+namespace {
+
+// TCP sequence numbers compare modulo 2^32.
+std::int32_t seq_diff(std::uint32_t a, std::uint32_t b) { return static_cast<std::int32_t>(a - b); }
+
+std::uint32_t to_seconds(std::uint64_t ts_ns) { return static_cast<std::uint32_t>(ts_ns / 1'000'000'000); }
+
+}  // namespace
+
+FlowTable::FlowTable(const FlowTableOptions& options, StreamHandler* handler)
+    : options_(options),
+      handler_(handler),
+      wheel_(options.max_flows,
+             std::max({options.tcp_timeout_s, options.half_open_timeout_s, options.closed_timeout_s,
+                       options.udp_timeout_s}) +
+                 1),
+      pool_(options.buffer_bytes) {
+  if (options.max_flows == 0 || options.max_flows >= (1u << 31))
+    throw std::invalid_argument("flow table: max_flows must be in 1..2^31");
+  const std::size_t slots = std::bit_ceil(std::size_t{options.max_flows} * 2);
+  index_.assign(slots, Slot{0, kNoFlow});
+  mask_ = static_cast<std::uint32_t>(slots - 1);
+
+  const std::size_t n = options.max_flows;
+  keys_.resize(n);
+  expires_.resize(n);
+  flags_.resize(n);
+  packets_.resize(n);
+  bytes_.resize(n);
+  next_seq_.resize(n);
+  segments_.resize(n, {SegmentPool::kNone, SegmentPool::kNone});
+  buffered_.resize(n);
+  // Lowest ids first, so a small table stays in few cache lines.
+  free_.resize(n);
+  for (std::size_t i = 0; i < n; ++i) free_[i] = static_cast<FlowId>(n - 1 - i);
+}
+
+FlowTable::~FlowTable() = default;
+
+std::size_t FlowTable::table_memory_bytes() const {
+  const std::size_t per_flow = sizeof(FlowKey) + sizeof(std::uint32_t) + sizeof(std::uint16_t) +
+                               sizeof(std::uint32_t) + sizeof(std::uint64_t) + 2 * sizeof(std::array<std::uint32_t, 2>) +
+                               sizeof(std::uint32_t) + sizeof(FlowId);
+  return index_.size() * sizeof(Slot) + capacity() * per_flow + wheel_.memory_bytes();
+}
+
+FlowId FlowTable::find(const FlowKey& key) const {
+  const std::uint32_t tag = tag_of(key.hash());
+  for (std::uint32_t i = tag & mask_; index_[i].tag != 0; i = (i + 1) & mask_)
+    if (index_[i].tag == tag && keys_[index_[i].id] == key) return index_[i].id;
+  return kNoFlow;
+}
+
+FlowId FlowTable::insert(const FlowKey& key, std::uint32_t tag) {
+  std::uint32_t i = tag & mask_;
+  for (; index_[i].tag != 0; i = (i + 1) & mask_)
+    if (index_[i].tag == tag && keys_[index_[i].id] == key) return index_[i].id;
+  if (free_.empty()) return kNoFlow;
+
+  const FlowId id = free_.back();
+  free_.pop_back();
+  index_[i] = Slot{tag, id};
+  keys_[id] = key;
+  flags_[id] = 0;
+  packets_[id] = 0;
+  bytes_[id] = 0;
+  buffered_[id] = 0;
+  ++size_;
+  ++stats_.created;
+  return id;
+}
+
+void FlowTable::erase_index(FlowId id) {
+  const std::uint32_t tag = tag_of(keys_[id].hash());
+  std::uint32_t i = tag & mask_;
+  while (index_[i].id != id) i = (i + 1) & mask_;
+  // Backward-shift deletion: pull later entries of the cluster into the hole
+  // unless that would move them before their home slot.
+  for (std::uint32_t j = (i + 1) & mask_; index_[j].tag != 0; j = (j + 1) & mask_) {
+    const std::uint32_t home = index_[j].tag & mask_;
+    if (((j - home) & mask_) >= ((j - i) & mask_)) {
+      index_[i] = index_[j];
+      i = j;
+    }
+  }
+  index_[i] = Slot{0, kNoFlow};
+}
+
+void FlowTable::release(FlowId id, CloseReason reason) {
+  if (flags_[id] & kTcp) {
+    flush(id, kToServer);
+    flush(id, kToClient);
+  }
+  if (handler_) handler_->on_close(id, reason);
+  wheel_.cancel(id);
+  erase_index(id);
+  free_.push_back(id);
+  --size_;
+  if (reason == CloseReason::kIdle)
+    ++stats_.expired;
+  else
+    ++stats_.closed;
+}
+
+std::uint32_t FlowTable::timeout_s(FlowId id) const {
+  const std::uint16_t f = flags_[id];
+  if (!(f & kTcp)) return options_.udp_timeout_s;
+  if ((f & (kFin0 | kFin1)) == (kFin0 | kFin1)) return options_.closed_timeout_s;
+  if ((f & (kSeen0 | kSeen1)) != (kSeen0 | kSeen1)) return options_.half_open_timeout_s;
+  return options_.tcp_timeout_s;
+}
+
+void FlowTable::advance(std::uint64_t ts_ns) {
+  const std::uint32_t now = to_seconds(ts_ns);
+  wheel_.advance(now, [&](std::uint32_t id) {
+    if (seq_diff(expires_[id], now) > 0) {
+      wheel_.schedule(id, expires_[id]);
+      return;
+    }
+    const bool closed = (flags_[id] & (kFin0 | kFin1)) == (kFin0 | kFin1);
+    release(id, closed ? CloseReason::kFin : CloseReason::kIdle);
+  });
+}
+
+void FlowTable::clear() {
+  for (std::uint32_t i = 0; i <= mask_ && size_ > 0;) {
+    // release() shifts later entries into slot i, so only advance past
+    // empty slots.
+    if (index_[i].tag != 0)
+      release(index_[i].id, CloseReason::kShutdown);
+    else
+      ++i;
+  }
+}
+
+FlowId FlowTable::process(std::uint64_t ts_ns, const parse::DecodedPacket& pkt) {
+  const bool tcp = pkt.has(parse::kLayerTcp);
+  if (!tcp && !pkt.has(parse::kLayerUdp)) return kNoFlow;
+  advance(ts_ns);
+
+  bool from_a = false;
+  const FlowKey key = FlowKey::from(pkt, from_a);
+  const std::size_t before = size_;
+  const FlowId id = insert(key, tag_of(key.hash()));
+  if (id == kNoFlow) {
+    ++stats_.rejected;
+    return kNoFlow;
+  }
+  const bool created = size_ != before;
+  if (created) {
+    // A SYN-ACK as first packet means its sender is the server.
+    const bool sender_is_client = !(tcp && (pkt.tcp_flags & (parse::kTcpSyn | parse::kTcpAck)) ==
+                                               (parse::kTcpSyn | parse::kTcpAck));
+    flags_[id] = static_cast<std::uint16_t>((tcp ? kTcp : 0) | (from_a != sender_is_client ? kClientIsB : 0));
+  }
+
+  const bool client_is_b = flags_[id] & kClientIsB;
+  const Direction dir = from_a != client_is_b ? kToServer : kToClient;
+  ++packets_[id];
+  bytes_[id] += pkt.payload.size();
+  flags_[id] |= dir == kToServer ? kSeen0 : kSeen1;
+
+  const std::uint32_t old_timeout = created ? 0 : timeout_s(id);
+  if (tcp) {
+    if (pkt.tcp_flags & parse::kTcpRst) {
+      release(id, CloseReason::kRst);
+      return kNoFlow;
+    }
+    track_tcp(id, dir, pkt);
+  }
+
+  const std::uint32_t timeout = timeout_s(id);
+  expires_[id] = to_seconds(ts_ns) + timeout;
+  // Longer deadlines are picked up lazily when the wheel fires; a shorter
+  // one (the flow just closed) must be rescheduled now.
+  if (created || timeout < old_timeout) {
+    wheel_.cancel(id);
+    wheel_.schedule(id, expires_[id]);
+  }
+  return id;
+}
+
+void FlowTable::track_tcp(FlowId id, Direction dir, const parse::DecodedPacket& pkt) {
+  const std::uint16_t seq_flag = dir == kToServer ? kSeq0 : kSeq1;
+  std::uint32_t seq = pkt.tcp_seq;
+  if (pkt.tcp_flags & parse::kTcpSyn) {
+    ++seq;
+    if (!(flags_[id] & seq_flag)) {
+      next_seq_[id][dir] = seq;
+      flags_[id] |= seq_flag;
+    }
+  }
+  if (!pkt.payload.empty()) {
+    // Picked up mid-stream: start at the first data we see.
+    if (!(flags_[id] & seq_flag)) {
+      next_seq_[id][dir] = seq;
+      flags_[id] |= seq_flag;
+    }
+    deliver(id, dir, seq, pkt.payload);
+  }
+  if (pkt.tcp_flags & parse::kTcpFin) flags_[id] |= dir == kToServer ? kFin0 : kFin1;
+}
+
+void FlowTable::deliver(FlowId id, Direction dir, std::uint32_t seq, ByteSpan data) {
+  std::uint32_t& next = next_seq_[id][dir];
+  const std::int32_t ahead = seq_diff(seq, next);
+  if (ahead <= 0) {
+    // In order, possibly overlapping data we already delivered.
+    const auto behind = static_cast<std::uint32_t>(-static_cast<std::int64_t>(ahead));
+    if (behind >= data.size()) return;
+    data = data.subspan(behind);
+    if (handler_) handler_->on_data(id, dir, data);
+    stats_.delivered_bytes += data.size();
+    next += static_cast<std::uint32_t>(data.size());
+    drain(id, dir);
+    return;
+  }
+
+  if (buffered_[id] + data.size() <= options_.max_flow_buffer && buffer(id, dir, seq, data)) return;
+  // Over a cap: give up on the hole, hand over what is buffered and continue
+  // from this segment. Anything buffer() stored before failing is flushed too.
+  flush(id, dir);
+  if (seq_diff(seq, next) > 0) {
+    const std::uint32_t gap = seq - next;
+    ++stats_.gaps;
+    stats_.gap_bytes += gap;
+    if (handler_) handler_->on_gap(id, dir, gap);
+    next = seq;
+  }
+  deliver(id, dir, seq, data);
+}
+
+bool FlowTable::buffer(FlowId id, Direction dir, std::uint32_t seq, ByteSpan data) {
+  // Insert into the seq-sorted block list, keeping bytes that were already
+  // buffered (first copy wins).
+  std::uint32_t prev = SegmentPool::kNone;
+  std::uint32_t cur = segments_[id][dir];
+  while (!data.empty()) {
+    while (cur != SegmentPool::kNone && seq_diff(pool_.seq(cur) + pool_.len(cur), seq) <= 0) {
+      prev = cur;
+      cur = pool_.next(cur);
+    }
+    if (cur != SegmentPool::kNone && seq_diff(pool_.seq(cur), seq) <= 0) {
+      const std::uint32_t covered = pool_.seq(cur) + pool_.len(cur) - seq;
+      if (covered >= data.size()) return true;
+      data = data.subspan(covered);
+      seq += covered;
+      continue;
+    }
+    std::size_t take = std::min(data.size(), SegmentPool::kBlockSize);
+    if (cur != SegmentPool::kNone) take = std::min<std::size_t>(take, pool_.seq(cur) - seq);
+
+    const std::uint32_t block = pool_.allocate();
+    if (block == SegmentPool::kNone) return false;
+    std::memcpy(pool_.data(block), data.data(), take);
+    pool_.seq(block) = seq;
+    pool_.len(block) = static_cast<std::uint16_t>(take);
+    pool_.next(block) = cur;
+    if (prev == SegmentPool::kNone)
+      segments_[id][dir] = block;
+    else
+      pool_.next(prev) = block;
+    prev = block;
+    buffered_[id] += static_cast<std::uint32_t>(take);
+    buffered_total_ += take;
+    data = data.subspan(take);
+    seq += static_cast<std::uint32_t>(take);
+  }
+  return true;
+}
+
+void FlowTable::drain(FlowId id, Direction dir) {
+  std::uint32_t& head = segments_[id][dir];
+  std::uint32_t& next = next_seq_[id][dir];
+  while (head != SegmentPool::kNone && seq_diff(pool_.seq(head), next) <= 0) {
+    const std::uint32_t block = head;
+    const std::uint32_t len = pool_.len(block);
+    const std::uint32_t skip = next - pool_.seq(block);
+    if (skip < len) {
+      const ByteSpan data(pool_.data(block) + skip, len - skip);
+      if (handler_) handler_->on_data(id, dir, data);
+      stats_.delivered_bytes += data.size();
+      next += len - skip;
+    }
+    head = pool_.next(block);
+    buffered_[id] -= len;
+    buffered_total_ -= len;
+    pool_.release(block);
+  }
+}
+
+void FlowTable::flush(FlowId id, Direction dir) {
+  std::uint32_t& next = next_seq_[id][dir];
+  while (segments_[id][dir] != SegmentPool::kNone) {
+    const std::uint32_t seq = pool_.seq(segments_[id][dir]);
+    if (seq_diff(seq, next) > 0) {
+      ++stats_.gaps;
+      stats_.gap_bytes += seq - next;
+      if (handler_) handler_->on_gap(id, dir, seq - next);
+      next = seq;
+    }
+    drain(id, dir);
+  }
+}
+
+}  // namespace etheros::flow
@@ -0,0 +1,172 @@
+#pragma once
+
+// Connection tracking and TCP reassembly with a fixed memory budget.
+//
+// Layout: a probe index of (tag, flow id) pairs, 8 bytes per slot at a load
+// factor of at most 1/2, points into per-flow state kept as parallel arrays
+// indexed by flow id. A lookup therefore scans packed tags and touches a
+// single key on a hit, and expiry or stats passes walk only the arrays they
+// need. Flow ids are stable for the life of a flow; removal uses backward-shift
+// deletion, so the index never accumulates tombstones.
+//
+// Everything is reserved in the constructor: max_flows bounds the table (new
+// flows beyond it are refused and counted, never allocated), max_flow_buffer
+// bounds how much out-of-order data one flow may hold, and buffer_bytes bounds
+// all of it together (SegmentPool). When a cap is hit, the stream skips ahead
+// and the handler is told about the gap.
+//
+// Idle flows expire through a TimingWheel keyed on capture time, so cost does
+// not grow with the number of flows. Half-open flows (data or SYN from one
+// side only) get a short timeout, which keeps scans from filling the table.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "etheros/common/bytes.hpp"
+#include "etheros/flow/flow_key.hpp"
+#include "etheros/flow/segment_pool.hpp"
+#include "etheros/flow/timing_wheel.hpp"
+#include "etheros/parse/decode.hpp"
+
+namespace etheros::flow {
+
+using FlowId = std::uint32_t;
+inline constexpr FlowId kNoFlow = ~FlowId{0};
+
+// Direction 0 is client to server. The client is the sender of the first SYN,
+// or of the first packet seen if the handshake was missed.
+enum Direction : int { kToServer = 0, kToClient = 1 };
+
+enum class CloseReason { kIdle, kFin, kRst, kShutdown };
+
+struct FlowTableOptions {
+  std::uint32_t max_flows = 128 * 1024;
+  std::size_t buffer_bytes = 8 << 20;
+  std::uint32_t max_flow_buffer = 64 << 10;
+  std::uint32_t tcp_timeout_s = 300;
+  std::uint32_t half_open_timeout_s = 10;
+  std::uint32_t closed_timeout_s = 5;
+  std::uint32_t udp_timeout_s = 60;
+};
+
+struct FlowTableStats {
+  std::uint64_t created = 0;
+  std::uint64_t expired = 0;
+  std::uint64_t closed = 0;
+  std::uint64_t rejected = 0;  // table full
+  std::uint64_t delivered_bytes = 0;
+  std::uint64_t gaps = 0;
+  std::uint64_t gap_bytes = 0;
+};
+
+class StreamHandler {
+ public:
+  virtual ~StreamHandler() = default;
+
+  // In-order TCP payload; data is only valid during the call.
+  virtual void on_data(FlowId, Direction, ByteSpan) {}
+  // The stream skipped `bytes` it never saw, because of capture loss or a
+  // buffer cap.
+  virtual void on_gap(FlowId, Direction, std::uint32_t) {}
+  // The id may be reused once this returns.
+  virtual void on_close(FlowId, CloseReason) {}
+};
+
+class FlowTable {
+ public:
+  explicit FlowTable(const FlowTableOptions& options, StreamHandler* handler = nullptr);
+  ~FlowTable();
+
+  FlowTable(const FlowTable&) = delete;
+  FlowTable& operator=(const FlowTable&) = delete;
+
+  // Tracks one decoded packet and reassembles TCP payload. Returns the flow,
+  // or kNoFlow for non-TCP/UDP packets, a full table or a reset flow.
+  FlowId process(std::uint64_t ts_ns, const parse::DecodedPacket& pkt);
+  FlowId find(const FlowKey& key) const;
+
+  // Expires idle flows up to ts_ns. process() does this as capture time
+  // advances; call it directly when traffic stops.
+  void advance(std::uint64_t ts_ns);
+  // Closes every flow (kShutdown), delivering what is buffered.
+  void clear();
+
+  const FlowKey& key(FlowId id) const { return keys_[id]; }
+  std::uint32_t packets(FlowId id) const { return packets_[id]; }
+  std::uint64_t bytes(FlowId id) const { return bytes_[id]; }
+  bool is_tcp(FlowId id) const { return (flags_[id] & kTcp) != 0; }
+
+  std::size_t size() const { return size_; }
+  std::size_t capacity() const { return keys_.size(); }
+  const FlowTableStats& stats() const { return stats_; }
+  std::size_t buffered_bytes() const { return buffered_total_; }
+
+  // Reserved bytes for tracking state (index, per-flow arrays, wheel), and
+  // for the reassembly pool. Tracking state is zeroed when the table is
+  // created, so all of it is resident; the pool only as blocks are used.
+  std::size_t table_memory_bytes() const;
+  std::size_t buffer_memory_bytes() const { return pool_.memory_bytes(); }
+  // Pool blocks currently holding out-of-order data.
+  std::size_t buffer_memory_in_use() const { return pool_.in_use() * SegmentPool::kBlockSize; }
+
+ private:
+  struct Slot {
+    std::uint32_t tag;  // 0 = empty; low bits give the home slot
+    FlowId id;
+  };
+
+  enum Flag : std::uint16_t {
+    kTcp = 1 << 0,
+    kClientIsB = 1 << 1,
+    kSeen0 = 1 << 2,  // packets seen per direction
+    kSeen1 = 1 << 3,
+    kSeq0 = 1 << 4,   // next_seq_ valid per direction
+    kSeq1 = 1 << 5,
+    kFin0 = 1 << 6,
+    kFin1 = 1 << 7,
+  };
+
+  static std::uint32_t tag_of(std::uint64_t hash) {
+    const auto tag = static_cast<std::uint32_t>(hash >> 32);
+    return tag ? tag : 1;
+  }
+
+  FlowId insert(const FlowKey& key, std::uint32_t tag);
+  void erase_index(FlowId id);
+  void release(FlowId id, CloseReason reason);
+
+  void track_tcp(FlowId id, Direction dir, const parse::DecodedPacket& pkt);
+  void deliver(FlowId id, Direction dir, std::uint32_t seq, ByteSpan data);
+  bool buffer(FlowId id, Direction dir, std::uint32_t seq, ByteSpan data);
+  void drain(FlowId id, Direction dir);
+  void flush(FlowId id, Direction dir);
+  std::uint32_t timeout_s(FlowId id) const;
+
+  FlowTableOptions options_;
+  StreamHandler* handler_;
+
+  std::vector<Slot> index_;
+  std::uint32_t mask_;
+
+  // Per-flow state, indexed by FlowId.
+  std::vector<FlowKey> keys_;
+  std::vector<std::uint32_t> expires_;
+  std::vector<std::uint16_t> flags_;
+  std::vector<std::uint32_t> packets_;
+  std::vector<std::uint64_t> bytes_;
+  std::vector<std::array<std::uint32_t, 2>> next_seq_;
+  std::vector<std::array<std::uint32_t, 2>> segments_;  // SegmentPool list heads
+  std::vector<std::uint32_t> buffered_;
+
+  std::vector<FlowId> free_;
+  std::size_t size_ = 0;
+
+  TimingWheel wheel_;
+  SegmentPool pool_;
+  std::size_t buffered_total_ = 0;
+  FlowTableStats stats_;
+};
+
+}  // namespace etheros::flow
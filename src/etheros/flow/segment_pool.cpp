@@ -0,0 +1,37 @@
+#include "etheros/flow/segment_pool.hpp"
+
+namespace etheros::flow {
+
+SegmentPool::SegmentPool(std::size_t max_bytes) {
+  const std::size_t blocks = max_bytes / kBlockSize;
+  // Deliberately not value-initialised: untouched blocks cost no RSS.
+  arena_.reset(new std::uint8_t[blocks * kBlockSize]);
+  next_.resize(blocks);
+  seq_.resize(blocks);
+  len_.resize(blocks);
+  for (std::size_t i = blocks; i-- > 0;) {
+    next_[i] = free_;
+    free_ = static_cast<std::uint32_t>(i);
+  }
+}
+
+std::uint32_t SegmentPool::allocate() {
+  const std::uint32_t block = free_;
+  if (block == kNone) return kNone;
+  free_ = next_[block];
+  next_[block] = kNone;
+  ++in_use_;
+  return block;
+}
+
+void SegmentPool::release(std::uint32_t block) {
+  next_[block] = free_;
+  free_ = block;
+  --in_use_;
+}
+
+std::size_t SegmentPool::memory_bytes() const {
+  return capacity() * (kBlockSize + sizeof(std::uint32_t) * 2 + sizeof(std::uint16_t));
+}
+
+}  // namespace etheros::flow
@@ -0,0 +1,48 @@
+#pragma once
+
+// Fixed arena of small blocks that hold out-of-order TCP data until the gap
+// before it is filled. The arena is reserved once, so its size is the global
+// cap on reassembly memory; pages are only touched as blocks are first used,
+// and the LIFO free list keeps reuse on the same warm pages.
+//
+// Each block carries its own sequence number and length, so a segment larger
+// than a block is simply a run of consecutive blocks in a flow's list.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace etheros::flow {
+
+class SegmentPool {
+ public:
+  static constexpr std::uint32_t kNone = ~std::uint32_t{0};
+  static constexpr std::size_t kBlockSize = 256;
+
+  explicit SegmentPool(std::size_t max_bytes);
+
+  // Returns kNone when the pool is exhausted.
+  std::uint32_t allocate();
+  void release(std::uint32_t block);
+
+  std::uint8_t* data(std::uint32_t block) { return arena_.get() + std::size_t{block} * kBlockSize; }
+  std::uint32_t& next(std::uint32_t block) { return next_[block]; }
+  std::uint32_t& seq(std::uint32_t block) { return seq_[block]; }
+  std::uint16_t& len(std::uint32_t block) { return len_[block]; }
+
+  std::size_t capacity() const { return next_.size(); }
+  std::size_t in_use() const { return in_use_; }
+  // Reserved bytes: arena plus per-block headers.
+  std::size_t memory_bytes() const;
+
+ private:
+  std::unique_ptr<std::uint8_t[]> arena_;
+  std::vector<std::uint32_t> next_;  // list link while in use, free list otherwise
+  std::vector<std::uint32_t> seq_;
+  std::vector<std::uint16_t> len_;
+  std::uint32_t free_ = kNone;
+  std::size_t in_use_ = 0;
+};
+
+}  // namespace etheros::flow
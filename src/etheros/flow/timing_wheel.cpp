@@ -0,0 +1,36 @@
+#include "etheros/flow/timing_wheel.hpp"
+
+#include <bit>
+
+namespace etheros::flow {
+
+TimingWheel::TimingWheel(std::uint32_t capacity, std::uint32_t slots)
+    : heads_(std::bit_ceil(slots < 2 ? 2u : slots), kNone),
+      next_(capacity, kNone),
+      prev_(capacity, kNone),
+      mask_(static_cast<std::uint32_t>(heads_.size()) - 1) {}
+
+void TimingWheel::schedule(std::uint32_t id, std::uint32_t tick) {
+  // Already-due deadlines go in the next slot to fire.
+  const std::uint32_t slot = (tick > now_ ? tick : now_ + 1) & mask_;
+  const std::uint32_t head = heads_[slot];
+  next_[id] = head;
+  prev_[id] = kHeadBit | slot;
+  if (head != kNone) prev_[head] = id;
+  heads_[slot] = id;
+}
+
+void TimingWheel::cancel(std::uint32_t id) {
+  const std::uint32_t prev = prev_[id];
+  if (prev == kNone) return;
+  const std::uint32_t next = next_[id];
+  if (prev & kHeadBit)
+    heads_[prev & ~kHeadBit] = next;
+  else
+    next_[prev] = next;
+  if (next != kNone) prev_[next] = prev;
+  prev_[id] = kNone;
+  next_[id] = kNone;
+}
+
+}  // namespace etheros::flow
@@ -0,0 +1,76 @@
+#pragma once
+
+// Hashed timing wheel over dense ids with one-second ticks. Scheduling,
+// cancelling and firing are O(1); the lists are intrusive arrays indexed by
+// id, so the wheel costs 8 bytes per id plus 4 per slot.
+//
+// Intended for lazy expiry: callers record deadlines in their own state and
+// schedule once; when an id fires early (its deadline moved) the callback
+// simply schedules it again. A busy flow therefore costs one reschedule per
+// timeout period instead of a list update per packet.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace etheros::flow {
+
+class TimingWheel {
+ public:
+  static constexpr std::uint32_t kNone = ~std::uint32_t{0};
+
+  // slots is rounded up to a power of two; deadlines further out than that
+  // fire early and must be rescheduled by the callback.
+  TimingWheel(std::uint32_t capacity, std::uint32_t slots);
+
+  // id must not already be scheduled.
+  void schedule(std::uint32_t id, std::uint32_t tick);
+  // No-op if id is not scheduled.
+  void cancel(std::uint32_t id);
+  bool scheduled(std::uint32_t id) const { return prev_[id] != kNone; }
+
+  std::uint32_t now() const { return now_; }
+
+  // Moves time forward to `now`, calling fn(id) for every id in the slots
+  // passed. Each id is unscheduled before fn sees it; fn may schedule it (or
+  // any other id) again.
+  template <typename Fn>
+  void advance(std::uint32_t now, Fn&& fn) {
+    if (!started_) {
+      now_ = now;
+      started_ = true;
+      return;
+    }
+    if (now <= now_) return;
+    // After a long pause every slot is visited once; nothing is skipped.
+    const std::uint32_t steps = std::min<std::uint32_t>(now - now_, mask_ + 1);
+    for (std::uint32_t i = 1; i <= steps; ++i) {
+      const std::uint32_t slot = (now_ + i) & mask_;
+      std::uint32_t id = heads_[slot];
+      heads_[slot] = kNone;
+      while (id != kNone) {
+        const std::uint32_t next = next_[id];
+        prev_[id] = kNone;
+        fn(id);
+        id = next;
+      }
+    }
+    now_ = now;
+  }
+
+  std::size_t memory_bytes() const { return (heads_.size() + next_.size() + prev_.size()) * sizeof(std::uint32_t); }
+
+ private:
+  // prev_ of a list head encodes its slot so cancel() can fix the head.
+  static constexpr std::uint32_t kHeadBit = 0x80000000u;
+
+  std::vector<std::uint32_t> heads_;
+  std::vector<std::uint32_t> next_;
+  std::vector<std::uint32_t> prev_;
+  std::uint32_t mask_;
+  std::uint32_t now_ = 0;
+  bool started_ = false;
+};
+
+}  // namespace etheros::flow
@@ -0,0 +1,82 @@
+#include "etheros/io/fd_writer.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <utility>
+
+namespace etheros::io {
+
+FdWriter::FdWriter(int fd, std::size_t buffer_size) : fd_(fd), buffer_(buffer_size) {}
+
+FdWriter FdWriter::open(const std::string& path, bool append, std::size_t buffer_size) {
+  int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC);
+  int fd = ::open(path.c_str(), flags, 0644);
+  if (fd < 0) throw std::system_error(errno, std::generic_category(), "open " + path);
+  return FdWriter(fd, buffer_size);
+}
+
+FdWriter::~FdWriter() {
+  // Destructors must not throw; callers that care about errors close() first.
+  try {
+    close();
+  } catch (...) {
+  }
+}
+
+FdWriter::FdWriter(FdWriter&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1)),
+      buffer_(std::move(other.buffer_)),
+      used_(std::exchange(other.used_, 0)),
+      bytes_written_(other.bytes_written_) {}
+
+void FdWriter::write(ByteSpan data) {
+  bytes_written_ += data.size();
+  if (used_ + data.size() <= buffer_.size()) {
+    std::memcpy(buffer_.data() + used_, data.data(), data.size());
+    used_ += data.size();
+    return;
+  }
+  flush();
+  if (data.size() >= buffer_.size()) {
+    write_all(data.data(), data.size());
+  } else {
+    std::memcpy(buffer_.data(), data.data(), data.size());
+    used_ = data.size();
+  }
+}
+
+void FdWriter::flush() {
+  if (used_ == 0) return;
+  write_all(buffer_.data(), used_);
+  used_ = 0;
+}
+
+void FdWriter::sync() {
+  flush();
+  if (fd_ >= 0 && ::fdatasync(fd_) != 0)
+    throw std::system_error(errno, std::generic_category(), "fdatasync");
+}
+
+void FdWriter::close() {
+  if (fd_ < 0) return;
+  flush();
+  ::close(std::exchange(fd_, -1));
+}
+
+void FdWriter::write_all(const std::uint8_t* data, std::size_t size) {
+  while (size > 0) {
+    ssize_t n = ::write(fd_, data, size);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      throw std::system_error(errno, std::generic_category(), "write");
+    }
+    data += n;
+    size -= static_cast<std::size_t>(n);
+  }
+}
+
+}  // namespace etheros::io
@@ -0,0 +1,54 @@
+#pragma once
+
+// Buffered writer over a raw file descriptor. Output is coalesced into
+// fixed-size blocks so the SD card sees few, large writes.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "etheros/common/bytes.hpp"
+
+namespace etheros::io {
+
+class FdWriter {
+ public:
+  static constexpr std::size_t kDefaultBufferSize = 64 * 1024;
+
+  // Takes ownership of fd.
+  explicit FdWriter(int fd, std::size_t buffer_size = kDefaultBufferSize);
+  // Opens (creating or truncating) path. Throws std::system_error on failure.
+  static FdWriter open(const std::string& path, bool append = false,
+                       std::size_t buffer_size = kDefaultBufferSize);
+  ~FdWriter();
+
+  FdWriter(FdWriter&& other) noexcept;
+  FdWriter& operator=(FdWriter&&) = delete;
+  FdWriter(const FdWriter&) = delete;
+  FdWriter& operator=(const FdWriter&) = delete;
+
+  void write(ByteSpan data);
+  void write(std::string_view text) {
+    write(ByteSpan(reinterpret_cast<const std::uint8_t*>(text.data()), text.size()));
+  }
+
+  // Pushes buffered bytes to the kernel. Throws std::system_error on failure.
+  void flush();
+  // flush() followed by fdatasync().
+  void sync();
+  void close();
+
+  std::uint64_t bytes_written() const { return bytes_written_; }
+
+ private:
+  void write_all(const std::uint8_t* data, std::size_t size);
+
+  int fd_ = -1;
+  std::vector<std::uint8_t> buffer_;
+  std::size_t used_ = 0;
+  std::uint64_t bytes_written_ = 0;
+};
+
+}  // namespace etheros::io
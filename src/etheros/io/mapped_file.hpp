@@ -0,0 +1,37 @@
+#pragma once
+
+// Read-only memory mapping of a file. Capture replays and wordlists are
+// consumed straight out of the page cache instead of being copied into heap
+// buffers, which matters with 512MB of RAM.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "etheros/common/bytes.hpp"
+
+namespace etheros::io {
+
+class MappedFile {
+ public:
+  MappedFile() = default;
+  // Throws std::system_error if the file cannot be opened or mapped.
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ByteSpan bytes() const { return {data_, size_}; }
+  std::size_t size() const { return size_; }
+
+ private:
+  void reset();
+
+  const std::uint8_t* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+}  // namespace etheros::io
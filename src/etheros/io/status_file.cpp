@@ -0,0 +1,120 @@
+#include "etheros/io/status_file.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+
+#include "etheros/io/fd_writer.hpp"
+
+namespace etheros::io {
+
+namespace {
+
+// mkdir -p for everything before the last slash.
+void make_parent_dirs(const std::string& path, std::size_t end) {
+  for (std::size_t slash = path.find('/', 1); slash != std::string::npos && slash < end;
+       slash = path.find('/', slash + 1)) {
+    const std::string dir = path.substr(0, slash);
+    if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+      throw std::system_error(errno, std::generic_category(), "mkdir " + dir);
+  }
+}
+
+}  // namespace
+
+void write_status_file(const std::string& path, const StatusFields& fields) {
+  // Dot-prefixed so a reader listing the directory skips it.
+  const std::size_t slash = path.rfind('/');
+  const std::size_t base = slash == std::string::npos ? 0 : slash + 1;
+  if (slash != std::string::npos) make_parent_dirs(path, slash + 1);
+  const std::string tmp = path.substr(0, base) + "." + path.substr(base) + ".tmp";
+  {
+    FdWriter out = FdWriter::open(tmp, false, 4096);
+    for (const auto& [key, value] : fields) {
+      out.write(key);
+      out.write(" ");
+      out.write(value);
+      out.write("\n");
+    }
+    out.close();
+  }
+  if (::rename(tmp.c_str(), path.c_str()) != 0)
+    throw std::system_error(errno, std::generic_category(), "rename " + tmp);
+}
+
+StatusReader::StatusReader(std::string path) : path_(std::move(path)), buffer_(4096) {}
+
+void StatusReader::rescan() {
+  files_.clear();
+  DIR* dir = ::opendir(path_.c_str());
+  if (!dir) {
+    // Not a directory: a single status file.
+    if (errno == ENOTDIR) files_.push_back(path_);
+    return;
+  }
+  while (const dirent* e = ::readdir(dir)) {
+    if (e->d_name[0] == '.') continue;
+    files_.push_back(path_ + "/" + e->d_name);
+  }
+  ::closedir(dir);
+  // Stable order, so a key published by two producers resolves the same way
+  // every frame.
+  std::sort(files_.begin(), files_.end());
+}
+
+bool StatusReader::append_file(const std::string& path) {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+  for (;;) {
+    if (used_ == buffer_.size()) buffer_.resize(buffer_.size() * 2);
+    const ssize_t n = ::read(fd, buffer_.data() + used_, buffer_.size() - used_);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+    used_ += static_cast<std::size_t>(n);
+  }
+  ::close(fd);
+  // Terminate a last line without a newline so files cannot run together.
+  if (used_ == buffer_.size()) buffer_.resize(buffer_.size() * 2);
+  buffer_[used_++] = '\n';
+  return true;
+}
+
+bool StatusReader::read() {
+  if (reads_++ % kRescanInterval == 0) rescan();
+  used_ = 0;
+  bool any = false, missing = false;
+  for (const std::string& file : files_) {
+    if (append_file(file))
+      any = true;
+    else
+      missing = true;
+  }
+  // A producer went away, or none has appeared yet: list again next time.
+  if (missing || files_.empty()) reads_ = 0;
+
+  // Views are taken only now, after the buffer has stopped growing.
+  fields_.clear();
+  const std::string_view text(buffer_.data(), used_);
+  for (std::size_t pos = 0; pos < text.size();) {
+    std::size_t end = text.find('\n', pos);
+    if (end == std::string_view::npos) end = text.size();
+    const std::string_view line = text.substr(pos, end - pos);
+    const std::size_t sp = line.find(' ');
+    if (sp != std::string_view::npos) fields_.emplace_back(line.substr(0, sp), line.substr(sp + 1));
+    pos = end + 1;
+  }
+  return any;
+}
+
+std::string_view StatusReader::value(std::string_view key) const {
+  for (const auto& [k, v] : fields_)
+    if (k == key) return v;
+  return {};
+}
+
+}  // namespace etheros::io
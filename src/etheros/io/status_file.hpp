@@ -0,0 +1,56 @@
+#pragma once
+
+// Tiny "key value" status files that long-running tools publish for the
+// dashboard. Each producer owns one file in a shared directory (by default
+// /run/etheros/status.d/<tool>), so producers never overwrite each other's
+// keys. Writers replace their file atomically, so a reader never sees a
+// half-written update.
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace etheros::io {
+
+inline constexpr const char* kDefaultStatusDir = "/run/etheros/status.d";
+
+using StatusFields = std::vector<std::pair<std::string, std::string>>;
+
+// Writes a hidden temporary next to path and renames it over path, creating
+// missing parent directories first (/run is empty after every boot). Throws
+// std::system_error. The file lives on tmpfs in normal use, so it is not
+// fsync'd.
+void write_status_file(const std::string& path, const StatusFields& fields);
+
+// Reads every producer's file in a status directory, or a single status file,
+// and merges the keys. Lines are "key value..."; the value is the rest of the
+// line. Buffers are reused, so once they have grown to fit, reading every
+// frame does not allocate. The directory is re-listed every few reads to pick
+// up producers that appear or go away.
+class StatusReader {
+ public:
+  explicit StatusReader(std::string path);
+
+  // Returns false if nothing could be read.
+  bool read();
+  // Value for key from the first producer that has it, or an empty view.
+  // Valid until the next read().
+  std::string_view value(std::string_view key) const;
+
+ private:
+  static constexpr std::uint32_t kRescanInterval = 16;
+
+  void rescan();
+  bool append_file(const std::string& path);
+
+  std::string path_;
+  std::vector<std::string> files_;
+  std::uint32_t reads_ = 0;
+  std::vector<char> buffer_;
+  std::size_t used_ = 0;
+  std::vector<std::pair<std::string_view, std::string_view>> fields_;
+};
+
+}  // namespace etheros::io
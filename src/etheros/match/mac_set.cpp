@@ -0,0 +1,45 @@
+#include "etheros/match/mac_set.hpp"
+
+#include <bit>
+#include <utility>
+
+namespace etheros::match {
+
+MacSet::MacSet(std::size_t expected) {
+  const std::size_t capacity = std::bit_ceil(expected < 8 ? std::size_t{16} : expected * 2);
+  slots_.assign(capacity, kEmpty);
+  mask_ = capacity - 1;
+}
+
+bool MacSet::insert(const MacAddress& mac) {
+  if ((size_ + 1) * 4 > slots_.size() * 3) grow();
+  const std::uint64_t key = mac.to_u64();
+  for (std::size_t i = hash(key) & mask_;; i = (i + 1) & mask_) {
+    if (slots_[i] == key) return false;
+    if (slots_[i] == kEmpty) {
+      slots_[i] = key;
+      ++size_;
+      return true;
+    }
+  }
+}
+
+bool MacSet::contains(std::uint64_t key) const {
+  for (std::size_t i = hash(key) & mask_;; i = (i + 1) & mask_) {
+    if (slots_[i] == key) return true;
+    if (slots_[i] == kEmpty) return false;
+  }
+}
+
+void MacSet::grow() {
+  std::vector<std::uint64_t> old = std::exchange(slots_, std::vector<std::uint64_t>(slots_.size() * 2, kEmpty));
+  mask_ = slots_.size() - 1;
+  for (std::uint64_t key : old) {
+    if (key == kEmpty) continue;
+    std::size_t i = hash(key) & mask_;
+    while (slots_[i] != kEmpty) i = (i + 1) & mask_;
+    slots_[i] = key;
+  }
+}
+
+}  // namespace etheros::match
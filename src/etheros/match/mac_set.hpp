@@ -0,0 +1,42 @@
+#pragma once
+
+// Open-addressing set of MAC addresses for target/ignore lists. Addresses are
+// packed into 48-bit keys in one flat array so a lookup touches a single cache
+// line in the common case.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "etheros/common/bytes.hpp"
+
+namespace etheros::match {
+
+class MacSet {
+ public:
+  explicit MacSet(std::size_t expected = 16);
+
+  // Returns false if the address was already present.
+  bool insert(const MacAddress& mac);
+  bool contains(const MacAddress& mac) const { return contains(mac.to_u64()); }
+  bool contains(std::uint64_t key) const;
+
+  std::size_t size() const { return size_; }
+
+ private:
+  // Keys are at most 48 bits wide, so all-ones can never be a real address.
+  static constexpr std::uint64_t kEmpty = ~std::uint64_t{0};
+
+  static std::size_t hash(std::uint64_t key) {
+    // Low OUI bits are poorly distributed; mix before masking.
+    key *= 0x9e3779b97f4a7c15ull;
+    return static_cast<std::size_t>(key >> 32);
+  }
+  void grow();
+
+  std::vector<std::uint64_t> slots_;
+  std::size_t mask_ = 0;
+  std::size_t size_ = 0;
+};
+
+}  // namespace etheros::match
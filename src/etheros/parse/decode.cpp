@@ -0,0 +1,225 @@
+#include "etheros/parse/decode.hpp"
+
+namespace etheros::parse {
+
+namespace {
+
+constexpr std::uint16_t kEtherTypeIpv4 = 0x0800;
+constexpr std::uint16_t kEtherTypeIpv6 = 0x86dd;
+constexpr std::uint16_t kEtherTypeVlan = 0x8100;
+constexpr std::uint16_t kEtherTypeQinQ = 0x88a8;
+constexpr std::uint16_t kEtherTypeEapol = 0x888e;
+
+constexpr std::uint8_t kProtoTcp = 6;
+constexpr std::uint8_t kProtoUdp = 17;
+
+void decode_l4(ByteSpan seg, DecodedPacket& out) {
+  if (out.ip_proto == kProtoTcp) {
+    if (seg.size() < 20) return;
+    const std::size_t hlen = static_cast<std::size_t>(seg[12] >> 4) * 4;
+    if (hlen < 20 || hlen > seg.size()) return;
+    out.src_port = load_be16(seg.data());
+    out.dst_port = load_be16(seg.data() + 2);
+    out.tcp_seq = load_be32(seg.data() + 4);
+    out.tcp_ack = load_be32(seg.data() + 8);
+    out.tcp_flags = seg[13];
+    out.tcp_window = load_be16(seg.data() + 14);
+    out.payload = seg.subspan(hlen);
+    out.layers |= kLayerTcp;
+  } else if (out.ip_proto == kProtoUdp) {
+    if (seg.size() < 8) return;
+    const std::size_t len = load_be16(seg.data() + 4);
+    if (len < 8) return;
+    out.src_port = load_be16(seg.data());
+    out.dst_port = load_be16(seg.data() + 2);
+    out.payload = seg.subspan(8, (len <= seg.size() ? len : seg.size()) - 8);
+    out.layers |= kLayerUdp;
+  }
+}
+
+void decode_ipv4(ByteSpan pkt, DecodedPacket& out) {
+  if (pkt.size() < 20 || (pkt[0] >> 4) != 4) return;
+  const std::size_t ihl = static_cast<std::size_t>(pkt[0] & 0x0f) * 4;
+  std::size_t total = load_be16(pkt.data() + 2);
+  if (ihl < 20 || total < ihl || ihl > pkt.size()) return;
+  if (total > pkt.size()) total = pkt.size();  // snaplen cut
+
+  out.ip_version = 4;
+  out.ttl = pkt[8];
+  out.ip_proto = pkt[9];
+  out.src_ip = IpAddress::from_v4(pkt.data() + 12);
+  out.dst_ip = IpAddress::from_v4(pkt.data() + 16);
+  out.payload = pkt.subspan(ihl, total - ihl);
+  out.layers |= kLayerIp;
+
+  // Non-first fragments carry no L4 header.
+  if ((load_be16(pkt.data() + 6) & 0x1fff) != 0) return;
+  decode_l4(out.payload, out);
+}
+
+void decode_ipv6(ByteSpan pkt, DecodedPacket& out) {
+  if (pkt.size() < 40 || (pkt[0] >> 4) != 6) return;
+  std::size_t end = 40 + std::size_t{load_be16(pkt.data() + 4)};
+  if (end > pkt.size()) end = pkt.size();
+
+  out.ip_version = 6;
+  out.ttl = pkt[7];
+  out.src_ip = IpAddress::from_v6(pkt.data() + 8);
+  out.dst_ip = IpAddress::from_v6(pkt.data() + 24);
+  out.layers |= kLayerIp;
+
+  std::uint8_t next = pkt[6];
+  std::size_t off = 40;
+  for (;;) {
+    if (next == 0 || next == 43 || next == 60) {  // hop-by-hop, routing, dst opts
+      if (off + 8 > end) return;
+      const std::uint8_t following = pkt[off];
+      off += (std::size_t{pkt[off + 1]} + 1) * 8;
+      next = following;
+    } else if (next == 44) {  // fragment
+      if (off + 8 > end) return;
+      const bool first = (load_be16(pkt.data() + off + 2) & 0xfff8) == 0;
+      next = pkt[off];
+      off += 8;
+      if (!first) return;
+    } else {
+      break;
+    }
+  }
+  if (off > end) return;
+  out.ip_proto = next;
+  out.payload = pkt.subspan(off, end - off);
+  decode_l4(out.payload, out);
+}
+
+void decode_ethertype(std::uint16_t ethertype, ByteSpan pkt, DecodedPacket& out) {
+  out.ethertype = ethertype;
+  switch (ethertype) {
+    case kEtherTypeIpv4:
+      decode_ipv4(pkt, out);
+      break;
+    case kEtherTypeIpv6:
+      decode_ipv6(pkt, out);
+      break;
+    case kEtherTypeEapol:
+      out.payload = pkt;
+      out.layers |= kLayerEapol;
+      break;
+    default:
+      out.payload = pkt;
+      break;
+  }
+}
+
+bool decode_ethernet(ByteSpan frame, DecodedPacket& out) {
+  if (frame.size() < 14) return false;
+  out.dst_mac = MacAddress::from(frame.data());
+  out.src_mac = MacAddress::from(frame.data() + 6);
+  out.layers |= kLayerL2;
+
+  std::size_t off = 12;
+  std::uint16_t ethertype = load_be16(frame.data() + off);
+  while ((ethertype == kEtherTypeVlan || ethertype == kEtherTypeQinQ) && off + 6 <= frame.size()) {
+    off += 4;
+    ethertype = load_be16(frame.data() + off);
+  }
+  decode_ethertype(ethertype, frame.subspan(off + 2), out);
+  return true;
+}
+
+bool decode_80211(ByteSpan frame, DecodedPacket& out) {
+  if (frame.size() < 24) return false;
+  const std::uint16_t fc = load_le16(frame.data());
+  const std::uint8_t flags = static_cast<std::uint8_t>(fc >> 8);
+  const bool to_ds = flags & 0x01;
+  const bool from_ds = flags & 0x02;
+  out.wifi_type = (fc >> 2) & 0x3;
+  out.wifi_subtype = (fc >> 4) & 0xf;
+  out.layers |= kLayerL2;
+
+  const std::uint8_t* a1 = frame.data() + 4;
+  const std::uint8_t* a2 = frame.data() + 10;
+  const std::uint8_t* a3 = frame.data() + 16;
+  std::size_t hdr = 24;
+
+  if (out.wifi_type == 0) {
+    out.dst_mac = MacAddress::from(a1);
+    out.src_mac = MacAddress::from(a2);
+    out.bssid = MacAddress::from(a3);
+    out.payload = frame.subspan(hdr);
+    out.layers |= kLayerWifiMgmt;
+    return true;
+  }
+  if (out.wifi_type != 2) return true;
+
+  if (to_ds && from_ds) {
+    hdr += 6;
+    if (frame.size() < hdr) return true;
+    out.dst_mac = MacAddress::from(a3);
+    out.src_mac = MacAddress::from(frame.data() + 24);
+    out.bssid = MacAddress::from(a2);
+  } else if (to_ds) {
+    out.bssid = MacAddress::from(a1);
+    out.src_mac = MacAddress::from(a2);
+    out.dst_mac = MacAddress::from(a3);
+  } else if (from_ds) {
+    out.dst_mac = MacAddress::from(a1);
+    out.bssid = MacAddress::from(a2);
+    out.src_mac = MacAddress::from(a3);
+  } else {
+    out.dst_mac = MacAddress::from(a1);
+    out.src_mac = MacAddress::from(a2);
+    out.bssid = MacAddress::from(a3);
+  }
+  if (out.wifi_subtype & 0x8) hdr += 2;  // QoS control
+  if (flags & 0x40) return true;         // protected; nothing more to see
+  if (frame.size() < hdr + 8) return true;
+
+  static constexpr std::uint8_t kSnap[6] = {0xaa, 0xaa, 0x03, 0x00, 0x00, 0x00};
+  const std::uint8_t* llc = frame.data() + hdr;
+  for (int i = 0; i < 6; ++i)
+    if (llc[i] != kSnap[i]) return true;
+  decode_ethertype(load_be16(llc + 6), frame.subspan(hdr + 8), out);
+  return true;
+}
+
+bool decode_radiotap(ByteSpan frame, DecodedPacket& out) {
+  if (frame.size() < 8 || frame[0] != 0) return false;
+  const std::size_t len = load_le16(frame.data() + 2);
+  if (len < 8 || len > frame.size()) return false;
+
+  // Find the Flags field to learn whether the frame carries a trailing FCS.
+  // It follows TSFT (8 bytes, 8-aligned), which is the only field before it.
+  std::size_t off = 4;
+  std::uint32_t present = load_le32(frame.data() + off);
+  const std::uint32_t first = present;
+  while ((present & 0x80000000u) && off + 8 <= len) {
+    off += 4;
+    present = load_le32(frame.data() + off);
+  }
+  off += 4;
+  bool has_fcs = false;
+  if (first & 0x1) off = ((off + 7) & ~std::size_t{7}) + 8;
+  if ((first & 0x2) && off < len) has_fcs = frame[off] & 0x10;
+
+  ByteSpan body = frame.subspan(len);
+  if (has_fcs && body.size() >= 4) body = body.first(body.size() - 4);
+  return decode_80211(body, out);
+}
+
+}  // namespace
+
+bool decode(capture::LinkType link_type, ByteSpan frame, DecodedPacket& out) {
+  out = DecodedPacket{};
+  switch (link_type) {
+    case capture::LinkType::kEthernet:
+      return decode_ethernet(frame, out);
+    case capture::LinkType::kIeee80211:
+      return decode_80211(frame, out);
+    case capture::LinkType::kRadiotap:
+      return decode_radiotap(frame, out);
+  }
+  return false;
+}
+
+}  // namespace etheros::parse
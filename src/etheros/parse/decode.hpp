@@ -0,0 +1,68 @@
+#pragma once
+
+// Single-pass, allocation-free decoder from a captured frame to its L2-L4
+// fields. Only the headers the analysis stages care about are decoded; the
+// rest is left as a borrowed payload span.
+
+#include <cstdint>
+
+#include "etheros/capture/packet.hpp"
+#include "etheros/common/bytes.hpp"
+
+namespace etheros::parse {
+
+enum Layer : std::uint32_t {
+  kLayerL2 = 1u << 0,
+  kLayerIp = 1u << 1,
+  kLayerTcp = 1u << 2,
+  kLayerUdp = 1u << 3,
+  kLayerWifiMgmt = 1u << 4,
+  kLayerEapol = 1u << 5,
+};
+
+enum TcpFlag : std::uint8_t {
+  kTcpFin = 0x01,
+  kTcpSyn = 0x02,
+  kTcpRst = 0x04,
+  kTcpPsh = 0x08,
+  kTcpAck = 0x10,
+};
+
+struct DecodedPacket {
+  std::uint32_t layers = 0;
+
+  // Ethernet, or the DA/SA resolved from the 802.11 DS bits.
+  MacAddress src_mac;
+  MacAddress dst_mac;
+  std::uint16_t ethertype = 0;
+
+  // 802.11 only.
+  MacAddress bssid;
+  std::uint8_t wifi_type = 0;
+  std::uint8_t wifi_subtype = 0;
+
+  std::uint8_t ip_version = 0;
+  std::uint8_t ip_proto = 0;
+  std::uint8_t ttl = 0;
+  IpAddress src_ip;
+  IpAddress dst_ip;
+
+  std::uint16_t src_port = 0;
+  std::uint16_t dst_port = 0;
+  std::uint32_t tcp_seq = 0;
+  std::uint32_t tcp_ack = 0;
+  std::uint16_t tcp_window = 0;
+  std::uint8_t tcp_flags = 0;
+
+  // L4 payload for TCP/UDP, the EAPOL frame for kLayerEapol, or the frame body
+  // for 802.11 management frames.
+  ByteSpan payload;
+
+  bool has(Layer l) const { return (layers & l) != 0; }
+};
+
+// Decodes as far as the frame allows. Returns false only if not even the
+// link-layer header could be decoded; `out` is reset on every call.
+bool decode(capture::LinkType link_type, ByteSpan frame, DecodedPacket& out);
+
+}  // namespace etheros::parse
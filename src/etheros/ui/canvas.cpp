@@ -0,0 +1,59 @@
+#include "etheros/ui/canvas.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "etheros/ui/font.hpp"
+
+namespace etheros::ui {
+
+Canvas::Canvas(const Surface& surface) : surface_(surface), row_(static_cast<std::size_t>(surface.width)) {}
+
+void Canvas::store_row(int x, int y, const std::uint32_t* packed, int count) {
+  std::uint8_t* dst = surface_.pixels + static_cast<std::size_t>(y) * surface_.stride;
+  if (surface_.format == PixelFormat::kRgb565) {
+    auto* p = reinterpret_cast<std::uint16_t*>(dst) + x;
+    for (int i = 0; i < count; ++i) p[i] = static_cast<std::uint16_t>(packed[i]);
+  } else {
+    std::memcpy(reinterpret_cast<std::uint32_t*>(dst) + x, packed, static_cast<std::size_t>(count) * 4);
+  }
+}
+
+void Canvas::fill(Rect r, Color c) {
+  r = r.intersect(surface_.bounds());
+  if (r.empty()) return;
+  std::fill_n(row_.begin(), r.w, pack(surface_.format, c));
+  for (int y = r.y; y < r.bottom(); ++y) store_row(r.x, y, row_.data(), r.w);
+  pixels_written_ += static_cast<std::uint64_t>(r.area());
+  dirty_.add(r);
+}
+
+void Canvas::text(int x, int y, std::string_view s, int scale, Color fg, Color bg) {
+  const int cell_w = kCellWidth * scale;
+  const Rect box{x, y, static_cast<int>(s.size()) * cell_w, kCellHeight * scale};
+  const Rect clip = box.intersect(surface_.bounds());
+  if (clip.empty()) return;
+
+  const std::uint32_t pfg = pack(surface_.format, fg);
+  const std::uint32_t pbg = pack(surface_.format, bg);
+
+  // Build each glyph row once per text line and replicate it `scale` times.
+  for (int gy = 0; gy < kCellHeight; ++gy) {
+    const int y0 = y + gy * scale;
+    if (y0 + scale <= clip.y || y0 >= clip.bottom()) continue;
+
+    for (int px = clip.x; px < clip.right(); ++px) {
+      const int cx = (px - x) / scale;
+      const int col = cx % kCellWidth;
+      bool on = false;
+      if (col < kGlyphWidth && gy < kGlyphHeight) on = (glyph(s[static_cast<std::size_t>(cx / kCellWidth)])[col] >> gy) & 1;
+      row_[static_cast<std::size_t>(px - clip.x)] = on ? pfg : pbg;
+    }
+    for (int yy = std::max(y0, clip.y); yy < std::min(y0 + scale, clip.bottom()); ++yy)
+      store_row(clip.x, yy, row_.data(), clip.w);
+  }
+  pixels_written_ += static_cast<std::uint64_t>(clip.area());
+  dirty_.add(clip);
+}
+
+}  // namespace etheros::ui
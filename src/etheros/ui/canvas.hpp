@@ -0,0 +1,40 @@
+#pragma once
+
+// Immediate-mode drawing onto a Surface. Every primitive clips to the surface
+// and records what it touched in dirty(), so the caller can tell the display
+// exactly which regions changed this frame.
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "etheros/ui/dirty_region.hpp"
+#include "etheros/ui/surface.hpp"
+
+namespace etheros::ui {
+
+class Canvas {
+ public:
+  explicit Canvas(const Surface& surface);
+
+  int width() const { return surface_.width; }
+  int height() const { return surface_.height; }
+
+  void fill(Rect r, Color c);
+  // Draws s on a solid background, one (6*scale)x(8*scale) cell per char.
+  void text(int x, int y, std::string_view s, int scale, Color fg, Color bg);
+
+  DirtyRegion& dirty() { return dirty_; }
+  // Number of pixels written since construction; the benchmark reports it.
+  std::uint64_t pixels_written() const { return pixels_written_; }
+
+ private:
+  void store_row(int x, int y, const std::uint32_t* packed, int count);
+
+  Surface surface_;
+  DirtyRegion dirty_;
+  std::vector<std::uint32_t> row_;  // scratch for one row of packed pixels
+  std::uint64_t pixels_written_ = 0;
+};
+
+}  // namespace etheros::ui
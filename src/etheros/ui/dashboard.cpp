@@ -0,0 +1,97 @@
+#include "etheros/ui/dashboard.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+#include "etheros/ui/font.hpp"
+
+namespace etheros::ui {
+
+namespace {
+
+constexpr Color kBackground = 0x101418;
+constexpr Color kText = 0xd0d0d0;
+constexpr Color kHeading = 0x4fc3f7;
+constexpr Color kBarTrack = 0x303840;
+constexpr Color kCrackFill = 0x66bb6a;
+constexpr Color kMemFill = 0xffa726;
+
+// The grid the layout is designed for; the scale is the largest integer that
+// still fits it on screen.
+constexpr int kGridColumns = 40;
+constexpr int kGridRows = 17;
+
+void format_duration(char* out, std::size_t size, std::uint64_t s) {
+  std::snprintf(out, size, "%02" PRIu64 ":%02" PRIu64 ":%02" PRIu64, s / 3600, (s / 60) % 60, s % 60);
+}
+
+}  // namespace
+
+Dashboard::Dashboard(Canvas& canvas) : canvas_(canvas) {
+  scale_ = std::max(1, std::min(canvas.width() / (kCellWidth * kGridColumns),
+                                canvas.height() / (kCellHeight * kGridRows)));
+  const int cw = kCellWidth * scale_;
+  const int ch = kCellHeight * scale_;
+  // Tiny fbdev modes may not fit even the margins; labels then clip.
+  const int columns = std::max(0, canvas.width() / cw - 2);
+  const int uptime_columns = std::min(12, columns);
+  const int x = cw;
+  auto row_y = [&](int row) { return ch / 2 + row * ch; };
+  const Rect bar_rect{x, 0, columns * cw, ch - 2 * scale_};
+
+  canvas_.fill({0, 0, canvas.width(), canvas.height()}, kBackground);
+  canvas_.text(x, row_y(0), "EtherOS", scale_, kHeading, kBackground);
+  canvas_.text(x, row_y(2), "CAPTURE", scale_, kHeading, kBackground);
+  canvas_.text(x, row_y(6), "HANDSHAKES", scale_, kHeading, kBackground);
+  canvas_.text(x, row_y(9), "CRACKING", scale_, kHeading, kBackground);
+  canvas_.text(x, row_y(13), "MEMORY", scale_, kHeading, kBackground);
+
+  uptime_ = Label(x + (columns - uptime_columns) * cw, row_y(0), uptime_columns, scale_, kText, kBackground);
+  capture_rate_ = Label(x, row_y(3), columns, scale_, kText, kBackground);
+  capture_total_ = Label(x, row_y(4), columns, scale_, kText, kBackground);
+  handshakes_ = Label(x, row_y(7), columns, scale_, kText, kBackground);
+  crack_bar_ = Bar({bar_rect.x, row_y(10) + scale_, bar_rect.w, bar_rect.h}, kCrackFill, kBarTrack);
+  crack_ = Label(x, row_y(11), columns, scale_, kText, kBackground);
+  mem_bar_ = Bar({bar_rect.x, row_y(14) + scale_, bar_rect.w, bar_rect.h}, kMemFill, kBarTrack);
+  mem_ = Label(x, row_y(15), columns, scale_, kText, kBackground);
+}
+
+void Dashboard::update(const DashboardStats& s) {
+  char buf[160];
+  char eta[32];
+
+  format_duration(eta, sizeof(eta), s.uptime_s);
+  std::snprintf(buf, sizeof(buf), "up %s", eta);
+  uptime_.set(canvas_, buf);
+
+  std::snprintf(buf, sizeof(buf), "%9.0f pkt/s  %7.2f MB/s", s.packets_per_s, s.bytes_per_s / 1e6);
+  capture_rate_.set(canvas_, buf);
+  std::snprintf(buf, sizeof(buf), "total %" PRIu64 "  drops %" PRIu64, s.packets, s.drops);
+  capture_total_.set(canvas_, buf);
+
+  std::snprintf(buf, sizeof(buf), "%" PRIu64 " captured  last %s", s.handshakes,
+                s.last_handshake.empty() ? "-" : s.last_handshake.c_str());
+  handshakes_.set(canvas_, buf);
+
+  const double crack_fraction = s.crack_total ? static_cast<double>(s.crack_done) / s.crack_total : 0.0;
+  crack_bar_.set(canvas_, crack_fraction);
+  if (s.crack_total == 0) {
+    std::snprintf(buf, sizeof(buf), "idle");
+  } else {
+    if (s.crack_per_s > 0 && s.crack_done < s.crack_total)
+      format_duration(eta, sizeof(eta), static_cast<std::uint64_t>((s.crack_total - s.crack_done) / s.crack_per_s));
+    else
+      std::snprintf(eta, sizeof(eta), "--:--:--");
+    std::snprintf(buf, sizeof(buf), "%5.1f%%  %.0f/s  eta %s", crack_fraction * 100, s.crack_per_s, eta);
+  }
+  crack_.set(canvas_, buf);
+
+  const std::uint64_t used_kb = s.mem_total_kb - std::min(s.mem_available_kb, s.mem_total_kb);
+  mem_bar_.set(canvas_, s.mem_total_kb ? static_cast<double>(used_kb) / s.mem_total_kb : 0.0);
+  std::snprintf(buf, sizeof(buf), "%" PRIu64 "/%" PRIu64 " MB  self %.1f MB %.1f%% cpu", used_kb / 1024,
+                s.mem_total_kb / 1024, s.self_rss_kb / 1024.0, s.self_cpu_percent);
+  mem_.set(canvas_, buf);
+}
+
+}  // namespace etheros::ui
@@ -0,0 +1,65 @@
+#pragma once
+
+// The field status screen: capture rates, handshakes, cracking progress and
+// memory, laid out on a character grid that scales with the display.
+
+#include <cstdint>
+#include <string>
+
+#include "etheros/ui/canvas.hpp"
+#include "etheros/ui/widgets.hpp"
+
+namespace etheros::ui {
+
+struct DashboardStats {
+  std::uint64_t uptime_s = 0;
+
+  double packets_per_s = 0;
+  double bytes_per_s = 0;
+  std::uint64_t packets = 0;
+  std::uint64_t drops = 0;
+
+  std::uint64_t handshakes = 0;
+  std::string last_handshake;
+
+  std::uint64_t crack_done = 0;
+  std::uint64_t crack_total = 0;
+  double crack_per_s = 0;
+
+  std::uint64_t mem_total_kb = 0;
+  std::uint64_t mem_available_kb = 0;
+  std::uint64_t self_rss_kb = 0;
+  double self_cpu_percent = 0;
+};
+
+// Per-second rate of a counter sampled dt seconds apart. A counter that went
+// backwards, because its producer restarted or its status file went away,
+// reads as 0 for one sample instead of wrapping.
+inline double counter_rate(std::uint64_t prev, std::uint64_t cur, double dt) {
+  return dt > 0 && cur >= prev ? (cur - prev) / dt : 0;
+}
+
+class Dashboard {
+ public:
+  // Paints the static frame (background, headings) immediately.
+  explicit Dashboard(Canvas& canvas);
+
+  // Repaints only the widgets whose rendered content changed.
+  void update(const DashboardStats& stats);
+
+  int scale() const { return scale_; }
+
+ private:
+  Canvas& canvas_;
+  int scale_ = 1;
+  Label uptime_;
+  Label capture_rate_;
+  Label capture_total_;
+  Label handshakes_;
+  Bar crack_bar_;
+  Label crack_;
+  Bar mem_bar_;
+  Label mem_;
+};
+
+}  // namespace etheros::ui
@@ -0,0 +1,48 @@
+#include "etheros/ui/dirty_region.hpp"
+
+namespace etheros::ui {
+
+namespace {
+
+// Merge when the union is at most this much larger than the two parts; text
+// cells on the same line merge, widgets far apart stay separate.
+constexpr long kMergeSlackPercent = 125;
+
+bool touches(const Rect& a, const Rect& b) {
+  return a.x <= b.right() && b.x <= a.right() && a.y <= b.bottom() && b.y <= a.bottom();
+}
+
+}  // namespace
+
+void DirtyRegion::add(Rect r) {
+  if (r.empty()) return;
+
+  // Merging can make the result touch an earlier rectangle, so repeat until
+  // nothing else combines.
+  for (bool merged = true; merged;) {
+    merged = false;
+    for (std::size_t i = 0; i < count_; ++i) {
+      const Rect u = rects_[i].unite(r);
+      if (touches(rects_[i], r) && u.area() * 100 <= (rects_[i].area() + r.area()) * kMergeSlackPercent) {
+        r = u;
+        rects_[i] = rects_[--count_];
+        merged = true;
+        break;
+      }
+    }
+  }
+
+  if (count_ == kMaxRects) {
+    for (std::size_t i = 0; i < count_; ++i) r = r.unite(rects_[i]);
+    count_ = 0;
+  }
+  rects_[count_++] = r;
+}
+
+long DirtyRegion::area() const {
+  long total = 0;
+  for (std::size_t i = 0; i < count_; ++i) total += rects_[i].area();
+  return total;
+}
+
+}  // namespace etheros::ui
@@ -0,0 +1,32 @@
+#pragma once
+
+// Accumulates the rectangles touched during a frame. Overlapping or touching
+// rectangles are merged when the union wastes little area; past kMaxRects the
+// region collapses to its bounding box, which is what drivers that take a clip
+// list (DRM_IOCTL_MODE_DIRTYFB) prefer anyway.
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "etheros/ui/surface.hpp"
+
+namespace etheros::ui {
+
+class DirtyRegion {
+ public:
+  static constexpr std::size_t kMaxRects = 16;
+
+  void add(Rect r);
+  void clear() { count_ = 0; }
+
+  bool empty() const { return count_ == 0; }
+  std::span<const Rect> rects() const { return {rects_.data(), count_}; }
+  long area() const;
+
+ private:
+  std::array<Rect, kMaxRects> rects_{};
+  std::size_t count_ = 0;
+};
+
+}  // namespace etheros::ui
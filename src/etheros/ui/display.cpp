@@ -0,0 +1,18 @@
+#include "etheros/ui/display.hpp"
+
+#include <stdexcept>
+
+namespace etheros::ui {
+
+std::unique_ptr<Display> open_display(const DisplayOptions& options) {
+  if (options.device.rfind("/dev/dri/", 0) == 0) return open_drm_display(options);
+  return open_fbdev_display(options);
+}
+
+#ifndef ETHEROS_HAVE_DRM
+std::unique_ptr<Display> open_drm_display(const DisplayOptions&) {
+  throw std::runtime_error("built without DRM headers; use a /dev/fbN device");
+}
+#endif
+
+}  // namespace etheros::ui
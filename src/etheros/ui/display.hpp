@@ -0,0 +1,45 @@
+#pragma once
+
+// Scanout targets for the dashboard, driven directly through the kernel:
+// DRM/KMS dumb buffers (/dev/dri/cardN) or the legacy framebuffer (/dev/fbN).
+// No X or Wayland is involved. Widgets draw straight into the mapped scanout
+// buffer, so the only memory cost beyond the kernel's buffer is the widgets'
+// own state.
+
+#include <memory>
+#include <span>
+#include <string>
+
+#include "etheros/ui/surface.hpp"
+
+namespace etheros::ui {
+
+struct DisplayOptions {
+  // /dev/dri/cardN or /dev/fbN.
+  std::string device = "/dev/dri/card0";
+  // DRM picks the largest mode within these bounds (a glanceable panel does
+  // not need 1080p, and a smaller buffer is cheaper to map), falling back to
+  // the connector's preferred mode.
+  int max_width = 1280;
+  int max_height = 720;
+};
+
+class Display {
+ public:
+  virtual ~Display() = default;
+
+  virtual const Surface& surface() const = 0;
+  // Tells the device which regions changed since the last call. Some DRM
+  // drivers (virtual and USB displays) only refresh what is flushed here.
+  virtual void present(std::span<const Rect> dirty) = 0;
+  virtual std::string description() const = 0;
+};
+
+// Throws std::system_error or std::runtime_error if the device cannot be
+// driven.
+std::unique_ptr<Display> open_display(const DisplayOptions& options);
+
+std::unique_ptr<Display> open_fbdev_display(const DisplayOptions& options);
+std::unique_ptr<Display> open_drm_display(const DisplayOptions& options);
+
+}  // namespace etheros::ui
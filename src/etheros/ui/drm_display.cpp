@@ -0,0 +1,254 @@
+// DRM/KMS backend using dumb buffers and raw uapi ioctls, so the dashboard
+// needs neither libdrm nor a compositor. Works on vc4 (the Zero 2 W's HDMI)
+// and on vkms for host-side testing.
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <drm.h>
+#include <drm_mode.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include "etheros/ui/display.hpp"
+#include "etheros/ui/dirty_region.hpp"
+
+namespace etheros::ui {
+
+namespace {
+
+constexpr std::uint32_t kConnectorConnected = 1;
+
+template <typename T>
+std::uint64_t user_ptr(T* p) {
+  return static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(p));
+}
+
+class DrmDisplay final : public Display {
+ public:
+  explicit DrmDisplay(const DisplayOptions& options) : device_(options.device) {
+    fd_ = ::open(device_.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd_ < 0) throw std::system_error(errno, std::generic_category(), "open " + device_);
+    try {
+      select_output(options);
+      create_buffer();
+      modeset();
+    } catch (...) {
+      teardown();
+      throw;
+    }
+  }
+
+  ~DrmDisplay() override { teardown(); }
+
+  const Surface& surface() const override { return surface_; }
+
+  void present(std::span<const Rect> dirty) override {
+    if (dirty.empty() || !dirtyfb_supported_) return;
+    std::array<drm_clip_rect, DirtyRegion::kMaxRects> clips{};
+    std::size_t n = 0;
+    for (const Rect& r : dirty) {
+      if (n == clips.size()) break;
+      clips[n++] = {static_cast<unsigned short>(r.x), static_cast<unsigned short>(r.y),
+                    static_cast<unsigned short>(r.right()), static_cast<unsigned short>(r.bottom())};
+    }
+    drm_mode_fb_dirty_cmd cmd{};
+    cmd.fb_id = fb_id_;
+    cmd.num_clips = static_cast<std::uint32_t>(n);
+    cmd.clips_ptr = user_ptr(clips.data());
+    // Drivers that scan out of the buffer directly do not implement dirtyfb;
+    // stop asking once they say so.
+    if (xioctl(DRM_IOCTL_MODE_DIRTYFB, &cmd) != 0 && (errno == ENOSYS || errno == EOPNOTSUPP))
+      dirtyfb_supported_ = false;
+  }
+
+  std::string description() const override {
+    return device_ + " drm " + std::to_string(surface_.width) + "x" + std::to_string(surface_.height) + "@" +
+           std::to_string(mode_.vrefresh) + " connector " + std::to_string(connector_id_);
+  }
+
+ private:
+  int xioctl(unsigned long request, void* arg) {
+    int r;
+    do {
+      r = ::ioctl(fd_, request, arg);
+    } while (r == -1 && (errno == EINTR || errno == EAGAIN));
+    return r;
+  }
+
+  void check(unsigned long request, void* arg, const char* what) {
+    if (xioctl(request, arg) != 0) throw std::system_error(errno, std::generic_category(), device_ + ": " + what);
+  }
+
+  void select_output(const DisplayOptions& options) {
+    drm_mode_card_res res{};
+    check(DRM_IOCTL_MODE_GETRESOURCES, &res, "GETRESOURCES");
+    std::vector<std::uint32_t> crtcs(res.count_crtcs), connectors(res.count_connectors);
+    std::vector<std::uint32_t> encoders(res.count_encoders), fbs(res.count_fbs);
+    res.crtc_id_ptr = user_ptr(crtcs.data());
+    res.connector_id_ptr = user_ptr(connectors.data());
+    res.encoder_id_ptr = user_ptr(encoders.data());
+    res.fb_id_ptr = user_ptr(fbs.data());
+    check(DRM_IOCTL_MODE_GETRESOURCES, &res, "GETRESOURCES");
+    crtcs.resize(std::min<std::size_t>(crtcs.size(), res.count_crtcs));
+    connectors.resize(std::min<std::size_t>(connectors.size(), res.count_connectors));
+
+    for (std::uint32_t id : connectors) {
+      drm_mode_get_connector conn{};
+      conn.connector_id = id;
+      check(DRM_IOCTL_MODE_GETCONNECTOR, &conn, "GETCONNECTOR");
+      if (conn.connection != kConnectorConnected || conn.count_modes == 0) continue;
+
+      std::vector<drm_mode_modeinfo> modes(conn.count_modes);
+      std::vector<std::uint32_t> conn_encoders(conn.count_encoders);
+      conn.modes_ptr = user_ptr(modes.data());
+      conn.encoders_ptr = user_ptr(conn_encoders.data());
+      conn.count_props = 0;
+      check(DRM_IOCTL_MODE_GETCONNECTOR, &conn, "GETCONNECTOR");
+      // A hotplug between the two calls can grow the list; the kernel then
+      // copies nothing, so skip rather than read garbage.
+      if (conn.count_modes > modes.size() || conn.count_modes == 0) continue;
+      modes.resize(conn.count_modes);
+      conn_encoders.resize(std::min<std::size_t>(conn_encoders.size(), conn.count_encoders));
+
+      const std::uint32_t crtc = pick_crtc(conn.encoder_id, conn_encoders, crtcs);
+      if (crtc == 0) continue;
+
+      connector_id_ = id;
+      crtc_id_ = crtc;
+      mode_ = pick_mode(modes, options);
+      return;
+    }
+    throw std::runtime_error(device_ + ": no connected output");
+  }
+
+  std::uint32_t pick_crtc(std::uint32_t current_encoder, const std::vector<std::uint32_t>& encoders,
+                          const std::vector<std::uint32_t>& crtcs) {
+    if (current_encoder != 0) {
+      drm_mode_get_encoder enc{};
+      enc.encoder_id = current_encoder;
+      if (xioctl(DRM_IOCTL_MODE_GETENCODER, &enc) == 0 && enc.crtc_id != 0) return enc.crtc_id;
+    }
+    for (std::uint32_t id : encoders) {
+      drm_mode_get_encoder enc{};
+      enc.encoder_id = id;
+      if (xioctl(DRM_IOCTL_MODE_GETENCODER, &enc) != 0) continue;
+      for (std::size_t i = 0; i < crtcs.size() && i < 32; ++i)
+        if (enc.possible_crtcs & (1u << i)) return crtcs[i];
+    }
+    return 0;
+  }
+
+  static drm_mode_modeinfo pick_mode(const std::vector<drm_mode_modeinfo>& modes, const DisplayOptions& options) {
+    const drm_mode_modeinfo* best = nullptr;
+    const drm_mode_modeinfo* preferred = &modes.front();
+    auto area = [](const drm_mode_modeinfo& m) { return long{m.hdisplay} * m.vdisplay; };
+    for (const drm_mode_modeinfo& m : modes) {
+      if (m.type & DRM_MODE_TYPE_PREFERRED) preferred = &m;
+      if (m.hdisplay > options.max_width || m.vdisplay > options.max_height) continue;
+      if (best == nullptr || area(m) > area(*best) ||
+          (area(m) == area(*best) && (m.type & DRM_MODE_TYPE_PREFERRED)))
+        best = &m;
+    }
+    return best ? *best : *preferred;
+  }
+
+  void create_buffer() {
+    drm_mode_create_dumb create{};
+    create.width = mode_.hdisplay;
+    create.height = mode_.vdisplay;
+    create.bpp = 32;
+    check(DRM_IOCTL_MODE_CREATE_DUMB, &create, "CREATE_DUMB");
+    handle_ = create.handle;
+    map_size_ = create.size;
+
+    drm_mode_fb_cmd fb{};
+    fb.width = create.width;
+    fb.height = create.height;
+    fb.pitch = create.pitch;
+    fb.bpp = 32;
+    fb.depth = 24;
+    fb.handle = handle_;
+    check(DRM_IOCTL_MODE_ADDFB, &fb, "ADDFB");
+    fb_id_ = fb.fb_id;
+
+    drm_mode_map_dumb map{};
+    map.handle = handle_;
+    check(DRM_IOCTL_MODE_MAP_DUMB, &map, "MAP_DUMB");
+    void* p = ::mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, static_cast<off_t>(map.offset));
+    if (p == MAP_FAILED) throw std::system_error(errno, std::generic_category(), device_ + ": mmap dumb buffer");
+    map_ = static_cast<std::uint8_t*>(p);
+
+    surface_.pixels = map_;
+    surface_.width = static_cast<int>(create.width);
+    surface_.height = static_cast<int>(create.height);
+    surface_.stride = create.pitch;
+    surface_.format = PixelFormat::kXrgb8888;
+  }
+
+  void modeset() {
+    saved_crtc_.crtc_id = crtc_id_;
+    if (xioctl(DRM_IOCTL_MODE_GETCRTC, &saved_crtc_) != 0) saved_crtc_ = {};
+
+    drm_mode_crtc set{};
+    set.crtc_id = crtc_id_;
+    set.fb_id = fb_id_;
+    set.set_connectors_ptr = user_ptr(&connector_id_);
+    set.count_connectors = 1;
+    set.mode = mode_;
+    set.mode_valid = 1;
+    check(DRM_IOCTL_MODE_SETCRTC, &set, "SETCRTC");
+    modeset_done_ = true;
+  }
+
+  void teardown() {
+    if (modeset_done_ && saved_crtc_.crtc_id != 0 && saved_crtc_.mode_valid) {
+      // Hand the console (or whatever was there) back.
+      saved_crtc_.set_connectors_ptr = user_ptr(&connector_id_);
+      saved_crtc_.count_connectors = 1;
+      xioctl(DRM_IOCTL_MODE_SETCRTC, &saved_crtc_);
+    }
+    if (map_ != nullptr) ::munmap(map_, map_size_);
+    if (fb_id_ != 0) xioctl(DRM_IOCTL_MODE_RMFB, &fb_id_);
+    if (handle_ != 0) {
+      drm_mode_destroy_dumb destroy{};
+      destroy.handle = handle_;
+      xioctl(DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+    }
+    if (fd_ >= 0) ::close(fd_);
+    map_ = nullptr;
+    fb_id_ = handle_ = 0;
+    fd_ = -1;
+  }
+
+  std::string device_;
+  int fd_ = -1;
+  std::uint32_t connector_id_ = 0;
+  std::uint32_t crtc_id_ = 0;
+  drm_mode_modeinfo mode_{};
+  drm_mode_crtc saved_crtc_{};
+  bool modeset_done_ = false;
+  bool dirtyfb_supported_ = true;
+
+  std::uint32_t handle_ = 0;
+  std::uint32_t fb_id_ = 0;
+  std::uint8_t* map_ = nullptr;
+  std::size_t map_size_ = 0;
+  Surface surface_;
+};
+
+}  // namespace
+
+std::unique_ptr<Display> open_drm_display(const DisplayOptions& options) {
+  return std::make_unique<DrmDisplay>(options);
+}
+
+}  // namespace etheros::ui
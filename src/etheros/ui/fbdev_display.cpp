@@ -0,0 +1,86 @@
+#include <fcntl.h>
+#include <linux/fb.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+
+#include "etheros/ui/display.hpp"
+
+namespace etheros::ui {
+
+namespace {
+
+class FbdevDisplay final : public Display {
+ public:
+  explicit FbdevDisplay(const DisplayOptions& options) : device_(options.device) {
+    fd_ = ::open(device_.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd_ < 0) throw std::system_error(errno, std::generic_category(), "open " + device_);
+
+    fb_var_screeninfo var{};
+    fb_fix_screeninfo fix{};
+    if (::ioctl(fd_, FBIOGET_VSCREENINFO, &var) != 0 || ::ioctl(fd_, FBIOGET_FSCREENINFO, &fix) != 0) {
+      const int err = errno;
+      ::close(fd_);
+      throw std::system_error(err, std::generic_category(), "fbdev query " + device_);
+    }
+
+    PixelFormat format;
+    if (var.bits_per_pixel == 16) {
+      format = PixelFormat::kRgb565;
+    } else if (var.bits_per_pixel == 32) {
+      format = var.red.offset == 0 ? PixelFormat::kXbgr8888 : PixelFormat::kXrgb8888;
+    } else {
+      ::close(fd_);
+      throw std::runtime_error(device_ + ": unsupported depth " + std::to_string(var.bits_per_pixel));
+    }
+
+    map_size_ = fix.smem_len;
+    void* p = ::mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+      const int err = errno;
+      ::close(fd_);
+      throw std::system_error(err, std::generic_category(), "mmap " + device_);
+    }
+    map_ = static_cast<std::uint8_t*>(p);
+
+    surface_.format = format;
+    surface_.width = static_cast<int>(var.xres);
+    surface_.height = static_cast<int>(var.yres);
+    surface_.stride = fix.line_length;
+    surface_.pixels = map_ + var.yoffset * fix.line_length + var.xoffset * (var.bits_per_pixel / 8);
+  }
+
+  ~FbdevDisplay() override {
+    ::munmap(map_, map_size_);
+    ::close(fd_);
+  }
+
+  const Surface& surface() const override { return surface_; }
+
+  // fbdev scans out of the mapped memory directly; there is nothing to flush.
+  void present(std::span<const Rect>) override {}
+
+  std::string description() const override {
+    return device_ + " fbdev " + std::to_string(surface_.width) + "x" + std::to_string(surface_.height) + " " +
+           std::to_string(bytes_per_pixel(surface_.format) * 8) + "bpp";
+  }
+
+ private:
+  std::string device_;
+  int fd_ = -1;
+  std::uint8_t* map_ = nullptr;
+  std::size_t map_size_ = 0;
+  Surface surface_;
+};
+
+}  // namespace
+
+std::unique_ptr<Display> open_fbdev_display(const DisplayOptions& options) {
+  return std::make_unique<FbdevDisplay>(options);
+}
+
+}  // namespace etheros::ui
@@ -0,0 +1,19 @@
+#pragma once
+
+// Built-in 5x7 bitmap font covering printable ASCII. Glyphs are stored column
+// by column, bit 0 at the top, and drawn in a 6x8 cell.
+
+#include <cstdint>
+
+namespace etheros::ui {
+
+inline constexpr int kGlyphWidth = 5;
+inline constexpr int kGlyphHeight = 7;
+inline constexpr int kCellWidth = 6;
+inline constexpr int kCellHeight = 8;
+
+// Returns the five column bitmaps for c; characters outside 0x20..0x7e map
+// to '?'.
+const std::uint8_t* glyph(char c);
+
+}  // namespace etheros::ui
@@ -0,0 +1,72 @@
+#pragma once
+
+// A raw pixel buffer the dashboard draws into: either a scanout buffer mapped
+// from the kernel or plain memory in benchmarks.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace etheros::ui {
+
+enum class PixelFormat : std::uint8_t {
+  kXrgb8888,
+  kXbgr8888,
+  kRgb565,
+};
+
+inline int bytes_per_pixel(PixelFormat f) { return f == PixelFormat::kRgb565 ? 2 : 4; }
+
+// 0xRRGGBB.
+using Color = std::uint32_t;
+
+inline std::uint32_t pack(PixelFormat f, Color c) {
+  const std::uint32_t r = (c >> 16) & 0xff, g = (c >> 8) & 0xff, b = c & 0xff;
+  switch (f) {
+    case PixelFormat::kXrgb8888:
+      return c & 0xffffff;
+    case PixelFormat::kXbgr8888:
+      return (b << 16) | (g << 8) | r;
+    case PixelFormat::kRgb565:
+      return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+  }
+  return 0;
+}
+
+struct Rect {
+  int x = 0;
+  int y = 0;
+  int w = 0;
+  int h = 0;
+
+  bool empty() const { return w <= 0 || h <= 0; }
+  int right() const { return x + w; }
+  int bottom() const { return y + h; }
+  long area() const { return empty() ? 0 : long{w} * h; }
+
+  Rect intersect(const Rect& o) const {
+    const int l = std::max(x, o.x), t = std::max(y, o.y);
+    const int r = std::min(right(), o.right()), b = std::min(bottom(), o.bottom());
+    return r > l && b > t ? Rect{l, t, r - l, b - t} : Rect{};
+  }
+  Rect unite(const Rect& o) const {
+    if (empty()) return o;
+    if (o.empty()) return *this;
+    const int l = std::min(x, o.x), t = std::min(y, o.y);
+    return {l, t, std::max(right(), o.right()) - l, std::max(bottom(), o.bottom()) - t};
+  }
+
+  friend bool operator==(const Rect&, const Rect&) = default;
+};
+
+struct Surface {
+  std::uint8_t* pixels = nullptr;
+  int width = 0;
+  int height = 0;
+  std::size_t stride = 0;  // bytes per row
+  PixelFormat format = PixelFormat::kXrgb8888;
+
+  Rect bounds() const { return {0, 0, width, height}; }
+};
+
+}  // namespace etheros::ui
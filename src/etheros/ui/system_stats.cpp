@@ -0,0 +1,62 @@
+#include "etheros/ui/system_stats.hpp"
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace etheros::ui {
+
+namespace {
+
+// Reads a small procfs file into buf without stdio buffering.
+std::size_t read_proc(const char* path, char* buf, std::size_t size) {
+  const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return 0;
+  const ssize_t n = ::read(fd, buf, size - 1);
+  ::close(fd);
+  if (n <= 0) return 0;
+  buf[n] = '\0';
+  return static_cast<std::size_t>(n);
+}
+
+std::uint64_t meminfo_field(const char* text, const char* key) {
+  const char* p = std::strstr(text, key);
+  return p ? std::strtoull(p + std::strlen(key), nullptr, 10) : 0;
+}
+
+}  // namespace
+
+MemoryInfo read_memory_info() {
+  // MemTotal and MemAvailable are within the first few lines.
+  char buf[512];
+  MemoryInfo info;
+  if (read_proc("/proc/meminfo", buf, sizeof(buf)) == 0) return info;
+  info.total_kb = meminfo_field(buf, "MemTotal:");
+  info.available_kb = meminfo_field(buf, "MemAvailable:");
+  return info;
+}
+
+ProcessUsage read_self_usage() {
+  ProcessUsage usage;
+  rusage ru{};
+  if (::getrusage(RUSAGE_SELF, &ru) == 0) {
+    usage.cpu_ns = (static_cast<std::uint64_t>(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1'000'000 +
+                    static_cast<std::uint64_t>(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec)) *
+                   1000;
+    usage.max_rss_kb = static_cast<std::uint64_t>(ru.ru_maxrss);
+  }
+
+  char buf[128];
+  if (read_proc("/proc/self/statm", buf, sizeof(buf)) != 0) {
+    unsigned long long size_pages = 0, rss_pages = 0;
+    if (std::sscanf(buf, "%llu %llu", &size_pages, &rss_pages) == 2)
+      usage.rss_kb = rss_pages * static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE)) / 1024;
+  }
+  return usage;
+}
+
+}  // namespace etheros::ui
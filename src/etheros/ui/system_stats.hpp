@@ -0,0 +1,25 @@
+#pragma once
+
+// Cheap readers for the memory and CPU figures the dashboard shows. Each call
+// is a single small read from procfs or getrusage().
+
+#include <cstdint>
+
+namespace etheros::ui {
+
+struct MemoryInfo {
+  std::uint64_t total_kb = 0;
+  std::uint64_t available_kb = 0;
+};
+
+struct ProcessUsage {
+  std::uint64_t rss_kb = 0;
+  std::uint64_t max_rss_kb = 0;
+  std::uint64_t cpu_ns = 0;  // user + system
+};
+
+// Returns zeros if /proc/meminfo is unreadable.
+MemoryInfo read_memory_info();
+ProcessUsage read_self_usage();
+
+}  // namespace etheros::ui
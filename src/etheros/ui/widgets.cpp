@@ -0,0 +1,51 @@
+#include "etheros/ui/widgets.hpp"
+
+#include <algorithm>
+
+#include "etheros/ui/font.hpp"
+
+namespace etheros::ui {
+
+Label::Label(int x, int y, int columns, int scale, Color fg, Color bg)
+    : x_(x), y_(y), columns_(std::max(0, columns)), scale_(scale), fg_(fg), bg_(bg) {
+  invalidate();
+  next_.reserve(static_cast<std::size_t>(columns_));
+}
+
+void Label::set(Canvas& canvas, std::string_view text) {
+  next_.assign(text.substr(0, static_cast<std::size_t>(columns_)));
+  next_.resize(static_cast<std::size_t>(columns_), ' ');
+
+  const std::size_t n = next_.size();
+  for (std::size_t i = 0; i < n;) {
+    if (next_[i] == shown_[i]) {
+      ++i;
+      continue;
+    }
+    std::size_t j = i + 1;
+    while (j < n && next_[j] != shown_[j]) ++j;
+    canvas.text(x_ + static_cast<int>(i) * kCellWidth * scale_, y_, std::string_view(next_).substr(i, j - i),
+                scale_, fg_, bg_);
+    i = j;
+  }
+  shown_.swap(next_);
+}
+
+void Bar::set(Canvas& canvas, double fraction) {
+  // std::clamp passes NaN (0/0) through, and casting it to int is undefined.
+  fraction = fraction > 0 ? std::min(fraction, 1.0) : 0.0;
+  const int filled = static_cast<int>(fraction * area_.w + 0.5);
+  if (filled == filled_) return;
+
+  if (filled_ < 0) {
+    canvas.fill({area_.x, area_.y, filled, area_.h}, fg_);
+    canvas.fill({area_.x + filled, area_.y, area_.w - filled, area_.h}, bg_);
+  } else if (filled > filled_) {
+    canvas.fill({area_.x + filled_, area_.y, filled - filled_, area_.h}, fg_);
+  } else {
+    canvas.fill({area_.x + filled, area_.y, filled_ - filled, area_.h}, bg_);
+  }
+  filled_ = filled;
+}
+
+}  // namespace etheros::ui
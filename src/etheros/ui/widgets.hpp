@@ -0,0 +1,50 @@
+#pragma once
+
+// Retained widgets that remember what is on screen and redraw only the part
+// that changed: a Label repaints the character cells that differ, a Bar the
+// span between its old and new fill.
+
+#include <string>
+#include <string_view>
+
+#include "etheros/ui/canvas.hpp"
+
+namespace etheros::ui {
+
+class Label {
+ public:
+  Label() = default;
+  Label(int x, int y, int columns, int scale, Color fg, Color bg);
+
+  // Text longer than the label is cut; shorter text is padded with blanks.
+  void set(Canvas& canvas, std::string_view text);
+  // Forces the next set() to repaint every cell.
+  void invalidate() { shown_.assign(static_cast<std::size_t>(columns_), '\0'); }
+
+ private:
+  int x_ = 0;
+  int y_ = 0;
+  int columns_ = 0;
+  int scale_ = 1;
+  Color fg_ = 0;
+  Color bg_ = 0;
+  std::string shown_;
+  std::string next_;
+};
+
+class Bar {
+ public:
+  Bar() = default;
+  Bar(Rect area, Color fg, Color bg) : area_(area), fg_(fg), bg_(bg) {}
+
+  void set(Canvas& canvas, double fraction);
+  void invalidate() { filled_ = -1; }
+
+ private:
+  Rect area_;
+  Color fg_ = 0;
+  Color bg_ = 0;
+  int filled_ = -1;
+};
+
+}  // namespace etheros::ui
@@ -0,0 +1,34 @@
+#pragma once
+
+// Decoded TCP packets for flow-table tests and benchmarks, which build
+// millions of them without going through the decoder.
+
+#include <cstdint>
+
+#include "etheros/common/bytes.hpp"
+#include "etheros/parse/decode.hpp"
+
+namespace etheros::test {
+
+// Client side of flow number `flow` (any 32-bit value gives a distinct
+// 10.x.y.z:port -> 192.168.0.n:443 conversation); payload must outlive it.
+inline parse::DecodedPacket tcp_packet(std::uint32_t flow, std::uint32_t seq, std::uint8_t flags,
+                                       ByteSpan payload = {}) {
+  std::uint8_t src[4], dst[4];
+  store_be32(src, 0x0a000000u | (flow & 0xffffff));
+  store_be32(dst, 0xc0a80000u | (flow >> 24));
+  parse::DecodedPacket p;
+  p.layers = parse::kLayerL2 | parse::kLayerIp | parse::kLayerTcp;
+  p.ip_version = 4;
+  p.ip_proto = 6;
+  p.src_ip = IpAddress::from_v4(src);
+  p.dst_ip = IpAddress::from_v4(dst);
+  p.src_port = static_cast<std::uint16_t>(32768 + flow % 28000);
+  p.dst_port = 443;
+  p.tcp_seq = seq;
+  p.tcp_flags = flags;
+  p.payload = payload;
+  return p;
+}
+
+}  // namespace etheros::test
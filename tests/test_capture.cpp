@@ -0,0 +1,128 @@
+// Capture: pcap files cut short or written big-endian, and the packet ring
+// across many wrap-arounds and when it fills up.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "etheros/capture/packet_ring.hpp"
+#include "etheros/capture/pcap.hpp"
+
+namespace etheros::capture {
+namespace {
+
+void put_be32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+  out.resize(out.size() + 4);
+  store_be32(out.data() + out.size() - 4, v);
+}
+
+// A big-endian microsecond capture, so the reader has to swap and scale.
+std::vector<std::uint8_t> pcap_file(std::initializer_list<std::vector<std::uint8_t>> frames) {
+  std::vector<std::uint8_t> out;
+  for (std::uint32_t v : {0xa1b2c3d4u, 0x00020004u, 0u, 0u, 65535u, 1u}) put_be32(out, v);
+  std::uint32_t sec = 100;
+  for (const auto& frame : frames) {
+    const auto len = static_cast<std::uint32_t>(frame.size());
+    for (std::uint32_t v : {sec++, 250u, len, len + 10}) put_be32(out, v);
+    out.insert(out.end(), frame.begin(), frame.end());
+  }
+  return out;
+}
+
+TEST(PcapReader, ReadsSwappedMicrosecondFiles) {
+  const std::vector<std::uint8_t> file = pcap_file({{1, 2, 3}, {4, 5}});
+  PcapReader reader(file);
+  EXPECT_EQ(reader.link_type(), LinkType::kEthernet);
+  EXPECT_EQ(reader.snaplen(), 65535u);
+
+  Packet pkt;
+  ASSERT_TRUE(reader.next(pkt));
+  EXPECT_EQ(pkt.ts_ns, 100'000'250'000u);
+  EXPECT_EQ(pkt.orig_len, 13u);
+  EXPECT_EQ(std::vector<std::uint8_t>(pkt.data.begin(), pkt.data.end()), (std::vector<std::uint8_t>{1, 2, 3}));
+  ASSERT_TRUE(reader.next(pkt));
+  EXPECT_EQ(pkt.data.size(), 2u);
+  EXPECT_FALSE(reader.next(pkt));
+  EXPECT_FALSE(reader.truncated());
+
+  reader.rewind();
+  ASSERT_TRUE(reader.next(pkt));
+  EXPECT_EQ(pkt.ts_ns, 100'000'250'000u);
+}
+
+TEST(PcapReader, TruncatedRecordsEndTheStream) {
+  const std::vector<std::uint8_t> file = pcap_file({{1, 2, 3, 4}, {5, 6, 7, 8}});
+  Packet pkt;
+  // Cut inside the second record's data, then inside its header.
+  for (std::size_t cut : {file.size() - 1, file.size() - 4 - 10}) {
+    const std::vector<std::uint8_t> partial(file.begin(), file.begin() + static_cast<std::ptrdiff_t>(cut));
+    PcapReader reader(partial);
+    ASSERT_TRUE(reader.next(pkt));
+    EXPECT_FALSE(reader.next(pkt));
+    EXPECT_TRUE(reader.truncated());
+    EXPECT_FALSE(reader.next(pkt));
+  }
+}
+
+TEST(PcapReader, RejectsShortAndUnknownFiles) {
+  std::vector<std::uint8_t> file = pcap_file({});
+  EXPECT_THROW(PcapReader(ByteSpan(file).first(20)), std::runtime_error);
+  file[0] = 0x0a;  // pcapng section header block
+  EXPECT_THROW(PcapReader{file}, std::runtime_error);
+}
+
+// Frame bytes encode the sequence number so a misplaced record shows up.
+std::vector<std::uint8_t> frame_of(std::uint32_t n) {
+  std::vector<std::uint8_t> frame(1 + n * 37 % 600);
+  for (std::size_t i = 0; i < frame.size(); ++i) frame[i] = static_cast<std::uint8_t>(n + i);
+  return frame;
+}
+
+TEST(PacketRing, SurvivesManyWrapArounds) {
+  PacketRing ring(4096);
+  EXPECT_EQ(ring.capacity(), 4096u);
+  std::uint32_t pushed = 0, popped = 0;
+  Packet pkt;
+  // Uneven sizes land the end of the buffer at every offset, so most laps
+  // need a wrap marker.
+  while (popped < 2000) {
+    while (pushed - popped < 4 && ring.try_push(pushed, pushed + 1, frame_of(pushed))) ++pushed;
+    ASSERT_TRUE(ring.peek(pkt));
+    EXPECT_EQ(pkt.ts_ns, popped);
+    EXPECT_EQ(pkt.orig_len, popped + 1);
+    const std::vector<std::uint8_t> want = frame_of(popped);
+    ASSERT_EQ(std::vector<std::uint8_t>(pkt.data.begin(), pkt.data.end()), want) << "packet " << popped;
+    ring.pop();
+    ++popped;
+  }
+  EXPECT_EQ(ring.dropped(), 0u);
+}
+
+TEST(PacketRing, DropsWhenFullAndRecovers) {
+  PacketRing ring(4096);
+  const std::vector<std::uint8_t> frame(1000, 0xab);
+  int accepted = 0;
+  while (ring.try_push(0, 1000, frame)) ++accepted;
+  EXPECT_EQ(accepted, 4);  // 1024-byte records
+  EXPECT_EQ(ring.dropped(), 1u);
+
+  // Bigger than half the ring can never fit.
+  EXPECT_FALSE(ring.try_push(0, 3000, std::vector<std::uint8_t>(3000)));
+  EXPECT_EQ(ring.dropped(), 2u);
+
+  Packet pkt;
+  ASSERT_TRUE(ring.peek(pkt));
+  ring.pop();
+  EXPECT_TRUE(ring.try_push(0, 1000, frame));
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(ring.peek(pkt));
+    EXPECT_EQ(pkt.data.size(), 1000u);
+    ring.pop();
+  }
+  EXPECT_FALSE(ring.peek(pkt));
+}
+
+}  // namespace
+}  // namespace etheros::capture
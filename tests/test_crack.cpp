@@ -0,0 +1,561 @@
+// Cracking: known answers for the in-tree SHA-1, PBKDF2 and PMKID code,
+// checkpoint replay after crashes and corruption, chunk scheduling, and the
+// coordinator/worker protocol over loopback.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "etheros/crack/checkpoint.hpp"
+#include "etheros/crack/cluster.hpp"
+#include "etheros/crack/job_manager.hpp"
+#include "etheros/crack/keyspace.hpp"
+#include "etheros/crack/pbkdf2.hpp"
+#include "etheros/crack/pmkid.hpp"
+#include "etheros/crack/sha1.hpp"
+#include "test_support.hpp"
+
+namespace etheros::crack {
+namespace {
+
+using test::read_file;
+using test::TempDir;
+using test::write_file;
+
+constexpr std::uint64_t kJob = 0x1234;
+// The open record is a 16-byte header plus the chunk count padded to 16.
+constexpr std::size_t kOpenRecord = 32;
+constexpr std::size_t kDoneRecord = 16;
+
+ByteSpan bytes_of(std::string_view s) { return ByteSpan(reinterpret_cast<const std::uint8_t*>(s.data()), s.size()); }
+
+std::string hex(std::span<const std::uint8_t> bytes) {
+  static constexpr char kDigits[] = "0123456789abcdef";
+  std::string out;
+  for (std::uint8_t b : bytes) {
+    out.push_back(kDigits[b >> 4]);
+    out.push_back(kDigits[b & 0xf]);
+  }
+  return out;
+}
+
+std::string sha1_hex(std::string_view message) {
+  Sha1 h;
+  h.update(bytes_of(message));
+  return hex(h.final());
+}
+
+std::string pbkdf2_hex(std::string_view password, std::string_view salt, std::uint32_t iterations, std::size_t len) {
+  std::vector<std::uint8_t> out(len);
+  pbkdf2_hmac_sha1(bytes_of(password), bytes_of(salt), iterations, out);
+  return hex(out);
+}
+
+// FIPS 180 examples.
+TEST(Sha1, KnownAnswers) {
+  EXPECT_EQ(sha1_hex("abc"), "a9993e364706816aba3e25717850c26c9cd0d89d");
+  EXPECT_EQ(sha1_hex(""), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+  // 56 bytes: the length no longer fits in the first block.
+  EXPECT_EQ(sha1_hex("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+            "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+}
+
+TEST(Sha1, UpdatesInPiecesMatchOneUpdate) {
+  const std::string million(1'000'000, 'a');
+  Sha1 h;
+  for (std::size_t off = 0; off < million.size();) {
+    const std::size_t n = std::min<std::size_t>(1 + off % 97, million.size() - off);
+    h.update(bytes_of(std::string_view(million).substr(off, n)));
+    off += n;
+  }
+  EXPECT_EQ(hex(h.final()), "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+}
+
+// RFC 6070, except the 2^24-iteration case.
+TEST(Pbkdf2, Rfc6070Vectors) {
+  EXPECT_EQ(pbkdf2_hex("password", "salt", 1, 20), "0c60c80f961f0e71f3a9b524af6012062fe037a6");
+  EXPECT_EQ(pbkdf2_hex("password", "salt", 2, 20), "ea6c014dc72d6f8ccd1ed92ace1d41f0d8de8957");
+  EXPECT_EQ(pbkdf2_hex("password", "salt", 4096, 20), "4b007901b765489abead49d926f721d065a429c1");
+  // Long salt, and a key that spans two blocks.
+  EXPECT_EQ(pbkdf2_hex("passwordPASSWORDpassword", "saltSALTsaltSALTsaltSALTsaltSALTsalt", 4096, 25),
+            "3d2eec4fe41c849b80c8d83662c0e44a8b291a964cf2f07038");
+  EXPECT_EQ(pbkdf2_hex(std::string_view("pass\0word", 9), std::string_view("sa\0lt", 5), 4096, 16),
+            "56fa6aa75548099dcc37d7f03425e0c3");
+}
+
+// Salts whose first-iteration tail needs a second block, or that are longer
+// than a block themselves; checked against Python's hashlib.pbkdf2_hmac.
+TEST(Pbkdf2, SaltsAcrossBlockBoundaries) {
+  std::string salt;
+  for (int i = 0; i < 100; ++i) salt.push_back(static_cast<char>(i));
+  EXPECT_EQ(pbkdf2_hex("password", std::string_view(salt).substr(0, 57), 2, 20),
+            "25bf8ac7fee783fea8c9a42aa14396a10faaf280");
+  EXPECT_EQ(pbkdf2_hex("password", salt, 2, 40),
+            "0d7c563b7b3559ac82391d28c2455ae0d2427005b770f33324f94a793ca94322dbe1128bfbcddb76");
+}
+
+// IEEE 802.11i-2004, H.4.
+TEST(Pbkdf2, WpaPmk) {
+  EXPECT_EQ(hex(wpa_pmk("password", "IEEE")), "f42c6fc52df0ebef9ebb4b90b38a5f902e83fe1b135a70e23aed762e9710a12e");
+}
+
+// The 22000 example hash from the hashcat wiki.
+TEST(Pmkid, HashcatExample) {
+  constexpr std::string_view kLine =
+      "WPA*01*4d4fe7aac3a2cecab195321ceb99a7d0*fc690c158264*f4747f87f9f4*686173686361742d6573736964***";
+  const PmkidTarget t = PmkidTarget::parse(kLine);
+  EXPECT_EQ(t.essid, "hashcat-essid");
+  EXPECT_EQ(t.format(), kLine);
+  EXPECT_TRUE(t.matches_passphrase("hashcat!"));
+  EXPECT_FALSE(t.matches_passphrase("hashcat?"));
+  EXPECT_EQ(PmkidTarget::from_passphrase("hashcat!", t.essid, t.ap, t.station).pmkid, t.pmkid);
+}
+
+TEST(Pmkid, RejectsMalformedLines) {
+  EXPECT_THROW(PmkidTarget::parse("WPA*02*4d4fe7aac3a2cecab195321ceb99a7d0*fc690c158264*f4747f87f9f4*6869***"),
+               std::invalid_argument);
+  EXPECT_THROW(PmkidTarget::parse("WPA*01*4d4fe7aac3a2*fc690c158264*f4747f87f9f4*6869***"), std::invalid_argument);
+  EXPECT_THROW(PmkidTarget::parse("WPA*01*4d4fe7aac3a2cecab195321ceb99a7d0*fc690c158264*f4747f87f9f4*6g69***"),
+               std::invalid_argument);
+}
+
+TEST(Checkpoint, ResumesFinishedChunks) {
+  TempDir dir;
+  {
+    Checkpoint cp(dir.path(), kJob, 100);
+    cp.mark_done(3);
+    cp.mark_done(7);
+    cp.mark_done(99);
+    cp.mark_done(7);  // repeats are not written again
+  }
+  Checkpoint cp(dir.path(), kJob, 100);
+  EXPECT_EQ(cp.done_count(), 3u);
+  EXPECT_TRUE(cp.is_done(3));
+  EXPECT_TRUE(cp.is_done(7));
+  EXPECT_TRUE(cp.is_done(99));
+  EXPECT_FALSE(cp.is_done(4));
+  EXPECT_FALSE(cp.found());
+}
+
+TEST(Checkpoint, RecordsStayOnSixteenByteBoundaries) {
+  TempDir dir;
+  {
+    Checkpoint cp(dir.path(), kJob, 1000);
+    for (std::uint64_t c = 0; c < 40; ++c) cp.mark_done(c);
+  }
+  const std::size_t size = read_file(dir.file("journal")).size();
+  EXPECT_EQ(size, kOpenRecord + 40 * kDoneRecord);
+  // So no done record crosses a 512-byte sector.
+  for (std::size_t off = kOpenRecord; off < size; off += kDoneRecord) EXPECT_LE(off % 512 + kDoneRecord, 512u);
+}
+
+TEST(Checkpoint, TornTailIsCutOff) {
+  TempDir dir;
+  {
+    Checkpoint cp(dir.path(), kJob, 100);
+    cp.mark_done(1);
+    cp.mark_done(2);
+  }
+  std::vector<std::uint8_t> journal = read_file(dir.file("journal"));
+  const std::size_t clean = journal.size();
+  // Half of a record that was being written when the power went.
+  journal.insert(journal.end(), {0x02, 0x00, 0x00, 0x00, 0xaa, 0xbb, 0xcc});
+  write_file(dir.file("journal"), journal);
+  {
+    Checkpoint cp(dir.path(), kJob, 100);
+    EXPECT_EQ(cp.done_count(), 2u);
+    EXPECT_EQ(read_file(dir.file("journal")).size(), clean);
+    cp.mark_done(3);
+  }
+  Checkpoint cp(dir.path(), kJob, 100);
+  EXPECT_EQ(cp.done_count(), 3u);
+  EXPECT_TRUE(cp.is_done(3));
+}
+
+TEST(Checkpoint, ChecksumMismatchEndsReplay) {
+  TempDir dir;
+  {
+    Checkpoint cp(dir.path(), kJob, 100);
+    cp.mark_done(10);
+    cp.mark_done(20);
+    cp.mark_done(30);
+  }
+  std::vector<std::uint8_t> journal = read_file(dir.file("journal"));
+  // Corrupt the value of the second done record (chunk 20).
+  journal[kOpenRecord + kDoneRecord + 8] ^= 0x01;
+  write_file(dir.file("journal"), journal);
+
+  Checkpoint cp(dir.path(), kJob, 100);
+  EXPECT_EQ(cp.done_count(), 1u);
+  EXPECT_TRUE(cp.is_done(10));
+  // Nothing after a bad record is trusted.
+  EXPECT_FALSE(cp.is_done(20));
+  EXPECT_FALSE(cp.is_done(30));
+}
+
+TEST(Checkpoint, RefusesAnotherJobsState) {
+  TempDir dir;
+  {
+    Checkpoint cp(dir.path(), kJob, 100);
+    cp.mark_done(1);
+  }
+  EXPECT_THROW(Checkpoint(dir.path(), kJob + 1, 100), std::runtime_error);
+  EXPECT_THROW(Checkpoint(dir.path(), kJob, 101), std::runtime_error);
+  {
+    Checkpoint cp(dir.path(), kJob, 100);
+    cp.compact();
+  }
+  // Same check against the snapshot.
+  EXPECT_THROW(Checkpoint(dir.path(), kJob + 1, 100), std::runtime_error);
+}
+
+TEST(Checkpoint, MergesSnapshotAndJournal) {
+  TempDir dir;
+  {
+    Checkpoint cp(dir.path(), kJob, 200);
+    for (std::uint64_t c = 0; c < 10; ++c) cp.mark_done(c);
+    cp.compact();
+    EXPECT_EQ(cp.journal_records(), 1u);  // just the open record
+    cp.mark_done(150);
+    cp.mark_done(5);  // already in the snapshot
+    cp.mark_done(199);
+  }
+  Checkpoint cp(dir.path(), kJob, 200);
+  EXPECT_EQ(cp.done_count(), 12u);
+  EXPECT_TRUE(cp.is_done(0));
+  EXPECT_TRUE(cp.is_done(9));
+  EXPECT_TRUE(cp.is_done(150));
+  EXPECT_TRUE(cp.is_done(199));
+}
+
+TEST(Checkpoint, ReplayAfterSnapshotIsIdempotent) {
+  TempDir dir;
+  std::vector<std::uint8_t> old_journal;
+  {
+    Checkpoint cp(dir.path(), kJob, 100);
+    cp.mark_done(1);
+    cp.mark_done(2);
+    cp.sync();
+    old_journal = read_file(dir.file("journal"));
+    cp.compact();
+  }
+  // A crash after the snapshot rename but before the journal was emptied.
+  write_file(dir.file("journal"), old_journal);
+  Checkpoint cp(dir.path(), kJob, 100);
+  EXPECT_EQ(cp.done_count(), 2u);
+}
+
+TEST(Checkpoint, RejectsCorruptSnapshot) {
+  TempDir dir;
+  {
+    Checkpoint cp(dir.path(), kJob, 100);
+    cp.mark_done(1);
+    cp.compact();
+  }
+  std::vector<std::uint8_t> snapshot = read_file(dir.file("snapshot"));
+  snapshot[snapshot.size() - 8] ^= 0x40;
+  write_file(dir.file("snapshot"), snapshot);
+  EXPECT_THROW(Checkpoint(dir.path(), kJob, 100), std::runtime_error);
+}
+
+TEST(Checkpoint, KeepsFoundKey) {
+  TempDir dir;
+  {
+    Checkpoint cp(dir.path(), kJob, 100);
+    cp.record_found(4242, "correct horse");
+    cp.record_found(1, "ignored");  // the first result wins
+  }
+  {
+    Checkpoint cp(dir.path(), kJob, 100);
+    ASSERT_TRUE(cp.found());
+    EXPECT_EQ(cp.found()->index, 4242u);
+    EXPECT_EQ(cp.found()->candidate, "correct horse");
+    cp.compact();
+  }
+  Checkpoint cp(dir.path(), kJob, 100);
+  ASSERT_TRUE(cp.found());
+  EXPECT_EQ(cp.found()->candidate, "correct horse");
+}
+
+TEST(Checkpoint, RefusesKeysTooLongForARecord) {
+  TempDir dir;
+  {
+    Checkpoint cp(dir.path(), kJob, 100);
+    EXPECT_THROW(cp.record_found(1, std::string(Checkpoint::kMaxCandidate + 1, 'x')), std::invalid_argument);
+    EXPECT_FALSE(cp.found());
+    cp.record_found(2, std::string(Checkpoint::kMaxCandidate, 'y'));
+  }
+  Checkpoint cp(dir.path(), kJob, 100);
+  ASSERT_TRUE(cp.found());
+  EXPECT_EQ(cp.found()->candidate, std::string(Checkpoint::kMaxCandidate, 'y'));
+}
+
+std::vector<std::pair<std::uint64_t, std::string>> visit_all(const Keyspace& keyspace, std::uint64_t first,
+                                                            std::uint64_t count) {
+  std::vector<std::pair<std::uint64_t, std::string>> out;
+  keyspace.enumerate(first, count, [&](std::uint64_t index, std::string_view candidate) {
+    out.emplace_back(index, candidate);
+    return true;
+  });
+  return out;
+}
+
+TEST(Keyspace, LastChunkOfAHugeMaskIsEnumerated) {
+  // 95^9 * 26 candidates, about 0.89 * 2^64.
+  const auto keyspace = open_keyspace("mask:?a?a?a?a?a?a?a?a?a?l", 4096);
+  const std::uint64_t size = keyspace->size();
+  ASSERT_GT(size, std::numeric_limits<std::uint64_t>::max() / 2);
+
+  // A chunk size that makes first + count wrap past 2^64.
+  const auto tail = visit_all(*keyspace, size - 3, std::uint64_t{1} << 63);
+  ASSERT_EQ(tail.size(), 3u);
+  EXPECT_EQ(tail[0].first, size - 3);
+  EXPECT_EQ(tail[2].first, size - 1);
+  EXPECT_EQ(tail[2].second, "~~~~~~~~~z");
+  EXPECT_EQ(tail[1].second, "~~~~~~~~~y");
+
+  EXPECT_TRUE(visit_all(*keyspace, size, 10).empty());
+}
+
+TEST(Keyspace, WordlistCountsPastTheEndAreCut) {
+  TempDir dir;
+  const std::string words = "alpha\nbravo\r\ncharlie\ndelta";
+  write_file(dir.file("words"), std::vector<std::uint8_t>(words.begin(), words.end()));
+  const auto keyspace = open_keyspace("wordlist:" + dir.file("words"), 2);
+  ASSERT_EQ(keyspace->size(), 4u);
+  const auto rest = visit_all(*keyspace, 1, std::numeric_limits<std::uint64_t>::max());
+  ASSERT_EQ(rest.size(), 3u);
+  EXPECT_EQ(rest[0].second, "bravo");
+  EXPECT_EQ(rest[2].first, 3u);
+  EXPECT_EQ(rest[2].second, "delta");
+}
+
+JobSpec small_spec(std::uint64_t chunk_size) {
+  JobSpec spec;
+  spec.target = "target";
+  spec.keyspace = "mask:?d?d";
+  spec.chunk_size = chunk_size;
+  return spec;
+}
+
+TEST(JobManager, CountsChunksWithoutOverflow) {
+  TempDir dir;
+  constexpr std::uint64_t kMax = std::numeric_limits<std::uint64_t>::max();
+  EXPECT_EQ(JobManager(small_spec(kMax), kMax, dir.path()).total_chunks(), 1u);
+  TempDir dir2;
+  EXPECT_EQ(JobManager(small_spec(std::uint64_t{1} << 63), kMax, dir2.path()).total_chunks(), 2u);
+  TempDir dir3;
+  EXPECT_EQ(JobManager(small_spec(40), 100, dir3.path()).total_chunks(), 3u);
+}
+
+TEST(JobManager, RefusesJobsAboveTheChunkLimit) {
+  TempDir dir;
+  EXPECT_THROW(JobManager(small_spec(4096), JobManager::kMaxChunks * 4096 + 1, dir.path()), std::invalid_argument);
+  EXPECT_THROW(JobManager(small_spec(1), std::numeric_limits<std::uint64_t>::max(), dir.path()),
+               std::invalid_argument);
+  EXPECT_THROW(JobManager(small_spec(0), 100, dir.path()), std::invalid_argument);
+}
+
+TEST(JobManager, LeasesEveryChunkOnceAndFinishes) {
+  TempDir dir;
+  JobManager jobs(small_spec(40), 100, dir.path());
+  EXPECT_EQ(jobs.lease(), 0u);
+  EXPECT_EQ(jobs.lease(), 1u);
+  EXPECT_EQ(jobs.lease(), 2u);
+  EXPECT_FALSE(jobs.lease());
+  EXPECT_TRUE(jobs.complete(2));
+  EXPECT_TRUE(jobs.complete(0));
+  EXPECT_FALSE(jobs.complete(1));  // the last one finishes the job
+  EXPECT_TRUE(jobs.finished());
+
+  const JobProgress p = jobs.progress();
+  EXPECT_EQ(p.done_chunks, 3u);
+  EXPECT_EQ(p.done_candidates, 100u);  // last chunk is short
+  EXPECT_EQ(p.leased, 0u);
+}
+
+TEST(JobManager, ExpiredLeasesAreHandedOutAgain) {
+  TempDir dir;
+  JobManager::Options options;
+  options.lease_timeout = std::chrono::seconds(0);
+  JobManager jobs(small_spec(40), 100, dir.path(), options);
+  EXPECT_EQ(jobs.lease(), 0u);
+  jobs.tick();
+  EXPECT_EQ(jobs.lease(), 0u);
+}
+
+TEST(JobManager, RenewAfterTheKeyIsFoundReturnsTheLease) {
+  TempDir dir;
+  JobManager jobs(small_spec(40), 100, dir.path());
+  EXPECT_EQ(jobs.lease(), 0u);
+  EXPECT_EQ(jobs.lease(), 1u);
+  EXPECT_TRUE(jobs.renew(1));
+  jobs.found(45, "found-it");  // in chunk 1; that lease is released too
+  EXPECT_FALSE(jobs.renew(0));
+  EXPECT_EQ(jobs.progress().leased, 0u);
+  EXPECT_FALSE(jobs.lease());
+  EXPECT_TRUE(jobs.finished());
+}
+
+// A coordinator on an ephemeral loopback port, polled on its own thread.
+class Cluster {
+ public:
+  Cluster(JobManager& jobs, std::string token = {}) : coordinator_(jobs, "127.0.0.1:0", std::move(token)) {
+    thread_ = std::thread([this] {
+      while (!stop_.load()) coordinator_.poll(20);
+    });
+  }
+  ~Cluster() {
+    stop_.store(true);
+    thread_.join();
+  }
+
+  std::string address() const { return "127.0.0.1:" + std::to_string(coordinator_.port()); }
+
+ private:
+  Coordinator coordinator_;
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+};
+
+RemoteWorkSource::Options worker(const char* name, std::string token = {}) {
+  RemoteWorkSource::Options options;
+  options.name = name;
+  options.token = std::move(token);
+  options.connect_timeout = std::chrono::seconds(2);
+  return options;
+}
+
+TEST(Cluster, BusyWorkersHearFinished) {
+  TempDir dir;
+  JobManager jobs(small_spec(40), 100, dir.path());
+  Cluster cluster(jobs);
+  std::atomic<bool> stop{false};
+  RemoteWorkSource a(cluster.address(), worker("a"), stop);
+  RemoteWorkSource b(cluster.address(), worker("b"), stop);
+  EXPECT_EQ(a.spec().chunk_size, 40u);
+
+  bool finished = false;
+  EXPECT_EQ(a.lease(finished), 0u);
+  EXPECT_EQ(b.lease(finished), 1u);
+  EXPECT_EQ(b.lease(finished), 2u);
+  EXPECT_TRUE(a.renew(0));
+  EXPECT_TRUE(b.complete(1));
+  EXPECT_TRUE(b.complete(2));
+  EXPECT_FALSE(b.lease(finished));
+  EXPECT_FALSE(finished);  // chunk 0 is still out: WAIT
+  EXPECT_FALSE(a.complete(0));
+  EXPECT_FALSE(b.lease(finished));
+  EXPECT_TRUE(finished);
+  EXPECT_EQ(jobs.progress().leased, 0u);
+}
+
+TEST(Cluster, RenewAfterRemoteFoundSaysFinished) {
+  TempDir dir;
+  const PmkidTarget target = PmkidTarget::from_passphrase("passwd77", "lab", MacAddress{{2, 0, 0, 0, 0, 1}},
+                                                          MacAddress{{2, 0, 0, 0, 0, 2}});
+  JobSpec spec = small_spec(40);
+  spec.target = target.format();
+  JobManager jobs(spec, 100, dir.path());
+  Cluster cluster(jobs);
+  std::atomic<bool> stop{false};
+  RemoteWorkSource a(cluster.address(), worker("a"), stop);
+  RemoteWorkSource b(cluster.address(), worker("b"), stop);
+
+  bool finished = false;
+  EXPECT_EQ(a.lease(finished), 0u);
+  EXPECT_EQ(b.lease(finished), 1u);
+  b.found(77, "passwd77");
+  ASSERT_TRUE(jobs.result());
+  EXPECT_EQ(jobs.result()->candidate, "passwd77");
+  EXPECT_FALSE(a.renew(0));
+  EXPECT_EQ(jobs.progress().leased, 0u);
+}
+
+TEST(Cluster, FoundIndexMustBeInTheKeyspace) {
+  TempDir dir;
+  const PmkidTarget target = PmkidTarget::from_passphrase("passwd77", "lab", MacAddress{{2, 0, 0, 0, 0, 1}},
+                                                          MacAddress{{2, 0, 0, 0, 0, 2}});
+  JobSpec spec = small_spec(40);
+  spec.target = target.format();
+  JobManager jobs(spec, 100, dir.path());
+  Cluster cluster(jobs);
+  std::atomic<bool> stop{false};
+  RemoteWorkSource a(cluster.address(), worker("a"), stop);
+  bool finished = false;
+  EXPECT_EQ(a.lease(finished), 0u);
+
+  // The right key at an index the job does not have is not a result.
+  a.found(100, "passwd77");
+  a.found(std::numeric_limits<std::uint64_t>::max(), "passwd77");
+  // Nor is anything that cannot be a WPA passphrase.
+  a.found(5, std::string(300, 'x'));
+  EXPECT_FALSE(jobs.result());
+  EXPECT_TRUE(a.renew(0));
+
+  a.found(99, "passwd77");
+  ASSERT_TRUE(jobs.result());
+  EXPECT_EQ(jobs.result()->index, 99u);
+}
+
+TEST(Cluster, FinishedWorkerStopsRetryingAGoneCoordinator) {
+  TempDir dir;
+  JobManager jobs(small_spec(100), 100, dir.path());
+  std::atomic<bool> stop{false};
+  std::optional<RemoteWorkSource> a;
+  {
+    Cluster cluster(jobs);
+    a.emplace(cluster.address(), worker("a"), stop);
+    bool finished = false;
+    EXPECT_EQ(a->lease(finished), 0u);
+    jobs.complete(0);
+    EXPECT_FALSE(a->renew(0));
+  }
+  // The coordinator has exited; a late report must not hang.
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(a->complete(0));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(10));
+}
+
+TEST(Cluster, WorkerGivesUpWithoutCoordinator) {
+  TempDir dir;
+  JobManager jobs(small_spec(100), 100, dir.path());
+  std::string address;
+  {
+    Cluster cluster(jobs);
+    address = cluster.address();
+  }
+  std::atomic<bool> stop{false};
+  RemoteWorkSource::Options options = worker("late");
+  options.connect_timeout = std::chrono::seconds(1);
+  EXPECT_THROW(RemoteWorkSource(address, options, stop), std::runtime_error);
+}
+
+TEST(Cluster, TokenIsRequiredBeyondLoopbackAndChecked) {
+  TempDir dir;
+  JobManager jobs(small_spec(40), 100, dir.path());
+  EXPECT_THROW(Coordinator(jobs, "0.0.0.0:0"), std::invalid_argument);
+  EXPECT_NO_THROW(Coordinator(jobs, "0.0.0.0:0", "s3cret"));
+
+  Cluster cluster(jobs, "s3cret");
+  std::atomic<bool> stop{false};
+  EXPECT_THROW(RemoteWorkSource(cluster.address(), worker("a", "wrong"), stop), std::runtime_error);
+  EXPECT_THROW(RemoteWorkSource(cluster.address(), worker("b"), stop), std::runtime_error);
+  RemoteWorkSource ok(cluster.address(), worker("c", "s3cret"), stop);
+  bool finished = false;
+  EXPECT_EQ(ok.lease(finished), 0u);
+}
+
+}  // namespace
+}  // namespace etheros::crack
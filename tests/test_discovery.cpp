@@ -0,0 +1,547 @@
+// Discovery: DNS-format and SSDP parsing of hostile input, what the harvester
+// records and how it escapes it, and the inventory caps.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "etheros/discovery/dns.hpp"
+#include "etheros/discovery/harvester.hpp"
+#include "etheros/discovery/inventory.hpp"
+#include "etheros/discovery/ssdp.hpp"
+#include "test_support.hpp"
+
+namespace etheros::discovery {
+namespace {
+
+constexpr std::uint64_t kTs = 1'700'000'000ull * 1'000'000'000;
+
+IpAddress ipv4(std::uint32_t addr) {
+  std::uint8_t b[4];
+  store_be32(b, addr);
+  return IpAddress::from_v4(b);
+}
+
+// A decoded UDP packet from src to a discovery port; payload must outlive it.
+parse::DecodedPacket udp_packet(std::uint32_t src, std::uint16_t port, ByteSpan payload) {
+  parse::DecodedPacket p;
+  p.layers = parse::kLayerL2 | parse::kLayerIp | parse::kLayerUdp;
+  p.ip_version = 4;
+  p.ip_proto = 17;
+  p.src_mac = MacAddress{{2, 0, 0, 0, 0, static_cast<std::uint8_t>(src)}};
+  p.src_ip = ipv4(src);
+  p.dst_ip = ipv4(0xeffffffa);
+  p.src_port = port;
+  p.dst_port = port;
+  p.payload = payload;
+  return p;
+}
+
+ByteSpan bytes_of(const std::string& s) { return ByteSpan(reinterpret_cast<const std::uint8_t*>(s.data()), s.size()); }
+
+std::string ssdp_notify(std::string_view type) {
+  return "NOTIFY * HTTP/1.1\r\nHOST: 239.255.255.250:1900\r\nNT: " + std::string(type) +
+         "\r\nNTS: ssdp:alive\r\nLOCATION: http://10.0.0.1/desc.xml\r\nSERVER: test/1.0\r\n\r\n";
+}
+
+// Raw DNS-format message builder; counts are given up front so tests can
+// also lie about them.
+class Dns {
+ public:
+  Dns(std::uint16_t flags, std::uint16_t qd, std::uint16_t an, std::uint16_t ns = 0, std::uint16_t ar = 0) {
+    for (std::uint16_t v : {std::uint16_t{0}, flags, qd, an, ns, ar}) u16(v);
+  }
+
+  Dns& u8(std::uint8_t v) {
+    bytes.push_back(v);
+    return *this;
+  }
+  Dns& u16(std::uint16_t v) { return u8(static_cast<std::uint8_t>(v >> 8)).u8(static_cast<std::uint8_t>(v)); }
+  Dns& u32(std::uint32_t v) { return u16(static_cast<std::uint16_t>(v >> 16)).u16(static_cast<std::uint16_t>(v)); }
+  Dns& raw(std::string_view s) {
+    bytes.insert(bytes.end(), s.begin(), s.end());
+    return *this;
+  }
+  // Labels of a dotted name, without the terminating zero.
+  Dns& labels(std::string_view dotted) {
+    while (!dotted.empty()) {
+      const std::size_t dot = dotted.find('.');
+      const std::string_view label = dotted.substr(0, dot);
+      u8(static_cast<std::uint8_t>(label.size())).raw(label);
+      dotted.remove_prefix(dot == std::string_view::npos ? dotted.size() : dot + 1);
+    }
+    return *this;
+  }
+  Dns& name(std::string_view dotted) { return labels(dotted).u8(0); }
+  Dns& pointer(std::size_t offset) {
+    return u8(static_cast<std::uint8_t>(0xc0 | offset >> 8)).u8(static_cast<std::uint8_t>(offset));
+  }
+  Dns& question(std::uint16_t type) { return u16(type).u16(1); }
+  // Type, class, TTL and rdata length; the rdata follows.
+  Dns& record(std::uint16_t type, std::uint16_t rdlen) { return u16(type).u16(1).u32(120).u16(rdlen); }
+
+  std::size_t size() const { return bytes.size(); }
+  ByteSpan span() const { return bytes; }
+
+  std::vector<std::uint8_t> bytes;
+};
+
+std::vector<DnsRecord> walk(const DnsReader& reader_in) {
+  DnsReader reader = reader_in;
+  std::vector<DnsRecord> out;
+  DnsRecord rr;
+  while (reader.next(rr)) out.push_back(rr);
+  return out;
+}
+
+TEST(DnsReader, WalksEverySection) {
+  Dns m(0x8400, 1, 1, 1, 1);
+  m.name("printer.local").question(kDnsA);
+  m.name("printer.local").record(kDnsA, 4).u32(0x0a000007);
+  m.name("other.local").record(kDnsAaaa, 0);
+  m.name("x.local").record(kDnsTxt, 3).raw("\x02hi");
+  DnsReader reader(m.span());
+  ASSERT_TRUE(reader.valid());
+  EXPECT_TRUE(reader.is_response());
+  const std::vector<DnsRecord> records = walk(reader);
+  ASSERT_EQ(records.size(), 4u);
+  EXPECT_EQ(records[0].section, DnsSection::kQuestion);
+  EXPECT_EQ(records[1].section, DnsSection::kAnswer);
+  EXPECT_EQ(records[1].rdata.size(), 4u);
+  EXPECT_EQ(records[2].section, DnsSection::kAuthority);
+  EXPECT_EQ(records[3].section, DnsSection::kAdditional);
+  EXPECT_EQ(records[3].type, kDnsTxt);
+}
+
+TEST(DnsReader, FollowsBackwardPointers) {
+  Dns m(0x8400, 1, 1);
+  m.name("printer.local").question(kDnsA);
+  const std::size_t answer = m.size();
+  m.labels("fax").pointer(12 + 8).record(kDnsA, 4).u32(1);  // "fax" + "local"
+  DnsReader reader(m.span());
+  DnsName name;
+  ASSERT_TRUE(reader.name(answer, name));
+  EXPECT_EQ(name.view(), "fax.local");
+  ASSERT_EQ(walk(reader).size(), 2u);
+}
+
+TEST(DnsReader, RejectsForwardAndSelfPointers) {
+  Dns m(0, 1, 0);
+  m.pointer(14).question(kDnsA);  // points past itself
+  m.name("later.local");
+  DnsReader reader(m.span());
+  DnsName name;
+  EXPECT_FALSE(reader.name(12, name));
+
+  Dns self(0, 1, 0);
+  self.pointer(12).question(kDnsA);
+  EXPECT_FALSE(DnsReader(self.span()).name(12, name));
+}
+
+TEST(DnsReader, BoundsPointerChains) {
+  // Each pointer points at the previous one, ending at a real name.
+  Dns m(0, 0, 0);
+  m.name("a");
+  std::vector<std::size_t> chain = {12};
+  for (int i = 0; i < 20; ++i) {
+    chain.push_back(m.size());
+    m.pointer(chain[chain.size() - 2]);
+  }
+  DnsReader reader(m.span());
+  DnsName name;
+  EXPECT_TRUE(reader.name(chain[16], name));  // 16 jumps
+  EXPECT_EQ(name.view(), "a");
+  EXPECT_FALSE(reader.name(chain[17], name));
+}
+
+TEST(DnsReader, StopsAtTruncatedRecords) {
+  DnsName name;
+  EXPECT_FALSE(DnsReader(ByteSpan(Dns(0, 0, 0).bytes.data(), 11)).valid());
+
+  // Claims an answer, ends inside its fixed part.
+  Dns fixed(0x8400, 0, 1);
+  fixed.name("a.local").u16(kDnsA).u16(1);
+  DnsReader r1(fixed.span());
+  DnsRecord rr;
+  EXPECT_FALSE(r1.next(rr));
+  EXPECT_FALSE(r1.valid());
+
+  // rdata length past the end.
+  Dns rdata(0x8400, 0, 1);
+  rdata.name("a.local").record(kDnsA, 40).u32(1);
+  DnsReader r2(rdata.span());
+  EXPECT_FALSE(r2.next(rr));
+  EXPECT_FALSE(r2.valid());
+
+  // A label running past the end, and a pointer cut in half.
+  Dns label(0, 1, 0);
+  label.u8(30).raw("short");
+  EXPECT_FALSE(DnsReader(label.span()).name(12, name));
+  EXPECT_TRUE(walk(DnsReader(label.span())).empty());
+  Dns half(0, 1, 0);
+  half.u8(0xc0);
+  EXPECT_FALSE(DnsReader(half.span()).name(12, name));
+  EXPECT_TRUE(walk(DnsReader(half.span())).empty());
+
+  // Good records before the damage are still returned.
+  Dns partial(0x8400, 0, 2);
+  partial.name("ok.local").record(kDnsA, 4).u32(1);
+  partial.name("bad.local").record(kDnsA, 4).u16(1);
+  DnsReader r3(partial.span());
+  EXPECT_TRUE(r3.next(rr));
+  EXPECT_FALSE(r3.next(rr));
+  EXPECT_FALSE(r3.valid());
+}
+
+TEST(DnsReader, RejectsReservedLabelTypes) {
+  Dns m(0, 1, 0);
+  m.u8(0x40).u8(0).question(kDnsA);
+  DnsName name;
+  EXPECT_FALSE(DnsReader(m.span()).name(12, name));
+  EXPECT_TRUE(walk(DnsReader(m.span())).empty());
+}
+
+std::string netbios_label(std::string_view name, std::uint8_t suffix, char pad = ' ') {
+  std::string raw(name);
+  raw.resize(15, pad);
+  raw.push_back(static_cast<char>(suffix));
+  std::string label;
+  for (unsigned char c : raw) {
+    label.push_back(static_cast<char>('A' + (c >> 4)));
+    label.push_back(static_cast<char>('A' + (c & 0xf)));
+  }
+  return label;
+}
+
+TEST(NetbiosName, DecodesNameAndSuffix) {
+  DnsName out;
+  ASSERT_TRUE(decode_netbios_name(netbios_label("WORKGROUP", 0x1d), out));
+  EXPECT_EQ(out.view(), "WORKGROUP<1d>");
+  ASSERT_TRUE(decode_netbios_name(netbios_label("FILESRV", 0x20, '\0'), out));
+  EXPECT_EQ(out.view(), "FILESRV<20>");
+  ASSERT_TRUE(decode_netbios_name(netbios_label("*", 0x00, '\0'), out));
+  EXPECT_EQ(out.view(), "*<00>");
+  // A scope id follows as further labels.
+  ASSERT_TRUE(decode_netbios_name(netbios_label("PC-7", 0x00) + ".corp.example", out));
+  EXPECT_EQ(out.view(), "PC-7<00>");
+}
+
+TEST(NetbiosName, RejectsOtherNames) {
+  DnsName out;
+  const std::string good = netbios_label("PC", 0x00);
+  EXPECT_FALSE(decode_netbios_name(good.substr(0, 31), out));
+  EXPECT_FALSE(decode_netbios_name(good + "A", out));
+  EXPECT_FALSE(decode_netbios_name("printer.local", out));
+  std::string lower = good;
+  lower[4] = 'a';
+  EXPECT_FALSE(decode_netbios_name(lower, out));
+  std::string past_p = good;
+  past_p[0] = 'Q';
+  EXPECT_FALSE(decode_netbios_name(past_p, out));
+}
+
+TEST(NetbiosName, DecodesInPlace) {
+  // The harvester decodes into the buffer the label came from.
+  DnsName name;
+  const std::string label = netbios_label("INPLACE", 0x03);
+  label.copy(name.text, label.size());
+  name.size = label.size();
+  ASSERT_TRUE(decode_netbios_name(name.view(), name));
+  EXPECT_EQ(name.view(), "INPLACE<03>");
+}
+
+TEST(Ssdp, ParsesStartLinesAndHeadersInAnyCase) {
+  SsdpMessage msg;
+  const std::string notify =
+      "NOTIFY * HTTP/1.1\r\nnt:  urn:a:device:1 \r\nLocation:http://10.0.0.1/d.xml\r\nsErVeR: os/1 upnp/1.0\r\n"
+      "Nts: ssdp:alive\r\nusn: uuid:1\r\n\r\n";
+  ASSERT_TRUE(parse_ssdp(bytes_of(notify), msg));
+  EXPECT_EQ(msg.kind, SsdpMessage::Kind::kNotify);
+  EXPECT_EQ(msg.type, "urn:a:device:1");
+  EXPECT_EQ(msg.location, "http://10.0.0.1/d.xml");
+  EXPECT_EQ(msg.server, "os/1 upnp/1.0");
+  EXPECT_EQ(msg.nts, "ssdp:alive");
+  EXPECT_EQ(msg.usn, "uuid:1");
+
+  const std::string search = "M-SEARCH * HTTP/1.1\nST: ssdp:all\nMAN: \"ssdp:discover\"";  // bare LF, no end
+  ASSERT_TRUE(parse_ssdp(bytes_of(search), msg));
+  EXPECT_EQ(msg.kind, SsdpMessage::Kind::kSearch);
+  EXPECT_EQ(msg.type, "ssdp:all");
+  EXPECT_TRUE(msg.location.empty());
+
+  ASSERT_TRUE(parse_ssdp(bytes_of("HTTP/1.1 200 OK\r\nST: upnp:rootdevice\r\n\r\n"), msg));
+  EXPECT_EQ(msg.kind, SsdpMessage::Kind::kResponse);
+}
+
+TEST(Ssdp, FoldedLinesAreNotHeaders) {
+  SsdpMessage msg;
+  const std::string folded =
+      "NOTIFY * HTTP/1.1\r\nNT: urn:a\r\nSERVER: os/1\r\n LOCATION: http://folded/\r\n\tNTS: ssdp:byebye\r\n"
+      "\r\nLOCATION: http://body/\r\n";
+  ASSERT_TRUE(parse_ssdp(bytes_of(folded), msg));
+  EXPECT_EQ(msg.server, "os/1");
+  EXPECT_TRUE(msg.location.empty());
+  EXPECT_TRUE(msg.nts.empty());
+}
+
+TEST(Ssdp, RejectsOtherTraffic) {
+  SsdpMessage msg;
+  EXPECT_FALSE(parse_ssdp(ByteSpan(), msg));
+  EXPECT_FALSE(parse_ssdp(bytes_of("NOTIFY * HTTP/1.1"), msg));  // no line end
+  EXPECT_FALSE(parse_ssdp(bytes_of("GET / HTTP/1.1\r\nHost: x\r\n\r\n"), msg));
+  EXPECT_FALSE(parse_ssdp(bytes_of("notify * HTTP/1.1\r\n\r\n"), msg));
+}
+
+TEST(Harvester, KnownAnswersInAQueryAreNotFacts) {
+  Harvester harvester;
+  // A query for printers listing the answers the asker already has cached.
+  Dns m(0, 1, 2);
+  m.name("_ipp._tcp.local").question(kDnsPtr);
+  const std::string instance = "Office._ipp._tcp.local";
+  m.name("_ipp._tcp.local").record(kDnsPtr, static_cast<std::uint16_t>(instance.size() + 2)).name(instance);
+  m.name("printer.local").record(kDnsA, 4).u32(0x0a000063);
+  harvester.process(kTs, udp_packet(0x0a000001, kMdnsPort, m.span()));
+
+  const auto& facts = harvester.inventory().facts();
+  ASSERT_EQ(facts.size(), 1u);
+  EXPECT_EQ(facts[0].kind, FactKind::kQuery);
+  EXPECT_EQ(harvester.inventory().hosts().size(), 1u);  // not 10.0.0.99
+
+  // The same records in a response are facts.
+  Dns r(0x8400, 0, 2);
+  r.name("_ipp._tcp.local").record(kDnsPtr, static_cast<std::uint16_t>(instance.size() + 2)).name(instance);
+  r.name("printer.local").record(kDnsA, 4).u32(0x0a000063);
+  harvester.process(kTs, udp_packet(0x0a000001, kMdnsPort, r.span()));
+  EXPECT_EQ(facts.size(), 3u);
+}
+
+TEST(Harvester, ProbesSpeakForTheAsker) {
+  Harvester harvester;
+  Dns m(0, 1, 0, 1);
+  m.name("new-host.local").question(255);
+  m.name("new-host.local").record(kDnsA, 4).u32(0x0a000005);
+  harvester.process(kTs, udp_packet(0x0a000005, kMdnsPort, m.span()));
+  const auto& facts = harvester.inventory().facts();
+  ASSERT_EQ(facts.size(), 2u);
+  EXPECT_EQ(facts[1].kind, FactKind::kName);
+  EXPECT_EQ(harvester.inventory().strings().get(facts[1].a), "new-host.local");
+}
+
+TEST(Harvester, EscapesNamesThatAreNotUtf8) {
+  test::TempDir dir;
+  {
+    io::FdWriter out = io::FdWriter::open(dir.file("out.jsonl"));
+    Harvester harvester(&out);
+    const std::string label =
+        "a\"b\\c\x01\x1f\x7f"           // quote, backslash, control bytes
+        "\xc3\xa9\xf0\x9f\x98\x80"      // valid two- and four-byte sequences
+        "\xff\xc3(\xc0\xaf\xed\xa0\x80"  // invalid byte, cut sequence, overlong, surrogate
+        "\xe2\x82";                     // truncated at the end
+    Dns m(0x8400, 0, 1);
+    m.u8(static_cast<std::uint8_t>(label.size())).raw(label).u8(0).record(kDnsA, 4).u32(0x0a000002);
+    harvester.process(kTs, udp_packet(0x0a000002, kMdnsPort, m.span()));
+    out.close();
+  }
+  const std::vector<std::uint8_t> written = test::read_file(dir.file("out.jsonl"));
+  const std::string line(written.begin(), written.end());
+  const std::string expected =
+      R"("name":"a\"b\\c\u0001\u001f\u007f)"
+      "\xc3\xa9\xf0\x9f\x98\x80"
+      R"(\u00ff\u00c3(\u00c0\u00af\u00ed\u00a0\u0080\u00e2\u0082"})";
+  EXPECT_NE(line.find(expected), std::string::npos) << line;
+  EXPECT_EQ(line.back(), '\n');
+}
+
+TEST(Harvester, SsdpWithoutTypeOrLocationIsNotADevice) {
+  Harvester harvester;
+  const std::string bare[] = {
+      "NOTIFY * HTTP/1.1\r\nHOST: 239.255.255.250:1900\r\nNTS: ssdp:alive\r\nSERVER: test/1.0\r\n\r\n",
+      "HTTP/1.1 200 OK\r\nCACHE-CONTROL: max-age=1800\r\n\r\n",
+  };
+  for (const std::string& payload : bare) harvester.process(kTs, udp_packet(0x0a000007, kSsdpPort, bytes_of(payload)));
+  EXPECT_TRUE(harvester.inventory().facts().empty());
+  EXPECT_EQ(harvester.inventory().hosts().size(), 1u);
+
+  // A location alone is enough.
+  const std::string located = "HTTP/1.1 200 OK\r\nLOCATION: http://10.0.0.7/desc.xml\r\n\r\n";
+  harvester.process(kTs, udp_packet(0x0a000007, kSsdpPort, bytes_of(located)));
+  ASSERT_EQ(harvester.inventory().facts().size(), 1u);
+  EXPECT_EQ(harvester.inventory().facts()[0].kind, FactKind::kDevice);
+}
+
+TEST(Harvester, NbnsRegistrationNamesTheAddress) {
+  Harvester harvester;
+  // Opcode 5 (registration), one question and one additional NB record.
+  const std::string label = netbios_label("FILESRV", 0x20);
+  Dns m(5 << 11, 1, 0, 0, 1);
+  m.name(label).question(kNbnsNb);
+  m.name(label).record(kNbnsNb, 6).u16(0).u32(0x0a000010);
+  harvester.process(kTs, udp_packet(0x0a000010, kNbnsPort, m.span()));
+  const auto& facts = harvester.inventory().facts();
+  ASSERT_EQ(facts.size(), 1u);
+  EXPECT_EQ(facts[0].kind, FactKind::kName);
+  EXPECT_EQ(harvester.inventory().strings().get(facts[0].a), "FILESRV<20>");
+}
+
+// Random bytes and randomly damaged real messages through every parser and
+// the harvester. Meant to be run under ETHEROS_SANITIZE, where any read past
+// a buffer fails the test.
+TEST(DiscoveryFuzz, SurvivesRandomPackets) {
+  std::uint64_t state = 0x9e3779b97f4a7c15ull;
+  auto next = [&state] {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  };
+
+  std::vector<std::vector<std::uint8_t>> seeds;
+  {
+    Dns m(0x8400, 1, 2, 1, 1);
+    m.name("_ipp._tcp.local").question(kDnsPtr);
+    m.pointer(12).record(kDnsPtr, 9).labels("Office").pointer(12);
+    m.name("Office._ipp._tcp.local").record(kDnsSrv, 8).u16(0).u16(0).u16(631).pointer(12 + 5);
+    m.name("p.local").record(kDnsA, 4).u32(0x0a000001);
+    m.name("p.local").record(kDnsAaaa, 16).u32(0xfe800000).u32(0).u32(0).u32(1);
+    seeds.push_back(m.bytes);
+    const std::string label = netbios_label("PC", 0);
+    Dns n(0x8500, 0, 1);
+    n.name(label).record(kNbnsNb, 12).u16(0).u32(0x0a000002).u16(0).u32(0x0a000003);
+    seeds.push_back(n.bytes);
+    const std::string ssdp = ssdp_notify("urn:schemas-upnp-org:device:Printer:1");
+    seeds.emplace_back(ssdp.begin(), ssdp.end());
+  }
+  constexpr std::uint16_t kPorts[] = {kMdnsPort, kLlmnrPort, kNbnsPort, kSsdpPort};
+
+  Harvester harvester;
+  std::vector<std::uint8_t> packet;
+  for (int i = 0; i < 50000; ++i) {
+    if (i % 4 == 0) {
+      packet.resize(next() % 600);
+      for (auto& b : packet) b = static_cast<std::uint8_t>(next());
+    } else {
+      packet = seeds[next() % seeds.size()];
+      for (int flips = 1 + static_cast<int>(next() % 4); flips > 0; --flips)
+        packet[next() % packet.size()] = static_cast<std::uint8_t>(next());
+      if (next() % 3 == 0) packet.resize(next() % (packet.size() + 1));
+    }
+    // Exact-size heap copy, so ASan sees any overrun.
+    const auto copy = std::make_unique<std::uint8_t[]>(packet.size());
+    std::copy(packet.begin(), packet.end(), copy.get());
+    const ByteSpan span(copy.get(), packet.size());
+
+    DnsReader reader(span);
+    DnsRecord rr;
+    DnsName name;
+    while (reader.next(rr)) {
+      if (reader.name(rr.name_offset, name)) {
+        ASSERT_LE(name.size, sizeof(name.text));
+        decode_netbios_name(name.view(), name);
+      }
+      reader.name(rr.rdata_offset, name);
+    }
+    reader.name(next() % (span.size() + 2), name);
+    SsdpMessage msg;
+    parse_ssdp(span, msg);
+    harvester.process(kTs, udp_packet(0x0a000000 | static_cast<std::uint32_t>(next() % 64), kPorts[next() % 4], span));
+  }
+  EXPECT_GT(harvester.stats().malformed, 0u);
+  EXPECT_GT(harvester.inventory().facts().size(), 0u);
+}
+
+TEST(StringTable, InternsOnceAndTruncates) {
+  StringTable strings;
+  const std::uint32_t a = strings.intern("printer.local");
+  EXPECT_NE(a, 0u);
+  EXPECT_EQ(strings.intern("printer.local"), a);
+  EXPECT_EQ(strings.intern(""), 0u);
+  EXPECT_EQ(strings.get(a), "printer.local");
+  const std::string long_name(300, 'x');
+  EXPECT_EQ(strings.get(strings.intern(long_name)), long_name.substr(0, 255));
+  EXPECT_EQ(strings.size(), 2u);
+}
+
+TEST(StringTable, RefusesNewStringsPastTheCap) {
+  StringTable strings(16);
+  const std::uint32_t a = strings.intern("0123456789");  // 11 bytes with its length
+  ASSERT_NE(a, kNoString);
+  EXPECT_EQ(strings.intern("abcdef"), kNoString);
+  EXPECT_NE(strings.intern("abcd"), kNoString);  // exactly fills it
+  EXPECT_EQ(strings.intern("z"), kNoString);
+  EXPECT_EQ(strings.intern("0123456789"), a);  // known strings still resolve
+  EXPECT_EQ(strings.size(), 2u);
+}
+
+TEST(StringTable, CapMustLeaveRoomForIds) {
+  EXPECT_THROW(StringTable(std::size_t{1} << 32), std::invalid_argument);
+}
+
+TEST(Inventory, RefusesNewHostsPastTheCap) {
+  InventoryOptions options;
+  options.max_hosts = 2;
+  Inventory inv(options);
+  const std::uint32_t a = inv.touch_host(ipv4(0x0a000001), MacAddress{}, 1);
+  const std::uint32_t b = inv.touch_host(ipv4(0x0a000002), MacAddress{}, 1);
+  EXPECT_EQ(inv.touch_host(ipv4(0x0a000003), MacAddress{}, 2), kNoHost);
+  EXPECT_EQ(inv.touch_host(ipv4(0x0a000001), MacAddress{}, 3), a);
+  EXPECT_EQ(inv.touch_host(ipv4(0x0a000002), MacAddress{}, 3), b);
+  EXPECT_EQ(inv.hosts().size(), 2u);
+  EXPECT_EQ(inv.hosts()[a].last_seen_s, 3u);
+}
+
+TEST(Inventory, RefusesNewFactsPastTheCap) {
+  InventoryOptions options;
+  options.max_facts = 2;
+  Inventory inv(options);
+  const std::uint32_t host = inv.touch_host(ipv4(0x0a000001), MacAddress{}, 1);
+  const Fact first{host, FactKind::kName, Protocol::kMdns, 0, inv.strings().intern("a.local")};
+  const Fact second{host, FactKind::kName, Protocol::kMdns, 0, inv.strings().intern("b.local")};
+  const Fact third{host, FactKind::kName, Protocol::kMdns, 0, inv.strings().intern("c.local")};
+  EXPECT_EQ(inv.add(first), AddResult::kAdded);
+  EXPECT_EQ(inv.add(second), AddResult::kAdded);
+  EXPECT_EQ(inv.add(third), AddResult::kFull);
+  EXPECT_EQ(inv.add(first), AddResult::kKnown);
+  EXPECT_EQ(inv.facts().size(), 2u);
+}
+
+TEST(Harvester, CountsWhatTheInventoryRefuses) {
+  InventoryOptions options;
+  options.max_hosts = 2;
+  options.max_facts = 3;
+  Harvester harvester(nullptr, options);
+  std::vector<std::string> payloads;
+  for (int i = 0; i < 6; ++i) payloads.push_back(ssdp_notify("urn:test:device:" + std::to_string(i)));
+
+  // Two hosts fill the host table; three devices fill the fact table.
+  for (int i = 0; i < 4; ++i) harvester.process(kTs, udp_packet(0x0a000001 + i % 2, kSsdpPort, bytes_of(payloads[i])));
+  harvester.process(kTs, udp_packet(0x0a000009, kSsdpPort, bytes_of(payloads[4])));
+  harvester.process(kTs, udp_packet(0x0a000001, kSsdpPort, bytes_of(payloads[0])));  // known
+
+  const HarvestStats& s = harvester.stats();
+  EXPECT_EQ(s.new_facts, 3u);
+  EXPECT_EQ(s.rejected_facts, 1u);
+  EXPECT_EQ(s.rejected_hosts, 1u);
+  EXPECT_EQ(s.rejected_strings, 0u);
+  EXPECT_EQ(harvester.inventory().hosts().size(), 2u);
+  EXPECT_EQ(harvester.inventory().facts().size(), 3u);
+}
+
+TEST(Harvester, DropsFactsWhoseStringsDidNotFit) {
+  InventoryOptions options;
+  options.max_string_bytes = 128;
+  Harvester harvester(nullptr, options);
+  const std::string payload = ssdp_notify("urn:schemas-upnp-org:device:a-rather-long-device-type-name:1");
+  const std::string other = ssdp_notify("urn:schemas-upnp-org:device:another-long-device-type-name:1");
+  harvester.process(kTs, udp_packet(0x0a000001, kSsdpPort, bytes_of(payload)));
+  harvester.process(kTs, udp_packet(0x0a000001, kSsdpPort, bytes_of(other)));
+  EXPECT_EQ(harvester.stats().new_facts, 1u);
+  EXPECT_EQ(harvester.stats().rejected_strings, 1u);
+  EXPECT_EQ(harvester.inventory().facts().size(), 1u);
+}
+
+}  // namespace
+}  // namespace etheros::discovery
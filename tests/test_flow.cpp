@@ -0,0 +1,353 @@
+// TCP reassembly edge cases, timing-wheel expiry and the flow index under
+// churn.
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "etheros/flow/flow_table.hpp"
+#include "flow_packets.hpp"
+
+namespace etheros::flow {
+namespace {
+
+using test::tcp_packet;
+
+// Each byte encodes its offset, so misplaced data shows up in comparisons.
+std::vector<std::uint8_t> reference_stream(std::size_t n) {
+  std::vector<std::uint8_t> s(n);
+  for (std::size_t i = 0; i < n; ++i) s[i] = static_cast<std::uint8_t>(i * 7 + i / 251);
+  return s;
+}
+
+class Recorder : public StreamHandler {
+ public:
+  void on_data(FlowId, Direction, ByteSpan data) override { stream.insert(stream.end(), data.begin(), data.end()); }
+  void on_gap(FlowId, Direction, std::uint32_t bytes) override { gaps.push_back(bytes); }
+  void on_close(FlowId, CloseReason reason) override { closes.push_back(reason); }
+
+  std::vector<std::uint8_t> stream;
+  std::vector<std::uint32_t> gaps;
+  std::vector<CloseReason> closes;
+};
+
+// One client-to-server stream starting at isn, sent as slices of ref.
+class StreamTest : public ::testing::Test {
+ protected:
+  void open(std::uint32_t isn, const FlowTableOptions& options = {}) {
+    isn_ = isn;
+    table_ = std::make_unique<FlowTable>(options, &recorder_);
+    table_->process(kTs, tcp_packet(1, isn - 1, parse::kTcpSyn));
+  }
+  void send(std::size_t offset, std::size_t len) {
+    table_->process(kTs, tcp_packet(1, isn_ + static_cast<std::uint32_t>(offset), parse::kTcpAck,
+                                    ByteSpan(ref_.data() + offset, len)));
+  }
+  std::vector<std::uint8_t> expected(std::initializer_list<std::pair<std::size_t, std::size_t>> ranges) const {
+    std::vector<std::uint8_t> out;
+    for (const auto& [begin, end] : ranges) out.insert(out.end(), ref_.begin() + begin, ref_.begin() + end);
+    return out;
+  }
+
+  static constexpr std::uint64_t kTs = 1'700'000'000ull * 1'000'000'000;
+  std::vector<std::uint8_t> ref_ = reference_stream(16384);
+  std::uint32_t isn_ = 0;
+  Recorder recorder_;
+  std::unique_ptr<FlowTable> table_;
+};
+
+TEST_F(StreamTest, DeliversInOrderData) {
+  open(1000);
+  send(0, 100);
+  send(100, 300);
+  EXPECT_EQ(recorder_.stream, expected({{0, 400}}));
+  EXPECT_EQ(table_->stats().delivered_bytes, 400u);
+}
+
+TEST_F(StreamTest, BuffersOutOfOrderSegments) {
+  open(1000);
+  send(300, 100);
+  send(100, 200);
+  EXPECT_TRUE(recorder_.stream.empty());
+  EXPECT_EQ(table_->buffered_bytes(), 300u);
+  EXPECT_EQ(table_->buffer_memory_in_use(), 2 * SegmentPool::kBlockSize);
+  send(0, 100);
+  EXPECT_EQ(recorder_.stream, expected({{0, 400}}));
+  EXPECT_EQ(table_->buffered_bytes(), 0u);
+  EXPECT_EQ(table_->buffer_memory_in_use(), 0u);
+  EXPECT_TRUE(recorder_.gaps.empty());
+}
+
+TEST_F(StreamTest, DeliversOverlapsAndDuplicatesOnce) {
+  open(1000);
+  send(0, 50);
+  send(100, 100);  // buffered
+  send(80, 70);    // overlaps the buffered segment's start
+  send(0, 50);     // exact duplicate of delivered data
+  send(20, 100);   // overlaps delivered and buffered data
+  send(150, 50);   // fully inside buffered data, arrives late
+  EXPECT_EQ(recorder_.stream, expected({{0, 200}}));
+  EXPECT_EQ(table_->buffered_bytes(), 0u);
+}
+
+TEST_F(StreamTest, KeepsTheFirstCopyOfBufferedBytes) {
+  open(1000);
+  send(100, 100);
+  std::vector<std::uint8_t> other(100, 0xee);
+  table_->process(kTs, tcp_packet(1, isn_ + 100, parse::kTcpAck, other));
+  send(0, 100);
+  EXPECT_EQ(recorder_.stream, expected({{0, 200}}));
+}
+
+TEST_F(StreamTest, HandlesSequenceWraparound) {
+  open(0xffffff00u);
+  send(0, 200);  // crosses 2^32
+  send(400, 100);
+  send(200, 200);
+  send(300, 150);  // duplicate across the buffered tail
+  EXPECT_EQ(recorder_.stream, expected({{0, 500}}));
+  EXPECT_TRUE(recorder_.gaps.empty());
+}
+
+TEST_F(StreamTest, PicksUpMidStreamWithoutSyn) {
+  isn_ = 5000;
+  table_ = std::make_unique<FlowTable>(FlowTableOptions{}, &recorder_);
+  send(200, 100);
+  send(300, 100);
+  send(100, 100);  // before the start; nothing to deliver it into
+  EXPECT_EQ(recorder_.stream, expected({{200, 400}}));
+}
+
+TEST_F(StreamTest, PerFlowCapSkipsTheHole) {
+  FlowTableOptions options;
+  options.max_flow_buffer = 1024;
+  open(1000, options);
+  send(0, 100);
+  send(200, 1024);  // exactly at the cap
+  EXPECT_EQ(table_->buffered_bytes(), 1024u);
+  send(1300, 100);  // over it
+  EXPECT_EQ(recorder_.stream, expected({{0, 100}, {200, 1224}, {1300, 1400}}));
+  EXPECT_EQ(recorder_.gaps, (std::vector<std::uint32_t>{100, 76}));
+  EXPECT_EQ(table_->stats().gaps, 2u);
+  EXPECT_EQ(table_->stats().gap_bytes, 176u);
+  EXPECT_EQ(table_->buffered_bytes(), 0u);
+
+  // The stream carries on normally afterwards.
+  send(1400, 100);
+  EXPECT_EQ(recorder_.stream.size(), 100u + 1024 + 200);
+}
+
+TEST_F(StreamTest, PoolExhaustionSkipsTheHole) {
+  FlowTableOptions options;
+  options.buffer_bytes = 4 * SegmentPool::kBlockSize;
+  open(1000, options);
+  send(0, 10);
+  // Needs five blocks; the four that fit are flushed behind a gap.
+  send(100, 5 * SegmentPool::kBlockSize);
+  EXPECT_EQ(recorder_.stream, expected({{0, 10}, {100, 100 + 5 * SegmentPool::kBlockSize}}));
+  EXPECT_EQ(recorder_.gaps, (std::vector<std::uint32_t>{90}));
+  EXPECT_EQ(table_->buffered_bytes(), 0u);
+
+  // Blocks went back to the pool.
+  send(2000, 4 * SegmentPool::kBlockSize);
+  EXPECT_EQ(table_->buffered_bytes(), 4 * SegmentPool::kBlockSize);
+}
+
+TEST_F(StreamTest, ClosingFlushesBufferedDataBehindAGap) {
+  open(1000);
+  send(0, 10);
+  send(50, 10);
+  table_->clear();
+  EXPECT_EQ(recorder_.stream, expected({{0, 10}, {50, 60}}));
+  EXPECT_EQ(recorder_.gaps, (std::vector<std::uint32_t>{40}));
+  ASSERT_EQ(recorder_.closes.size(), 1u);
+  EXPECT_EQ(recorder_.closes[0], CloseReason::kShutdown);
+  EXPECT_EQ(table_->size(), 0u);
+}
+
+// The same conversation seen from the server.
+parse::DecodedPacket reply(std::uint32_t flow, std::uint32_t seq, std::uint8_t flags) {
+  parse::DecodedPacket p = tcp_packet(flow, seq, flags);
+  std::swap(p.src_ip, p.dst_ip);
+  std::swap(p.src_port, p.dst_port);
+  return p;
+}
+
+// Default timeouts: 10s half-open, 300s established, 5s after both FINs,
+// 60s UDP.
+class ExpiryTest : public ::testing::Test {
+ protected:
+  static constexpr std::uint64_t kSecond = 1'000'000'000;
+  static constexpr std::uint64_t kTs = 1'700'000'000ull * kSecond;
+
+  FlowId establish(std::uint32_t flow, std::uint64_t ts) {
+    table_.process(ts, tcp_packet(flow, 100, parse::kTcpSyn));
+    table_.process(ts, reply(flow, 500, parse::kTcpSyn | parse::kTcpAck));
+    return table_.process(ts, tcp_packet(flow, 101, parse::kTcpAck));
+  }
+
+  Recorder recorder_;
+  FlowTable table_{FlowTableOptions{}, &recorder_};
+};
+
+TEST_F(ExpiryTest, HalfOpenFlowsExpireAfterTheShortTimeout) {
+  ASSERT_NE(table_.process(kTs, tcp_packet(1, 100, parse::kTcpSyn)), kNoFlow);
+  // A retransmitted SYN moves the deadline but does not complete the flow.
+  table_.process(kTs + 4 * kSecond, tcp_packet(1, 100, parse::kTcpSyn));
+  table_.advance(kTs + 13 * kSecond);
+  EXPECT_EQ(table_.size(), 1u);
+  table_.advance(kTs + 14 * kSecond);
+  EXPECT_EQ(table_.size(), 0u);
+  EXPECT_EQ(table_.stats().expired, 1u);
+  EXPECT_EQ(table_.stats().closed, 0u);
+  EXPECT_EQ(recorder_.closes, (std::vector<CloseReason>{CloseReason::kIdle}));
+}
+
+TEST_F(ExpiryTest, EstablishedFlowsOutliveTheHalfOpenTimeout) {
+  establish(1, kTs);
+  table_.advance(kTs + 299 * kSecond);
+  EXPECT_EQ(table_.size(), 1u);
+  table_.advance(kTs + 300 * kSecond);
+  EXPECT_EQ(table_.size(), 0u);
+  EXPECT_EQ(table_.stats().expired, 1u);
+  EXPECT_EQ(recorder_.closes, (std::vector<CloseReason>{CloseReason::kIdle}));
+}
+
+TEST_F(ExpiryTest, TrafficPushesTheIdleDeadlineBack) {
+  const FlowId id = establish(1, kTs);
+  EXPECT_EQ(table_.process(kTs + 200 * kSecond, tcp_packet(1, 101, parse::kTcpAck)), id);
+  table_.advance(kTs + 499 * kSecond);
+  EXPECT_EQ(table_.size(), 1u);
+  EXPECT_TRUE(recorder_.closes.empty());
+  table_.advance(kTs + 500 * kSecond);
+  EXPECT_EQ(table_.size(), 0u);
+  EXPECT_EQ(recorder_.closes, (std::vector<CloseReason>{CloseReason::kIdle}));
+}
+
+TEST_F(ExpiryTest, FinishedFlowsCloseAfterTheClosedTimeout) {
+  establish(1, kTs);
+  table_.process(kTs + 10 * kSecond, tcp_packet(1, 101, parse::kTcpFin | parse::kTcpAck));
+  // One FIN only half-closes; the flow keeps the established timeout.
+  table_.advance(kTs + 20 * kSecond);
+  EXPECT_EQ(table_.size(), 1u);
+
+  // The second FIN shortens the deadline, which is rescheduled at once.
+  table_.process(kTs + 20 * kSecond, reply(1, 501, parse::kTcpFin | parse::kTcpAck));
+  table_.advance(kTs + 24 * kSecond);
+  EXPECT_EQ(table_.size(), 1u);
+  table_.advance(kTs + 25 * kSecond);
+  EXPECT_EQ(table_.size(), 0u);
+  EXPECT_EQ(table_.stats().closed, 1u);
+  EXPECT_EQ(table_.stats().expired, 0u);
+  EXPECT_EQ(recorder_.closes, (std::vector<CloseReason>{CloseReason::kFin}));
+}
+
+TEST_F(ExpiryTest, ResetClosesAtOnceAndLeavesTheWheelClean) {
+  establish(1, kTs);
+  EXPECT_EQ(table_.process(kTs + kSecond, reply(1, 501, parse::kTcpRst)), kNoFlow);
+  EXPECT_EQ(table_.size(), 0u);
+  EXPECT_EQ(table_.stats().closed, 1u);
+  EXPECT_EQ(recorder_.closes, (std::vector<CloseReason>{CloseReason::kRst}));
+
+  // The id is reused; the old flow's deadline must not close the new one.
+  establish(2, kTs + 2 * kSecond);
+  table_.advance(kTs + 301 * kSecond);
+  EXPECT_EQ(table_.size(), 1u);
+  table_.advance(kTs + 302 * kSecond);
+  EXPECT_EQ(table_.size(), 0u);
+  EXPECT_EQ(recorder_.closes, (std::vector<CloseReason>{CloseReason::kRst, CloseReason::kIdle}));
+}
+
+TEST_F(ExpiryTest, UdpFlowsUseTheirOwnTimeout) {
+  parse::DecodedPacket udp = tcp_packet(1, 0, 0);
+  udp.layers = parse::kLayerL2 | parse::kLayerIp | parse::kLayerUdp;
+  udp.ip_proto = 17;
+  ASSERT_NE(table_.process(kTs, udp), kNoFlow);
+  table_.advance(kTs + 59 * kSecond);
+  EXPECT_EQ(table_.size(), 1u);
+  table_.advance(kTs + 60 * kSecond);
+  EXPECT_EQ(table_.size(), 0u);
+  EXPECT_EQ(recorder_.closes, (std::vector<CloseReason>{CloseReason::kIdle}));
+}
+
+// A capture paused for an hour, longer than the wheel is wide: every flow,
+// whatever slot it sits in, expires on the first advance after the pause.
+TEST_F(ExpiryTest, LongPauseDrainsEveryFlowAtOnce) {
+  constexpr std::uint32_t kHalfOpen = 3000, kEstablished = 1000;
+  for (std::uint32_t f = 0; f < kHalfOpen; ++f)
+    table_.process(kTs + (f % 400) * kSecond, tcp_packet(f, 100, parse::kTcpSyn));
+  for (std::uint32_t f = kHalfOpen; f < kHalfOpen + kEstablished; ++f) establish(f, kTs + (f % 400) * kSecond);
+  // Half-open flows from the first 390s have already gone.
+  EXPECT_LT(table_.size(), std::size_t{kHalfOpen + kEstablished});
+  const std::uint64_t before = table_.stats().expired;
+  EXPECT_GT(before, 0u);
+
+  table_.advance(kTs + 3600 * kSecond);
+  EXPECT_EQ(table_.size(), 0u);
+  EXPECT_EQ(table_.stats().expired, kHalfOpen + kEstablished);
+  EXPECT_EQ(recorder_.closes.size(), kHalfOpen + kEstablished);
+
+  // The wheel carries on from the new time.
+  establish(1, kTs + 3601 * kSecond);
+  table_.advance(kTs + 3900 * kSecond);
+  EXPECT_EQ(table_.size(), 1u);
+  table_.advance(kTs + 3901 * kSecond);
+  EXPECT_EQ(table_.size(), 0u);
+}
+
+FlowKey key_of(std::uint32_t flow) {
+  bool from_a = false;
+  return FlowKey::from(tcp_packet(flow, 0, 0), from_a);
+}
+
+// Random opens and resets on a small table, where probe clusters form and
+// wrap past the end of the index, checked against a map after every step.
+TEST(FlowIndex, BackwardShiftKeepsEveryFlowFindable) {
+  constexpr std::uint64_t kTs = 1'700'000'000ull * 1'000'000'000;
+  FlowTableOptions options;
+  options.max_flows = 16;
+  FlowTable table(options);
+  std::map<std::uint32_t, FlowId> live;
+
+  std::uint64_t state = 0x243f6a8885a308d3ull;
+  auto next = [&state] {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  };
+  for (int step = 0; step < 20000; ++step) {
+    const auto flow = static_cast<std::uint32_t>(next() % 64);
+    if (auto it = live.find(flow); it != live.end()) {
+      EXPECT_EQ(table.process(kTs, tcp_packet(flow, 0, parse::kTcpRst)), kNoFlow);
+      live.erase(it);
+    } else if (live.size() < options.max_flows) {
+      const FlowId id = table.process(kTs, tcp_packet(flow, 0, parse::kTcpSyn));
+      ASSERT_NE(id, kNoFlow);
+      live.emplace(flow, id);
+    }
+    ASSERT_EQ(table.size(), live.size());
+    for (std::uint32_t f = 0; f < 64; ++f) {
+      const auto it = live.find(f);
+      ASSERT_EQ(table.find(key_of(f)), it == live.end() ? kNoFlow : it->second) << "flow " << f << " step " << step;
+    }
+  }
+}
+
+TEST(FlowIndex, RefusesFlowsBeyondTheCap) {
+  constexpr std::uint64_t kTs = 1'700'000'000ull * 1'000'000'000;
+  FlowTableOptions options;
+  options.max_flows = 4;
+  FlowTable table(options);
+  for (std::uint32_t f = 0; f < 4; ++f) EXPECT_NE(table.process(kTs, tcp_packet(f, 0, parse::kTcpSyn)), kNoFlow);
+  EXPECT_EQ(table.process(kTs, tcp_packet(9, 0, parse::kTcpSyn)), kNoFlow);
+  EXPECT_EQ(table.stats().rejected, 1u);
+  table.process(kTs, tcp_packet(2, 0, parse::kTcpRst));
+  EXPECT_NE(table.process(kTs, tcp_packet(9, 0, parse::kTcpSyn)), kNoFlow);
+}
+
+}  // namespace
+}  // namespace etheros::flow
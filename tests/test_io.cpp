@@ -0,0 +1,85 @@
+// Status files: merging several producers' files and following producers
+// that come and go.
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <string>
+
+#include "etheros/io/status_file.hpp"
+#include "test_support.hpp"
+
+namespace etheros::io {
+namespace {
+
+using test::TempDir;
+using test::write_file;
+
+TEST(StatusReader, MergesEveryProducersFile) {
+  TempDir dir;
+  write_status_file(dir.file("capture"), {{"packets", "10"}, {"bytes", "1500"}, {"last_handshake", "lab ap 1"}});
+  write_status_file(dir.file("crackd"), {{"crack_done", "5"}, {"packets", "99"}});
+  // No trailing newline: must not run into the next file.
+  write_file(dir.file("harvest"), {'h', 'o', 's', 't', 's', ' ', '3'});
+  // A writer's temporary is hidden.
+  write_file(dir.file(".capture.tmp"), {'d', 'r', 'o', 'p', 's', ' ', '7', '\n'});
+
+  StatusReader reader(dir.path());
+  ASSERT_TRUE(reader.read());
+  EXPECT_EQ(reader.value("bytes"), "1500");
+  EXPECT_EQ(reader.value("crack_done"), "5");
+  EXPECT_EQ(reader.value("hosts"), "3");
+  EXPECT_EQ(reader.value("last_handshake"), "lab ap 1");
+  // Files are read in name order, and the first producer wins.
+  EXPECT_EQ(reader.value("packets"), "10");
+  EXPECT_EQ(reader.value("drops"), "");
+}
+
+TEST(StatusReader, FollowsProducersThatComeAndGo) {
+  TempDir dir;
+  StatusReader reader(dir.path());
+  EXPECT_FALSE(reader.read());
+
+  write_status_file(dir.file("capture"), {{"packets", "10"}});
+  ASSERT_TRUE(reader.read());
+  EXPECT_EQ(reader.value("packets"), "10");
+
+  write_status_file(dir.file("capture"), {{"packets", "11"}});
+  ASSERT_TRUE(reader.read());
+  EXPECT_EQ(reader.value("packets"), "11");
+
+  write_status_file(dir.file("crackd"), {{"crack_done", "1"}});
+  ::unlink(dir.file("capture").c_str());
+  reader.read();
+  EXPECT_EQ(reader.value("packets"), "");
+  // A missing file makes the next read list the directory again.
+  ASSERT_TRUE(reader.read());
+  EXPECT_EQ(reader.value("crack_done"), "1");
+}
+
+TEST(StatusFile, CreatesMissingDirectories) {
+  TempDir dir;
+  const std::string status_dir = dir.file("etheros") + "/status.d";
+  write_status_file(status_dir + "/crackd", {{"crack_done", "9"}});
+  write_status_file(status_dir + "/capture", {{"packets", "1"}});  // exists now
+  StatusReader reader(status_dir);
+  ASSERT_TRUE(reader.read());
+  EXPECT_EQ(reader.value("crack_done"), "9");
+  EXPECT_EQ(reader.value("packets"), "1");
+  // TempDir only removes plain files.
+  for (const char* name : {"/crackd", "/capture"}) ::unlink((status_dir + name).c_str());
+  ::rmdir(status_dir.c_str());
+  ::rmdir(dir.file("etheros").c_str());
+}
+
+TEST(StatusReader, ReadsASingleFile) {
+  TempDir dir;
+  write_status_file(dir.file("status"), {{"packets", "42"}});
+  StatusReader reader(dir.file("status"));
+  ASSERT_TRUE(reader.read());
+  EXPECT_EQ(reader.value("packets"), "42");
+}
+
+}  // namespace
+}  // namespace etheros::io
@@ -0,0 +1,56 @@
+// MAC address sets: membership through growth, and addresses whose keys
+// differ only in the OUI.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "etheros/match/mac_set.hpp"
+
+namespace etheros::match {
+namespace {
+
+MacAddress mac_of(std::uint64_t v) {
+  MacAddress m;
+  for (int i = 5; i >= 0; --i, v >>= 8) m.octets[static_cast<std::size_t>(i)] = static_cast<std::uint8_t>(v);
+  return m;
+}
+
+TEST(MacSet, MembershipSurvivesGrowth) {
+  MacSet set(2);
+  for (std::uint64_t i = 0; i < 1000; ++i) EXPECT_TRUE(set.insert(mac_of(0x02'00'00'00'00'00 + i * 0x010101)));
+  EXPECT_EQ(set.size(), 1000u);
+  for (std::uint64_t i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(set.contains(mac_of(0x02'00'00'00'00'00 + i * 0x010101))) << i;
+    EXPECT_FALSE(set.contains(mac_of(0x02'00'00'00'00'00 + i * 0x010101 + 1))) << i;
+  }
+}
+
+TEST(MacSet, RepeatsAreNotInserted) {
+  MacSet set;
+  const MacAddress a = mac_of(0xa4'5e'60'00'00'01);
+  EXPECT_TRUE(set.insert(a));
+  EXPECT_FALSE(set.insert(a));
+  EXPECT_EQ(set.size(), 1u);
+  EXPECT_TRUE(set.contains(a.to_u64()));
+}
+
+TEST(MacSet, BroadcastAndZeroAreOrdinaryKeys) {
+  MacSet set;
+  EXPECT_FALSE(set.contains(mac_of(0xff'ff'ff'ff'ff'ff)));
+  EXPECT_FALSE(set.contains(mac_of(0)));
+  EXPECT_TRUE(set.insert(mac_of(0xff'ff'ff'ff'ff'ff)));
+  EXPECT_TRUE(set.insert(mac_of(0)));
+  EXPECT_TRUE(set.contains(mac_of(0xff'ff'ff'ff'ff'ff)));
+  EXPECT_TRUE(set.contains(mac_of(0)));
+}
+
+TEST(MacSet, KeysDifferingOnlyInTheOui) {
+  MacSet set(4);
+  for (std::uint64_t oui = 0; oui < 64; ++oui) EXPECT_TRUE(set.insert(mac_of(oui << 24 | 0x123456)));
+  for (std::uint64_t oui = 0; oui < 64; ++oui) EXPECT_TRUE(set.contains(mac_of(oui << 24 | 0x123456)));
+  EXPECT_FALSE(set.contains(mac_of(64ull << 24 | 0x123456)));
+}
+
+}  // namespace
+}  // namespace etheros::match
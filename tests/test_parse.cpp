@@ -0,0 +1,203 @@
+// Frame decoding: VLAN stacks, IPv6 extension headers, radiotap and 802.11
+// address resolution, and frames cut short by the snaplen.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include "etheros/parse/decode.hpp"
+
+namespace etheros::parse {
+namespace {
+
+using capture::LinkType;
+
+class Frame {
+ public:
+  Frame& u8(std::uint8_t v) {
+    bytes.push_back(v);
+    return *this;
+  }
+  Frame& u16(std::uint16_t v) { return u8(static_cast<std::uint8_t>(v >> 8)).u8(static_cast<std::uint8_t>(v)); }
+  Frame& u16le(std::uint16_t v) { return u8(static_cast<std::uint8_t>(v)).u8(static_cast<std::uint8_t>(v >> 8)); }
+  Frame& u32(std::uint32_t v) { return u16(static_cast<std::uint16_t>(v >> 16)).u16(static_cast<std::uint16_t>(v)); }
+  Frame& fill(std::size_t n, std::uint8_t v) {
+    bytes.insert(bytes.end(), n, v);
+    return *this;
+  }
+  Frame& raw(std::initializer_list<std::uint8_t> b) {
+    bytes.insert(bytes.end(), b);
+    return *this;
+  }
+
+  Frame& ethernet(std::uint16_t ethertype) { return fill(6, 0xdd).fill(6, 0x55).u16(ethertype); }
+  // IPv4 without options, carrying `l4` bytes.
+  Frame& ipv4(std::uint8_t proto, std::uint16_t l4, std::uint16_t frag = 0) {
+    u8(0x45).u8(0).u16(static_cast<std::uint16_t>(20 + l4)).u16(0).u16(frag).u8(64).u8(proto).u16(0);
+    return u32(0x0a000001).u32(0x0a000002);
+  }
+  Frame& udp(std::uint16_t src, std::uint16_t dst, std::uint16_t payload) {
+    return u16(src).u16(dst).u16(static_cast<std::uint16_t>(8 + payload)).u16(0);
+  }
+  Frame& tcp(std::uint16_t src, std::uint16_t dst, std::uint32_t seq, std::uint8_t flags) {
+    return u16(src).u16(dst).u32(seq).u32(0).u8(0x50).u8(flags).u16(1024).u16(0).u16(0);
+  }
+
+  ByteSpan span() const { return bytes; }
+
+  std::vector<std::uint8_t> bytes;
+};
+
+TEST(Decode, Ipv4UdpBehindStackedVlanTags) {
+  Frame f;
+  f.fill(6, 0xdd).fill(6, 0x55).u16(0x88a8).u16(100).u16(0x8100).u16(200).u16(0x0800);
+  f.ipv4(17, 12).udp(5353, 5353, 4).raw({1, 2, 3, 4});
+  DecodedPacket p;
+  ASSERT_TRUE(decode(LinkType::kEthernet, f.span(), p));
+  EXPECT_EQ(p.ethertype, 0x0800);
+  ASSERT_TRUE(p.has(kLayerUdp));
+  EXPECT_EQ(p.src_mac.octets[0], 0x55);
+  EXPECT_EQ(p.ip_version, 4);
+  EXPECT_TRUE(p.src_ip.is_v4());
+  EXPECT_EQ(p.ttl, 64);
+  EXPECT_EQ(p.src_port, 5353);
+  EXPECT_EQ(std::vector<std::uint8_t>(p.payload.begin(), p.payload.end()), (std::vector<std::uint8_t>{1, 2, 3, 4}));
+}
+
+TEST(Decode, SnaplenCutKeepsWhatArrived) {
+  Frame f;
+  f.ethernet(0x0800).ipv4(6, 20 + 100).tcp(40000, 80, 7, kTcpAck).fill(30, 0xee);
+  DecodedPacket p;
+  ASSERT_TRUE(decode(LinkType::kEthernet, f.span(), p));
+  ASSERT_TRUE(p.has(kLayerTcp));
+  EXPECT_EQ(p.tcp_seq, 7u);
+  EXPECT_EQ(p.payload.size(), 30u);
+
+  // Cut inside the TCP header: IP is still there, TCP is not.
+  ASSERT_TRUE(decode(LinkType::kEthernet, f.span().first(14 + 20 + 10), p));
+  EXPECT_TRUE(p.has(kLayerIp));
+  EXPECT_FALSE(p.has(kLayerTcp));
+
+  EXPECT_FALSE(decode(LinkType::kEthernet, f.span().first(13), p));
+  EXPECT_EQ(p.layers, 0u);
+}
+
+TEST(Decode, NonFirstFragmentsHaveNoPorts) {
+  Frame f;
+  f.ethernet(0x0800).ipv4(17, 12, 0x0010).udp(1, 2, 4).fill(4, 0);
+  DecodedPacket p;
+  ASSERT_TRUE(decode(LinkType::kEthernet, f.span(), p));
+  EXPECT_TRUE(p.has(kLayerIp));
+  EXPECT_FALSE(p.has(kLayerUdp));
+  EXPECT_EQ(p.payload.size(), 12u);
+}
+
+Frame ipv6_header(std::uint8_t next, std::uint16_t payload_len) {
+  Frame f;
+  f.ethernet(0x86dd).u32(0x60000000).u16(payload_len).u8(next).u8(255);
+  f.raw({0xfe, 0x80}).fill(13, 0).u8(1).raw({0xff, 0x02}).fill(13, 0).u8(0xfb);
+  return f;
+}
+
+TEST(Decode, Ipv6SkipsExtensionHeaders) {
+  // Hop-by-hop (8 bytes), then destination options (16 bytes), then TCP.
+  Frame f = ipv6_header(0, 8 + 16 + 20 + 3);
+  f.u8(60).u8(0).fill(6, 0);
+  f.u8(6).u8(1).fill(14, 0);
+  f.tcp(443, 50000, 0x01020304, kTcpSyn | kTcpAck).raw({7, 8, 9});
+  DecodedPacket p;
+  ASSERT_TRUE(decode(LinkType::kEthernet, f.span(), p));
+  EXPECT_EQ(p.ip_version, 6);
+  EXPECT_FALSE(p.src_ip.is_v4());
+  EXPECT_EQ(p.dst_ip.bytes[15], 0xfb);
+  EXPECT_EQ(p.ip_proto, 6);
+  ASSERT_TRUE(p.has(kLayerTcp));
+  EXPECT_EQ(p.tcp_seq, 0x01020304u);
+  EXPECT_EQ(p.tcp_flags, kTcpSyn | kTcpAck);
+  EXPECT_EQ(p.payload.size(), 3u);
+}
+
+TEST(Decode, Ipv6FragmentsAndTruncatedExtensions) {
+  // First fragment: the UDP header follows.
+  Frame first = ipv6_header(44, 8 + 8 + 2);
+  first.u8(17).u8(0).u16(0x0001).u32(99);
+  first.udp(547, 546, 2).raw({1, 2});
+  DecodedPacket p;
+  ASSERT_TRUE(decode(LinkType::kEthernet, first.span(), p));
+  EXPECT_TRUE(p.has(kLayerUdp));
+  EXPECT_EQ(p.dst_port, 546);
+
+  // A later fragment: no L4.
+  Frame later = ipv6_header(44, 8 + 10);
+  later.u8(17).u8(0).u16(0x0008).u32(99).fill(10, 0);
+  ASSERT_TRUE(decode(LinkType::kEthernet, later.span(), p));
+  EXPECT_TRUE(p.has(kLayerIp));
+  EXPECT_FALSE(p.has(kLayerUdp));
+
+  // An extension header claiming to run past the packet.
+  Frame bad = ipv6_header(0, 8);
+  bad.u8(6).u8(4).fill(6, 0);
+  ASSERT_TRUE(decode(LinkType::kEthernet, bad.span(), p));
+  EXPECT_TRUE(p.has(kLayerIp));
+  EXPECT_FALSE(p.has(kLayerTcp));
+}
+
+// Radiotap with TSFT and Flags, then a to-DS 802.11 data frame carrying
+// EAPOL, so the payload shows whether the FCS was stripped.
+Frame radiotap_eapol(bool fcs) {
+  Frame f;
+  f.u8(0).u8(0).u16le(18).raw({0x03, 0, 0, 0}).fill(8, 0).u8(fcs ? 0x10 : 0).u8(0);
+  f.raw({0x08, 0x01}).u16(0);
+  f.fill(6, 0xbb).fill(6, 0x55).fill(6, 0xdd).u16(0);
+  f.raw({0xaa, 0xaa, 0x03, 0, 0, 0}).u16(0x888e);
+  f.raw({0x02, 0x03, 0x00, 0x02, 0xaa, 0xbb});
+  if (fcs) f.raw({0xde, 0xad, 0xbe, 0xef});
+  return f;
+}
+
+TEST(Decode, RadiotapStripsTheFcs) {
+  for (bool fcs : {false, true}) {
+    const Frame f = radiotap_eapol(fcs);
+    DecodedPacket p;
+    ASSERT_TRUE(decode(LinkType::kRadiotap, f.span(), p));
+    ASSERT_TRUE(p.has(kLayerEapol)) << "fcs " << fcs;
+    EXPECT_EQ(p.payload.size(), 6u) << "fcs " << fcs;
+    EXPECT_EQ(p.bssid.octets[0], 0xbb);
+    EXPECT_EQ(p.src_mac.octets[0], 0x55);
+    EXPECT_EQ(p.dst_mac.octets[0], 0xdd);
+  }
+}
+
+TEST(Decode, RadiotapRejectsBadHeaders) {
+  Frame f = radiotap_eapol(false);
+  DecodedPacket p;
+  f.bytes[0] = 1;  // version
+  EXPECT_FALSE(decode(LinkType::kRadiotap, f.span(), p));
+  f.bytes[0] = 0;
+  f.bytes[2] = 0xff;  // longer than the frame
+  EXPECT_FALSE(decode(LinkType::kRadiotap, f.span(), p));
+}
+
+TEST(Decode, WifiManagementAndProtectedFrames) {
+  Frame beacon;
+  beacon.raw({0x80, 0x00}).u16(0).fill(6, 0xff).fill(6, 0x55).fill(6, 0xbb).u16(0).fill(12, 0x11);
+  DecodedPacket p;
+  ASSERT_TRUE(decode(LinkType::kIeee80211, beacon.span(), p));
+  EXPECT_TRUE(p.has(kLayerWifiMgmt));
+  EXPECT_EQ(p.wifi_subtype, 8);
+  EXPECT_EQ(p.bssid.octets[0], 0xbb);
+  EXPECT_EQ(p.payload.size(), 12u);
+
+  // Protected data is addressed but not looked into.
+  Frame data = radiotap_eapol(false);
+  data.bytes.erase(data.bytes.begin(), data.bytes.begin() + 18);
+  data.bytes[1] |= 0x40;
+  ASSERT_TRUE(decode(LinkType::kIeee80211, data.span(), p));
+  EXPECT_EQ(p.src_mac.octets[0], 0x55);
+  EXPECT_FALSE(p.has(kLayerEapol));
+}
+
+}  // namespace
+}  // namespace etheros::parse
@@ -0,0 +1,31 @@
+#pragma once
+
+// Shared plumbing for etheros-tests.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace etheros::test {
+
+// A fresh directory under $TMPDIR (default /tmp), removed with its contents
+// when the object goes away.
+class TempDir {
+ public:
+  TempDir();
+  ~TempDir();
+
+  TempDir(const TempDir&) = delete;
+  TempDir& operator=(const TempDir&) = delete;
+
+  const std::string& path() const { return path_; }
+  std::string file(const std::string& name) const { return path_ + "/" + name; }
+
+ private:
+  std::string path_;
+};
+
+std::vector<std::uint8_t> read_file(const std::string& path);
+void write_file(const std::string& path, const std::vector<std::uint8_t>& data);
+
+}  // namespace etheros::test
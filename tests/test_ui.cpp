@@ -0,0 +1,160 @@
+// Dashboard drawing: how dirty rectangles merge and collapse, and that the
+// retained widgets repaint only what changed.
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <vector>
+
+#include "etheros/ui/canvas.hpp"
+#include "etheros/ui/dashboard.hpp"
+#include "etheros/ui/dirty_region.hpp"
+#include "etheros/ui/font.hpp"
+#include "etheros/ui/widgets.hpp"
+
+namespace etheros::ui {
+namespace {
+
+std::vector<Rect> rects_of(const DirtyRegion& region) { return {region.rects().begin(), region.rects().end()}; }
+
+TEST(DirtyRegion, MergesNeighboursAndKeepsDistantRectsApart) {
+  DirtyRegion region;
+  region.add({0, 0, 6, 8});
+  region.add({6, 0, 6, 8});  // the next text cell
+  region.add({100, 100, 10, 10});
+  region.add({0, 0, 0, 8});  // empty
+  EXPECT_EQ(rects_of(region), (std::vector<Rect>{{0, 0, 12, 8}, {100, 100, 10, 10}}));
+  EXPECT_EQ(region.area(), 12 * 8 + 100);
+
+  region.clear();
+  EXPECT_TRUE(region.empty());
+}
+
+TEST(DirtyRegion, MergedRectsMergeAgain) {
+  DirtyRegion region;
+  region.add({0, 0, 10, 10});
+  region.add({20, 0, 10, 10});
+  ASSERT_EQ(region.rects().size(), 2u);
+  // Bridges the two; the union with the first then touches the second.
+  region.add({10, 0, 10, 10});
+  EXPECT_EQ(rects_of(region), (std::vector<Rect>{{0, 0, 30, 10}}));
+}
+
+TEST(DirtyRegion, TouchingButWastefulUnionsStaySeparate) {
+  DirtyRegion region;
+  region.add({0, 0, 100, 2});
+  region.add({98, 2, 2, 100});  // an L shape: the union would be mostly clean
+  EXPECT_EQ(region.rects().size(), 2u);
+}
+
+TEST(DirtyRegion, CollapsesToTheBoundingBoxPastTheLimit) {
+  DirtyRegion region;
+  for (int i = 0; i < static_cast<int>(DirtyRegion::kMaxRects); ++i) region.add({i * 20, i * 20, 2, 2});
+  EXPECT_EQ(region.rects().size(), DirtyRegion::kMaxRects);
+  region.add({400, 400, 2, 2});
+  EXPECT_EQ(rects_of(region), (std::vector<Rect>{{0, 0, 402, 402}}));
+}
+
+// An XRGB8888 surface in plain memory.
+class CanvasTest : public ::testing::Test {
+ protected:
+  static constexpr int kWidth = 120;
+  static constexpr int kHeight = 16;
+  static constexpr Color kFg = 0x00ff00;
+  static constexpr Color kBg = 0x000080;
+
+  Surface surface() {
+    return Surface{reinterpret_cast<std::uint8_t*>(pixels_.data()), kWidth, kHeight, kWidth * 4,
+                   PixelFormat::kXrgb8888};
+  }
+  std::uint32_t pixel(int x, int y) const { return pixels_[static_cast<std::size_t>(y * kWidth + x)]; }
+  std::vector<Rect> take_dirty() {
+    std::vector<Rect> out = rects_of(canvas_.dirty());
+    canvas_.dirty().clear();
+    return out;
+  }
+
+  std::vector<std::uint32_t> pixels_ = std::vector<std::uint32_t>(kWidth * kHeight);
+  Canvas canvas_{surface()};
+};
+
+TEST_F(CanvasTest, LabelRepaintsOnlyChangedCells) {
+  Label label(0, 0, 5, 1, kFg, kBg);
+  label.set(canvas_, "hello");
+  EXPECT_EQ(take_dirty(), (std::vector<Rect>{{0, 0, 5 * kCellWidth, kCellHeight}}));
+
+  label.set(canvas_, "hello");
+  EXPECT_TRUE(take_dirty().empty());
+
+  // "hello" -> "help ": cells 3 and 4 change together.
+  label.set(canvas_, "help");
+  EXPECT_EQ(take_dirty(), (std::vector<Rect>{{3 * kCellWidth, 0, 2 * kCellWidth, kCellHeight}}));
+
+  // Two separate runs.
+  label.set(canvas_, "hxlpx");
+  EXPECT_EQ(take_dirty(), (std::vector<Rect>{{kCellWidth, 0, kCellWidth, kCellHeight},
+                                             {4 * kCellWidth, 0, kCellWidth, kCellHeight}}));
+
+  // Too long: cut to the label, so only the first cell differs.
+  label.set(canvas_, "axlpxyz");
+  EXPECT_EQ(take_dirty(), (std::vector<Rect>{{0, 0, kCellWidth, kCellHeight}}));
+
+  label.invalidate();
+  label.set(canvas_, "axlpx");
+  EXPECT_EQ(take_dirty(), (std::vector<Rect>{{0, 0, 5 * kCellWidth, kCellHeight}}));
+}
+
+TEST_F(CanvasTest, BarRepaintsTheSpanBetweenOldAndNewFill) {
+  Bar bar({10, 4, 100, 4}, kFg, kBg);
+  bar.set(canvas_, 0.5);
+  EXPECT_EQ(take_dirty(), (std::vector<Rect>{{10, 4, 100, 4}}));
+  EXPECT_EQ(pixel(59, 5), kFg);
+  EXPECT_EQ(pixel(60, 5), kBg);
+
+  bar.set(canvas_, 0.75);
+  EXPECT_EQ(take_dirty(), (std::vector<Rect>{{60, 4, 25, 4}}));
+  EXPECT_EQ(pixel(84, 5), kFg);
+  EXPECT_EQ(pixel(85, 5), kBg);
+
+  bar.set(canvas_, 0.25);
+  EXPECT_EQ(take_dirty(), (std::vector<Rect>{{35, 4, 50, 4}}));
+  EXPECT_EQ(pixel(35, 5), kBg);
+
+  bar.set(canvas_, 0.251);  // rounds to the same fill
+  EXPECT_TRUE(take_dirty().empty());
+
+  bar.invalidate();
+  bar.set(canvas_, 0.25);
+  EXPECT_EQ(take_dirty(), (std::vector<Rect>{{10, 4, 100, 4}}));
+}
+
+TEST_F(CanvasTest, BarTreatsNanAndInfinityAsBounds) {
+  Bar bar({0, 0, 100, 4}, kFg, kBg);
+  bar.set(canvas_, 0.5);
+  take_dirty();
+
+  // 0.0 / 0 from a counter that has no total yet.
+  bar.set(canvas_, std::numeric_limits<double>::quiet_NaN());
+  EXPECT_EQ(take_dirty(), (std::vector<Rect>{{0, 0, 50, 4}}));
+  EXPECT_EQ(pixel(0, 0), kBg);
+
+  bar.set(canvas_, std::numeric_limits<double>::infinity());
+  EXPECT_EQ(take_dirty(), (std::vector<Rect>{{0, 0, 100, 4}}));
+  EXPECT_EQ(pixel(99, 0), kFg);
+
+  bar.set(canvas_, -std::numeric_limits<double>::infinity());
+  EXPECT_EQ(pixel(99, 0), kBg);
+}
+
+TEST(CounterRate, CounterThatGoesBackwardsReadsAsZero) {
+  EXPECT_DOUBLE_EQ(counter_rate(100, 350, 0.5), 500.0);
+  EXPECT_DOUBLE_EQ(counter_rate(100, 100, 0.5), 0.0);
+  // The producer restarted, or its status file is gone and reads as 0.
+  EXPECT_DOUBLE_EQ(counter_rate(1'000'000, 0, 0.5), 0.0);
+  EXPECT_DOUBLE_EQ(counter_rate(1'000'000, 999'999, 0.5), 0.0);
+  // The first frame has no interval yet.
+  EXPECT_DOUBLE_EQ(counter_rate(0, 10, 0), 0.0);
+}
+
+}  // namespace
+}  // namespace etheros::ui
@@ -0,0 +1,63 @@
+#!/bin/sh
+# Exercises etheros-crackd's multi-board mode on one host: a coordinator plus
+# several worker processes on 127.0.0.1. Halfway through, the coordinator is
+# killed with SIGKILL (a stand-in for pulling a board's power) and restarted;
+# it must resume from its checkpoint (start with chunks already done) while the
+# workers reconnect on their own, and then find the key.
+#
+#   tools/crack-local-cluster.sh [build-dir] [workers]
+
+set -eu
+
+BUILD=${1:-_build}
+WORKERS=${2:-3}
+CRACKD=$BUILD/etheros-crackd
+PORT=${PORT:-7390}
+WORK=$(mktemp -d)
+trap 'kill $(jobs -p) 2>/dev/null || true; rm -rf "$WORK"' EXIT
+
+TARGET=$("$CRACKD" target --ssid etheros-lab --passphrase labpass7421 \
+  --ap 02:00:00:00:00:01 --sta 02:00:00:00:00:02)
+KEYSPACE='mask:labpass?d?d?d?d'
+echo "lab-$$-token" >"$WORK/token"
+
+# exec, so that $! and kill address etheros-crackd itself.
+coordinator() {
+  exec "$CRACKD" run --target "$TARGET" --keyspace "$KEYSPACE" --state "$WORK/state" \
+    --chunk 100 --threads 1 --listen "127.0.0.1:$PORT" --sync 1 --status "$WORK/status" \
+    --token-file "$WORK/token"
+}
+
+coordinator 2>"$WORK/coordinator-1.log" &
+COORD=$!
+sleep 1
+i=1
+while [ "$i" -le "$WORKERS" ]; do
+  "$CRACKD" work --connect "127.0.0.1:$PORT" --threads 1 --name "board$i" --token-file "$WORK/token" \
+    2>"$WORK/board$i.log" &
+  i=$((i + 1))
+done
+
+sleep 5
+kill -9 "$COORD"
+wait "$COORD" 2>/dev/null || true
+echo "coordinator killed at: $(grep crack_chunks_done "$WORK/status")"
+
+status=0
+(coordinator) >"$WORK/result" 2>"$WORK/coordinator-2.log" || status=$?
+wait
+cat "$WORK"/board*.log
+grep '^job' "$WORK/coordinator-2.log"
+cat "$WORK/result"
+
+# "job <id>: N candidates in M chunks, D done" is printed before any work.
+resumed=$(sed -n 's/^job .* \([0-9][0-9]*\) done$/\1/p' "$WORK/coordinator-2.log")
+if [ "${resumed:-0}" -eq 0 ]; then
+  echo "FAIL: restarted coordinator did not resume from its checkpoint" >&2
+  exit 1
+fi
+if [ "$status" -ne 0 ] || ! grep -q '^found: labpass7421 ' "$WORK/result"; then
+  echo "FAIL: key not found (exit status $status)" >&2
+  exit 1
+fi
+echo "PASS: resumed with $resumed chunks done and found the key"
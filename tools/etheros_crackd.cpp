@@ -0,0 +1,453 @@
+// etheros-crackd: resumable, chunked PMKID cracking on one board or several.
+//
+//   etheros-crackd run    coordinate a job (and crack on local threads),
+//                         checkpointing progress under --state
+//   etheros-crackd work   crack chunks leased from a remote coordinator
+//   etheros-crackd target print a 22000 PMKID line for a known passphrase,
+//                         for lab setups and smoke tests
+//
+// Exit status: 0 key found, 1 error, 2 usage, 3 keyspace exhausted,
+// 4 interrupted (rerun the same command to resume).
+
+#include <getopt.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "etheros/crack/cluster.hpp"
+#include "etheros/crack/job_manager.hpp"
+#include "etheros/crack/keyspace.hpp"
+#include "etheros/crack/pmkid.hpp"
+#include "etheros/io/status_file.hpp"
+
+namespace {
+
+using namespace etheros::crack;
+
+std::atomic<bool> g_stop{false};
+
+void on_signal(int) { g_stop.store(true); }
+
+enum ExitCode { kFound = 0, kError = 1, kUsage = 2, kExhausted = 3, kInterrupted = 4 };
+
+void usage() {
+  std::fprintf(stderr,
+               "usage: etheros-crackd run --target LINE|FILE --keyspace SPEC --state DIR [options]\n"
+               "  -T, --target X       22000 WPA*01 line, or a file whose first line is one\n"
+               "  -k, --keyspace SPEC  mask:<pattern> or wordlist:<path>\n"
+               "  -S, --state DIR      checkpoint directory (created if missing)\n"
+               "  -c, --chunk N        candidates per chunk (default 4096)\n"
+               "  -j, --threads N      local cracking threads, 0 to only coordinate (default: all cores)\n"
+               "  -l, --listen ADDR    serve remote workers on [ipv4:]port (default: off); the\n"
+               "                       address defaults to 127.0.0.1\n"
+               "  -K, --token-file F   shared secret workers must present; required unless\n"
+               "                       listening on loopback\n"
+               "  -s, --status PATH    publish crack_done/crack_total for etheros-dashboard\n"
+               "                       (e.g. /run/etheros/status.d/crackd)\n"
+               "      --sync SEC       longest window of progress a power cut may lose (default 15)\n"
+               "      --reset          discard existing state in DIR\n"
+               "\n"
+               "       etheros-crackd work --connect HOST:PORT [--threads N] [--name NAME]\n"
+               "                           [--token-file F] [--wait SEC]\n"
+               "  --wait SEC           give up if no coordinator answers within SEC, 0 = never\n"
+               "                       (default 300)\n"
+               "\n"
+               "       etheros-crackd target --ssid SSID --passphrase P --ap MAC --sta MAC\n");
+}
+
+unsigned default_threads() {
+  const unsigned n = std::thread::hardware_concurrency();
+  return n ? n : 1;
+}
+
+bool parse_mac(const char* text, etheros::MacAddress& mac) {
+  unsigned v[6];
+  char tail;
+  if (std::sscanf(text, "%x:%x:%x:%x:%x:%x%c", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &tail) != 6) return false;
+  for (int i = 0; i < 6; ++i) {
+    if (v[i] > 0xff) return false;
+    mac.octets[static_cast<std::size_t>(i)] = static_cast<std::uint8_t>(v[i]);
+  }
+  return true;
+}
+
+PmkidTarget load_target(const std::string& arg) {
+  if (arg.rfind("WPA*", 0) == 0) return PmkidTarget::parse(arg);
+  std::ifstream in(arg);
+  if (!in) throw std::system_error(errno, std::generic_category(), "open " + arg);
+  for (std::string line; std::getline(in, line);)
+    if (!line.empty()) return PmkidTarget::parse(line);
+  throw std::invalid_argument(arg + ": no target line");
+}
+
+// First line of the file, trailing whitespace removed. Kept out of argv so it
+// does not show up in ps.
+std::string load_token(const std::string& path) {
+  if (path.empty()) return {};
+  std::ifstream in(path);
+  if (!in) throw std::system_error(errno, std::generic_category(), "open " + path);
+  std::string token;
+  std::getline(in, token);
+  while (!token.empty() && std::isspace(static_cast<unsigned char>(token.back()))) token.pop_back();
+  if (token.empty()) throw std::invalid_argument(path + ": empty token");
+  return token;
+}
+
+void make_state_dir(const std::string& dir, bool reset) {
+  if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+    throw std::system_error(errno, std::generic_category(), "mkdir " + dir);
+  if (!reset) return;
+  for (const char* name : {"snapshot", "snapshot.tmp", "journal"}) {
+    const std::string path = dir + "/" + name;
+    if (::unlink(path.c_str()) != 0 && errno != ENOENT)
+      throw std::system_error(errno, std::generic_category(), "unlink " + path);
+  }
+}
+
+void start_workers(std::vector<std::thread>& threads, unsigned count, WorkSource& source, const Keyspace& keyspace,
+                   const PmkidTarget& target, std::uint64_t chunk_size, std::atomic<std::uint64_t>& tested) {
+  for (unsigned i = 0; i < count; ++i) {
+    threads.emplace_back([&] {
+      try {
+        crack_worker(source, keyspace, target, chunk_size, g_stop, tested);
+      } catch (const std::exception& e) {
+        std::fprintf(stderr, "etheros-crackd: worker: %s\n", e.what());
+        g_stop.store(true);
+      }
+    });
+  }
+}
+
+// Stops and joins the local workers however run_command leaves, so an error
+// in the main loop reaches main() and exits 1 instead of std::terminate.
+class WorkerJoiner {
+ public:
+  explicit WorkerJoiner(std::vector<std::thread>& threads) : threads_(threads) {}
+  WorkerJoiner(const WorkerJoiner&) = delete;
+  WorkerJoiner& operator=(const WorkerJoiner&) = delete;
+  ~WorkerJoiner() { join(); }
+
+  void join() {
+    g_stop.store(true);
+    for (std::thread& t : threads_)
+      if (t.joinable()) t.join();
+  }
+
+ private:
+  std::vector<std::thread>& threads_;
+};
+
+// The status file is only for the dashboard, so failing to write it is
+// reported (once, until it works again) and the job carries on.
+void publish_status(const std::string& path, const JobProgress& p, std::size_t remote_workers, bool& failing) {
+  if (path.empty()) return;
+  try {
+    etheros::io::write_status_file(path, {
+                                             {"crack_done", std::to_string(p.done_candidates)},
+                                             {"crack_total", std::to_string(p.total_candidates)},
+                                             {"crack_chunks_done", std::to_string(p.done_chunks)},
+                                             {"crack_chunks_total", std::to_string(p.total_chunks)},
+                                             {"crack_workers", std::to_string(remote_workers)},
+                                         });
+    failing = false;
+  } catch (const std::exception& e) {
+    if (!failing) std::fprintf(stderr, "etheros-crackd: warning: status: %s\n", e.what());
+    failing = true;
+  }
+}
+
+// After a crash, sockets the old process had accepted keep the port busy
+// until each worker next talks to it (or tcp_fin_timeout passes), so an
+// immediate restart waits for the port instead of failing.
+std::unique_ptr<Coordinator> listen_for_workers(JobManager& jobs, const std::string& listen,
+                                                const std::string& token) {
+  for (int waited_s = 0;; ++waited_s) {
+    try {
+      auto coordinator = std::make_unique<Coordinator>(jobs, listen, token);
+      std::fprintf(stderr, "serving workers on port %u\n", coordinator->port());
+      return coordinator;
+    } catch (const std::system_error& e) {
+      if (e.code() != std::errc::address_in_use || waited_s >= 120 || g_stop.load()) throw;
+      if (waited_s == 0) std::fprintf(stderr, "%s; waiting for it to free up\n", e.what());
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+  }
+}
+
+int run_command(int argc, char** argv) {
+  enum { kSync = 256, kReset };
+  static const option long_options[] = {
+      {"target", required_argument, nullptr, 'T'}, {"keyspace", required_argument, nullptr, 'k'},
+      {"state", required_argument, nullptr, 'S'},  {"chunk", required_argument, nullptr, 'c'},
+      {"threads", required_argument, nullptr, 'j'}, {"listen", required_argument, nullptr, 'l'},
+      {"status", required_argument, nullptr, 's'}, {"sync", required_argument, nullptr, kSync},
+      {"reset", no_argument, nullptr, kReset},     {"token-file", required_argument, nullptr, 'K'},
+      {nullptr, 0, nullptr, 0},
+  };
+  std::string target_arg, state_dir, listen, status_path, token_file;
+  JobSpec spec;
+  JobManager::Options options;
+  unsigned threads = default_threads();
+  bool reset = false;
+  for (int c; (c = getopt_long(argc, argv, "T:k:S:c:j:l:s:K:", long_options, nullptr)) != -1;) {
+    switch (c) {
+      case 'T':
+        target_arg = optarg;
+        break;
+      case 'k':
+        spec.keyspace = optarg;
+        break;
+      case 'S':
+        state_dir = optarg;
+        break;
+      case 'c':
+        spec.chunk_size = std::strtoull(optarg, nullptr, 10);
+        break;
+      case 'j':
+        threads = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10));
+        break;
+      case 'l':
+        listen = optarg;
+        break;
+      case 's':
+        status_path = optarg;
+        break;
+      case 'K':
+        token_file = optarg;
+        break;
+      case kSync:
+        options.sync_interval = std::chrono::seconds(std::strtoul(optarg, nullptr, 10));
+        break;
+      case kReset:
+        reset = true;
+        break;
+      default:
+        return kUsage;
+    }
+  }
+  if (target_arg.empty() || spec.keyspace.empty() || state_dir.empty() || spec.chunk_size == 0 ||
+      (threads == 0 && listen.empty()))
+    return kUsage;
+
+  const PmkidTarget target = load_target(target_arg);
+  // Normalised so that equivalent spellings of the target resume the same job.
+  spec.target = target.format();
+  const auto keyspace = open_keyspace(spec.keyspace, spec.chunk_size);
+  make_state_dir(state_dir, reset);
+  JobManager jobs(spec, keyspace->size(), state_dir, options);
+
+  JobProgress p = jobs.progress();
+  std::fprintf(stderr, "job %016llx: %llu candidates in %llu chunks, %llu done\n",
+               static_cast<unsigned long long>(spec.job_id()), static_cast<unsigned long long>(p.total_candidates),
+               static_cast<unsigned long long>(p.total_chunks), static_cast<unsigned long long>(p.done_chunks));
+
+  std::unique_ptr<Coordinator> coordinator;
+  if (!listen.empty()) coordinator = listen_for_workers(jobs, listen, load_token(token_file));
+
+  LocalWorkSource local(jobs);
+  std::atomic<std::uint64_t> tested{0};
+  std::vector<std::thread> workers;
+  WorkerJoiner joiner(workers);
+  if (!jobs.finished()) start_workers(workers, threads, local, *keyspace, target, spec.chunk_size, tested);
+
+  using Clock = std::chrono::steady_clock;
+  const Clock::time_point start = Clock::now();
+  Clock::time_point last_tick = start, last_report = start;
+  bool waiting_reported = false, status_failing = false;
+  std::uint64_t start_done = p.done_candidates;
+  for (;;) {
+    if (coordinator)
+      coordinator->poll(250);
+    else
+      std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+    const Clock::time_point now = Clock::now();
+    if (now - last_tick >= std::chrono::seconds(1)) {
+      jobs.tick();
+      p = jobs.progress();
+      publish_status(status_path, p, coordinator ? coordinator->workers() : 0, status_failing);
+      last_tick = now;
+    }
+    if (now - last_report >= std::chrono::seconds(10)) {
+      const double s = std::chrono::duration<double>(now - start).count();
+      std::fprintf(stderr, "%llu/%llu chunks, %.0f candidates/s, %zu remote workers\n",
+                   static_cast<unsigned long long>(p.done_chunks), static_cast<unsigned long long>(p.total_chunks),
+                   (p.done_candidates - start_done) / s, coordinator ? coordinator->workers() : std::size_t{0});
+      last_report = now;
+    }
+
+    if (g_stop.load()) break;
+    if (jobs.finished()) {
+      // Keep answering FINISHED until every leased chunk has been returned
+      // (workers drop theirs at the next RENEW or DONE) or has expired, so no
+      // worker is left retrying a coordinator that is gone.
+      const std::uint64_t leased = jobs.progress().leased;
+      if (!coordinator || leased == 0) break;
+      if (!waiting_reported) {
+        std::fprintf(stderr, "job finished; waiting for %llu leased chunks to be returned\n",
+                     static_cast<unsigned long long>(leased));
+        waiting_reported = true;
+      }
+    }
+  }
+
+  const bool interrupted = g_stop.load() && !jobs.finished();
+  joiner.join();
+  jobs.close();
+  p = jobs.progress();
+  publish_status(status_path, p, 0, status_failing);
+
+  if (const auto found = jobs.result()) {
+    std::printf("found: %s (candidate %llu)\n", found->candidate.c_str(),
+                static_cast<unsigned long long>(found->index));
+    return kFound;
+  }
+  if (interrupted) {
+    std::fprintf(stderr, "interrupted at %llu/%llu chunks; rerun to resume\n",
+                 static_cast<unsigned long long>(p.done_chunks), static_cast<unsigned long long>(p.total_chunks));
+    return kInterrupted;
+  }
+  std::printf("exhausted: key not in keyspace\n");
+  return kExhausted;
+}
+
+int work_command(int argc, char** argv) {
+  enum { kWait = 256 };
+  static const option long_options[] = {
+      {"connect", required_argument, nullptr, 'C'},
+      {"threads", required_argument, nullptr, 'j'},
+      {"name", required_argument, nullptr, 'n'},
+      {"token-file", required_argument, nullptr, 'K'},
+      {"wait", required_argument, nullptr, kWait},
+      {nullptr, 0, nullptr, 0},
+  };
+  std::string address, token_file;
+  RemoteWorkSource::Options remote;
+  unsigned threads = default_threads();
+  for (int c; (c = getopt_long(argc, argv, "C:j:n:K:", long_options, nullptr)) != -1;) {
+    switch (c) {
+      case 'C':
+        address = optarg;
+        break;
+      case 'j':
+        threads = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10));
+        break;
+      case 'n':
+        remote.name = optarg;
+        break;
+      case 'K':
+        token_file = optarg;
+        break;
+      case kWait:
+        remote.connect_timeout = std::chrono::seconds(std::strtoul(optarg, nullptr, 10));
+        break;
+      default:
+        return kUsage;
+    }
+  }
+  if (address.empty() || threads == 0) return kUsage;
+  if (remote.name.empty()) {
+    char host[256] = {};
+    ::gethostname(host, sizeof(host) - 1);
+    remote.name = std::string(host) + "-" + std::to_string(::getpid());
+  }
+  remote.token = load_token(token_file);
+  const std::string& name = remote.name;
+
+  std::uint64_t total_tested = 0;
+  for (;;) {
+    RemoteWorkSource source(address, remote, g_stop);
+    const JobSpec& spec = source.spec();
+    const PmkidTarget target = PmkidTarget::parse(spec.target);
+    const auto keyspace = open_keyspace(spec.keyspace, spec.chunk_size);
+    std::fprintf(stderr, "%s: job %016llx from %s\n", name.c_str(), static_cast<unsigned long long>(spec.job_id()),
+                 address.c_str());
+
+    std::atomic<std::uint64_t> tested{0};
+    std::vector<std::thread> workers;
+    start_workers(workers, threads, source, *keyspace, target, spec.chunk_size, tested);
+    for (std::thread& t : workers) t.join();
+    total_tested += tested.load();
+    if (!source.job_changed() || g_stop.load()) break;
+  }
+  std::fprintf(stderr, "%s: tested %llu candidates\n", name.c_str(), static_cast<unsigned long long>(total_tested));
+  return g_stop.load() ? kInterrupted : 0;
+}
+
+int target_command(int argc, char** argv) {
+  static const option long_options[] = {
+      {"ssid", required_argument, nullptr, 'e'},
+      {"passphrase", required_argument, nullptr, 'p'},
+      {"ap", required_argument, nullptr, 'a'},
+      {"sta", required_argument, nullptr, 'b'},
+      {nullptr, 0, nullptr, 0},
+  };
+  std::string ssid, passphrase;
+  etheros::MacAddress ap, sta;
+  bool have_ap = false, have_sta = false;
+  for (int c; (c = getopt_long(argc, argv, "e:p:a:b:", long_options, nullptr)) != -1;) {
+    switch (c) {
+      case 'e':
+        ssid = optarg;
+        break;
+      case 'p':
+        passphrase = optarg;
+        break;
+      case 'a':
+        have_ap = parse_mac(optarg, ap);
+        break;
+      case 'b':
+        have_sta = parse_mac(optarg, sta);
+        break;
+      default:
+        return kUsage;
+    }
+  }
+  if (ssid.empty() || ssid.size() > 32 || passphrase.empty() || !have_ap || !have_sta) return kUsage;
+  std::printf("%s\n", PmkidTarget::from_passphrase(passphrase, ssid, ap, sta).format().c_str());
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    usage();
+    return kUsage;
+  }
+  struct sigaction sa {};
+  sa.sa_handler = on_signal;
+  ::sigaction(SIGINT, &sa, nullptr);
+  ::sigaction(SIGTERM, &sa, nullptr);
+
+  const std::string command = argv[1];
+  int status = kUsage;
+  try {
+    // Let getopt see the subcommand as argv[0].
+    if (command == "run")
+      status = run_command(argc - 1, argv + 1);
+    else if (command == "work")
+      status = work_command(argc - 1, argv + 1);
+    else if (command == "target")
+      status = target_command(argc - 1, argv + 1);
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "etheros-crackd: %s\n", e.what());
+    return kError;
+  }
+  if (status == kUsage) usage();
+  return status;
+}
@@ -0,0 +1,108 @@
+// etheros-harvest: passive host and service inventory from discovery traffic
+// (mDNS, LLMNR, NBNS, SSDP) in pcap captures.
+//
+// Each capture is mapped and read once. New facts are buffered as JSON lines
+// and flushed after every capture file; a summary of the inventory goes to
+// stderr.
+
+#include <getopt.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <exception>
+#include <string>
+
+#include "etheros/capture/pcap.hpp"
+#include "etheros/discovery/harvester.hpp"
+#include "etheros/io/fd_writer.hpp"
+#include "etheros/io/mapped_file.hpp"
+#include "etheros/parse/decode.hpp"
+
+namespace {
+
+struct Options {
+  std::string output;
+  bool append = false;
+};
+
+void usage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s [options] CAPTURE.pcap...\n"
+               "  -o, --output PATH   JSON lines file (default stdout)\n"
+               "  -a, --append        append to --output instead of replacing it\n",
+               argv0);
+}
+
+bool parse_options(int argc, char** argv, Options& opt) {
+  static const option long_options[] = {
+      {"output", required_argument, nullptr, 'o'},
+      {"append", no_argument, nullptr, 'a'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, 0},
+  };
+  for (int c; (c = getopt_long(argc, argv, "o:ah", long_options, nullptr)) != -1;) {
+    switch (c) {
+      case 'o':
+        opt.output = optarg;
+        break;
+      case 'a':
+        opt.append = true;
+        break;
+      default:
+        return false;
+    }
+  }
+  return optind < argc;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opt;
+  if (!parse_options(argc, argv, opt)) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  try {
+    etheros::io::FdWriter out = opt.output.empty() ? etheros::io::FdWriter(::dup(STDOUT_FILENO))
+                                                   : etheros::io::FdWriter::open(opt.output, opt.append);
+    etheros::discovery::Harvester harvester(&out);
+    std::uint64_t packets = 0, discovery = 0;
+
+    for (int i = optind; i < argc; ++i) {
+      const etheros::io::MappedFile file(argv[i]);
+      etheros::capture::PcapReader reader(file.bytes());
+      etheros::capture::Packet pkt;
+      etheros::parse::DecodedPacket decoded;
+      while (reader.next(pkt)) {
+        ++packets;
+        if (etheros::parse::decode(reader.link_type(), pkt.data, decoded) && harvester.process(pkt.ts_ns, decoded))
+          ++discovery;
+      }
+      if (reader.truncated()) std::fprintf(stderr, "etheros-harvest: %s: truncated capture\n", argv[i]);
+      // A reader of the output sees each capture's facts once it is done.
+      out.flush();
+    }
+    out.close();
+
+    const auto& inv = harvester.inventory();
+    const auto& s = harvester.stats();
+    std::fprintf(stderr, "packets     %llu (%llu discovery: mdns %llu, llmnr %llu, nbns %llu, ssdp %llu, %llu malformed)\n",
+                 static_cast<unsigned long long>(packets), static_cast<unsigned long long>(discovery),
+                 static_cast<unsigned long long>(s.mdns), static_cast<unsigned long long>(s.llmnr),
+                 static_cast<unsigned long long>(s.nbns), static_cast<unsigned long long>(s.ssdp),
+                 static_cast<unsigned long long>(s.malformed));
+    std::fprintf(stderr, "inventory   %zu hosts, %zu facts, %zu strings, %zu KiB\n", inv.hosts().size(),
+                 inv.facts().size(), inv.strings().size(), inv.memory_bytes() / 1024);
+    if (s.rejected_hosts || s.rejected_facts || s.rejected_strings)
+      std::fprintf(stderr, "rejected    %llu hosts, %llu facts, %llu strings (inventory full)\n",
+                   static_cast<unsigned long long>(s.rejected_hosts),
+                   static_cast<unsigned long long>(s.rejected_facts),
+                   static_cast<unsigned long long>(s.rejected_strings));
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "etheros-harvest: %s\n", e.what());
+    return 1;
+  }
+  return 0;
+}